@@ -15,6 +15,8 @@ from metagraph import helpers
 DEFAULT_TOP_LABELS = 100
 DEFAULT_DISCOVERY_THRESHOLD = 0
 DEFAULT_NUM_NODES_PER_SEQ_CHAR = 10.0
+# number of attempts to decode binary search results if the index is being reloaded
+MAX_BINARY_SEARCH_ATTEMPTS = 3
 
 JsonDict = Dict[str, Any]
 JsonStrList = List[str]
@@ -27,9 +29,18 @@ class GraphClientJson:
     returning error message in the second element of the tuple returned.
     """
 
-    def __init__(self, host: str, port: int, name: str = None, api_path: str = None):
+    def __init__(self, host: str, port: int, name: str = None, api_path: str = None,
+                 binary: bool = False):
+        """
+        :param binary: request search results in the compact binary format,
+                       decoded into the same structure as the JSON results
+                       (see helpers.decode_binary_search_result)
+        """
         self.host = host
         self.port = port
+        self.binary = binary
+        # (index version, column labels) for decoding binary search results
+        self._labels = (None, None)
 
         self.server = f"http://{self.host}:{self.port}"
         if api_path:
@@ -81,7 +92,8 @@ class GraphClientJson:
                       "query_counts": query_counts,
                       "query_coords": query_coords}
 
-        search_results = self._json_seq_query(sequence, param_dict, "search")
+        search_results = self._json_seq_query(sequence, param_dict, "search",
+                                               binary=self.binary)
 
         if align:
             assert len(alignments) == len(search_results)
@@ -112,7 +124,7 @@ class GraphClientJson:
         return self._json_seq_query(sequence, params, "align")
 
     def _json_seq_query(self, sequence: Union[str, Iterable[str]], param_dict,
-                        endpoint: str) -> Tuple[JsonDict, str]:
+                        endpoint: str, binary: bool = False) -> Tuple[JsonDict, str]:
         if isinstance(sequence, str):
             sequence = [sequence]
 
@@ -123,15 +135,42 @@ class GraphClientJson:
         payload_dict.update(param_dict)
         payload = payload_dict
 
-        return self._do_request(endpoint, payload)
+        return self._do_request(endpoint, payload, binary=binary)
 
-    def _do_request(self, endpoint, payload, post_req=True, timeout=None) -> Tuple[JsonDict, str]:
+    def _do_request(self, endpoint, payload, post_req=True, timeout=None,
+                    binary=False) -> Tuple[JsonDict, str]:
         url = f'{self.server}/{endpoint}'
-        if post_req:
-            ret = requests.post(url=url, json=payload, timeout=timeout)
-        else:
-            ret = requests.get(url=url, timeout=timeout)
+        headers = {'Accept': helpers.BINARY_CONTENT_TYPE} if binary else None
+
+        for _ in range(MAX_BINARY_SEARCH_ATTEMPTS):
+            if post_req:
+                ret = requests.post(url=url, json=payload, timeout=timeout, headers=headers)
+            else:
+                ret = requests.get(url=url, timeout=timeout, headers=headers)
+
+            # errors are always returned as JSON
+            if not ret.ok or ret.headers.get('Content-Type') != helpers.BINARY_CONTENT_TYPE:
+                return self._parse_json(ret)
+
+            # the labels are cached and fetched again after the index is reloaded
+            version = helpers.get_binary_index_version(ret.content)
+            if version != self._labels[0]:
+                self._update_labels()
 
+            labels_version, labels = self._labels
+            if version == labels_version:
+                return helpers.decode_binary_search_result(ret.content, labels)
+
+        raise RuntimeError("Error while calling the server API. "
+                           "The index was reloaded while running the request")
+
+    def _update_labels(self):
+        ret = requests.get(url=f'{self.server}/column_labels')
+        labels = self._parse_json(ret)
+        self._labels = (int(ret.headers[helpers.INDEX_VERSION_HEADER]), labels)
+
+    @staticmethod
+    def _parse_json(ret: requests.Response):
         try:
             json_obj = ret.json()
         except:
@@ -167,8 +206,16 @@ class GraphClientJson:
 
 
 class GraphClient:
-    def __init__(self, host: str, port: int, name: str = None, api_path: str = None):
-        self._json_client = GraphClientJson(host, port, name, api_path=api_path)
+    def __init__(self, host: str, port: int, name: str = None, api_path: str = None,
+                 binary: bool = False):
+        """
+        :param binary: request search results in the compact binary format. They are
+                       decoded into the same data frames as the JSON results, with
+                       k-mer abundances and coordinates collapsed into ranges, as
+                       returned by a server run without --verbose.
+        """
+        self._json_client = GraphClientJson(host, port, name, api_path=api_path,
+                                            binary=binary)
         self.name = self._json_client.name
 
     def search(self, sequence: Union[str, Iterable[str]],
@@ -252,10 +299,11 @@ class MultiGraphClient:
         """ Create an instance of MultiGraphClient. """
         self.graphs = {}
 
-    def add_graph(self, host: str, port: int, name: str = None, api_path: str = None) -> None:
+    def add_graph(self, host: str, port: int, name: str = None, api_path: str = None,
+                  binary: bool = False) -> None:
         """ Adds graph client to list of graphs to query on request """
 
-        graph_client = GraphClient(host, port, name, api_path=api_path)
+        graph_client = GraphClient(host, port, name, api_path=api_path, binary=binary)
         self.graphs[graph_client.name] = graph_client
 
     def list_graphs(self) -> Dict[str, Tuple[str, int]]:
@@ -1,5 +1,12 @@
+from typing import List
+
 import pandas as pd
 
+# content type of the search results in the binary format
+BINARY_CONTENT_TYPE = 'application/x-metagraph-binary'
+# version of the index served, returned with the column labels
+INDEX_VERSION_HEADER = 'X-Index-Version'
+
 
 def df_from_search_result(json_res):
     def _build_dict(row, result):
@@ -35,3 +42,171 @@ def df_from_align_result(json_res):
                       columns=['cigar', 'score', 'max_score', 'sequence', 'orientation', 'seq_description'])
 
     return df
+
+
+class _BinaryReader:
+    """Reader for the binary encoding of the search results"""
+
+    def __init__(self, data: bytes):
+        self.data = data
+        self.pos = 0
+
+    def byte(self) -> int:
+        self.pos += 1
+        return self.data[self.pos - 1]
+
+    def varint(self) -> int:
+        value = 0
+        shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if b < 0x80:
+                return value
+
+    def signed(self) -> int:
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+    def bytes(self, size: int) -> bytes:
+        self.pos += size
+        return self.data[self.pos - size:self.pos]
+
+    def string(self) -> str:
+        return self.bytes(self.varint()).decode()
+
+
+def _property_value(value: str):
+    if value == 'nan':
+        return None
+    try:
+        return float(value)
+    except ValueError:
+        return value
+
+
+def _label_as_json(label: str):
+    # same as the labels in the JSON search results
+    parts = label.split(';')
+    label_obj = {'sample': parts[0]}
+    properties = dict(part.split('=', 1) for part in parts[1:])
+    if properties:
+        label_obj['properties'] = {k: _property_value(v) for k, v in properties.items()}
+    return label_obj
+
+
+def _collapse_abundances(abundances: List[int]) -> List[str]:
+    # runs of equal non-zero abundances, as in the JSON results
+    ranges = []
+    start = 0
+    for i in range(1, len(abundances) + 1):
+        if i < len(abundances) and abundances[i] == abundances[start]:
+            continue
+        if abundances[start]:
+            ranges.append(f'{start}={abundances[start]}' if i == start + 1
+                          else f'{start}-{i - 1}={abundances[start]}')
+        start = i
+    return ranges
+
+
+def _collapse_coord_ranges(tuples: List[List[int]]) -> List[str]:
+    # ranges of consecutive coordinates matched by consecutive k-mers, formatted
+    # as '<first k-mer>-<first coord>[-<last coord>]', as in the JSON results
+    def _format(pos, first, last):
+        return f'{pos}-{first}' if first == last else f'{pos}-{first}-{last}'
+
+    range_strings = []
+    ranges = []
+    for i, coords in enumerate(tuples):
+        j = 0
+        next_ranges = []
+        for coord in coords:
+            while j < len(ranges) and ranges[j][2] + 1 < coord:
+                range_strings.append(_format(*ranges[j]))
+                j += 1
+            if j < len(ranges) and ranges[j][2] + 1 == coord:
+                pos, first, last = ranges[j]
+                next_ranges.append((pos, first, last + 1))
+                j += 1
+            else:
+                next_ranges.append((i, coord, coord))
+        range_strings.extend(_format(*r) for r in ranges[j:])
+        ranges = next_ranges
+
+    range_strings.extend(_format(*r) for r in ranges)
+    return range_strings
+
+
+def get_binary_index_version(data: bytes) -> int:
+    """
+    Version of the index that produced search results in the binary format.
+    The labels returned by /column_labels with the same version (the header
+    `X-Index-Version`) must be used to decode them.
+    """
+    return _BinaryReader(data).varint()
+
+
+def decode_binary_search_result(data: bytes, labels: List[str],
+                                per_kmer: bool = False) -> List[dict]:
+    """
+    Decode search results returned in the binary format (with the header
+    `Accept: application/x-metagraph-binary`) into the structure of the
+    JSON results. The signature is returned without score.
+
+    :param data: response from the server
+    :param labels: all column labels of the index, as returned by /column_labels
+                   for the same version of the index
+    :param per_kmer: return the k-mer abundances and coordinates as lists with
+                     an entry per k-mer, as the JSON results of a server run with
+                     --verbose, instead of collapsing them into ranges
+    """
+    reader = _BinaryReader(data)
+    reader.varint()  # index version
+    results = []
+    for _ in range(reader.varint()):
+        result = {'seq_description': reader.string()}
+
+        if reader.byte():
+            result['sequence'] = reader.string()
+            result['score'] = reader.signed()
+            result['max_score'] = reader.signed()
+            result['cigar'] = reader.string()
+            result['orientation'] = bool(reader.byte())
+
+        result_type = reader.varint()
+        result['results'] = []
+        for _ in range(reader.varint()):
+            label_obj = _label_as_json(labels[reader.varint()])
+            kmer_count = reader.varint()
+            if result_type != 0:
+                label_obj['kmer_count'] = kmer_count
+
+            if result_type == 2:
+                num_kmers = reader.varint()
+                mask = reader.bytes((num_kmers + 7) // 8)
+                label_obj['signature'] = {
+                    'presence_mask': ''.join(str((mask[i // 8] >> (i % 8)) & 1)
+                                             for i in range(num_kmers))
+                }
+            elif result_type == 3:
+                abundances = [reader.varint() for _ in range(reader.varint())]
+                label_obj['kmer_abundances'] = abundances if per_kmer \
+                                               else _collapse_abundances(abundances)
+            elif result_type == 4:
+                coords = []
+                for _ in range(reader.varint()):
+                    tuple_coords = []
+                    prev = 0
+                    for _ in range(reader.varint()):
+                        prev += reader.signed()
+                        tuple_coords.append(prev)
+                    coords.append(tuple_coords)
+                label_obj['kmer_coords'] = [','.join(map(str, c)) for c in coords] if per_kmer \
+                                           else _collapse_coord_ranges(coords)
+
+            result['results'].append(label_obj)
+
+        results.append(result)
+
+    return results
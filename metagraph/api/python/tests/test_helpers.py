@@ -40,3 +40,64 @@ def test_df_from_align_result(file_name, expected_shape):
 
     assert df.shape == expected_shape
     assert list(df.columns) == ['cigar', 'score', 'sequence', 'seq_description']
+
+
+def _varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return bytes(out)
+
+
+def _string(s):
+    return _varint(len(s)) + s.encode()
+
+
+def _binary_search_result():
+    return (_varint(7) + _varint(3)
+            # labels with counts, no alignment
+            + _string('0') + b'\x00' + _varint(1) + _varint(2)
+            + _varint(1) + _varint(200)
+            + _varint(0) + _varint(5)
+            # coordinates, aligned
+            + _string('1') + b'\x01' + _string('ACGT') + _varint(2 * 8) + _varint(2 * 10)
+            + _string('4=') + b'\x00'
+            + _varint(4) + _varint(1) + _varint(0) + _varint(3)
+            + _varint(3) + _varint(2) + _varint(2 * 295) + _varint(2 * 5)
+            + _varint(1) + _varint(2 * 296)
+            + _varint(0)
+            # abundances
+            + _string('2') + b'\x00' + _varint(3) + _varint(1)
+            + _varint(0) + _varint(3)
+            + _varint(4) + _varint(2) + _varint(2) + _varint(0) + _varint(1))
+
+
+def test_binary_index_version():
+    assert helpers.get_binary_index_version(_binary_search_result()) == 7
+
+
+@pytest.mark.parametrize("per_kmer,kmer_coords,kmer_abundances", [
+    (False, ['0-300', '0-295-296'], ['0-1=2', '3=1']),
+    (True, ['295,300', '296', ''], [2, 2, 0, 1]),
+])
+def test_decode_binary_search_result(per_kmer, kmer_coords, kmer_abundances):
+    labels = ['sample0', 'sample1;city=zurich;num_reads=300']
+    results = helpers.decode_binary_search_result(_binary_search_result(), labels,
+                                                  per_kmer=per_kmer)
+
+    assert results == [
+        {'seq_description': '0', 'results': [
+            {'sample': 'sample1', 'properties': {'city': 'zurich', 'num_reads': 300.0},
+             'kmer_count': 200},
+            {'sample': 'sample0', 'kmer_count': 5},
+        ]},
+        {'seq_description': '1', 'sequence': 'ACGT', 'score': 8, 'max_score': 10,
+         'cigar': '4=', 'orientation': False, 'results': [
+            {'sample': 'sample0', 'kmer_count': 3, 'kmer_coords': kmer_coords},
+        ]},
+        {'seq_description': '2', 'results': [
+            {'sample': 'sample0', 'kmer_count': 3, 'kmer_abundances': kmer_abundances},
+        ]},
+    ]
@@ -1,4 +1,5 @@
 #include <random>
+#include <sstream>
 
 #include <benchmark/benchmark.h>
 
@@ -76,4 +77,82 @@ static void BM_anno_get_rows_unique(benchmark::State &state) {
 }
 BENCHMARK(BM_anno_get_rows_unique) -> Unit(benchmark::kMillisecond);
 
+static void BM_anno_get_row_tuples(benchmark::State &state) {
+    auto anno = load_annotation();
+    const auto *tuple_matrix
+        = dynamic_cast<const annot::matrix::MultiIntMatrix *>(&anno->get_matrix());
+    if (!tuple_matrix) {
+        state.SkipWithError("This is not a coordinate annotation. Skipped.");
+        return;
+    }
+
+    auto rows = random_numbers(100'000, 0, tuple_matrix->num_rows() - 1);
+    std::sort(rows.begin(), rows.end());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(tuple_matrix->get_row_tuples(rows));
+    }
+}
+BENCHMARK(BM_anno_get_row_tuples) -> Unit(benchmark::kMillisecond);
+
+// sorted tuples of size |tuple_size| with gaps of up to 1000 between the values
+std::pair<bit_vector_smart, sdsl::int_vector<>> generate_tuples(size_t tuple_size) {
+    const size_t num_values = 1'000'000;
+    auto gaps = random_numbers(num_values, 1, 1000);
+    auto starts = random_numbers(num_values / tuple_size + 1, 0, 1llu << 34);
+
+    sdsl::bit_vector delims(num_values + num_values / tuple_size + 1, false);
+    sdsl::int_vector<> values(num_values, 0, 64);
+    uint64_t pos = 0;
+    for (size_t i = 0; i < num_values; ++i) {
+        if (i % tuple_size == 0) {
+            delims[pos++] = true;
+            values[i] = starts[i / tuple_size];
+        } else {
+            values[i] = values[i - 1] + gaps[i];
+        }
+        pos++;
+    }
+    delims[pos] = true;
+    sdsl::util::bit_compress(values);
+
+    return { bit_vector_smart(std::move(delims)), std::move(values) };
+}
+
+static void BM_tuples_decode_int_vector(benchmark::State &state) {
+    const size_t tuple_size = state.range(0);
+    auto [delims, values] = generate_tuples(tuple_size);
+
+    annot::matrix::MultiIntMatrix::Tuple tuple;
+    for (auto _ : state) {
+        for (size_t begin = 0; begin < values.size(); begin += tuple_size) {
+            tuple.clear();
+            for (size_t t = begin; t < begin + tuple_size; ++t) {
+                tuple.push_back(values[t]);
+            }
+            benchmark::DoNotOptimize(tuple.data());
+        }
+    }
+    state.counters["bytes"] = sdsl::size_in_bytes(values);
+}
+BENCHMARK(BM_tuples_decode_int_vector) -> Unit(benchmark::kMillisecond) -> Arg(1) -> Arg(4) -> Arg(32);
+
+static void BM_tuples_decode_vbyte(benchmark::State &state) {
+    const size_t tuple_size = state.range(0);
+    auto [delims, values] = generate_tuples(tuple_size);
+    annot::matrix::TupleVByteVector packed(delims, values);
+
+    annot::matrix::MultiIntMatrix::Tuple tuple;
+    for (auto _ : state) {
+        for (size_t begin = 0; begin < packed.size(); begin += tuple_size) {
+            packed.decode(begin, begin + tuple_size, &tuple);
+            benchmark::DoNotOptimize(tuple.data());
+        }
+    }
+    std::stringstream out;
+    packed.serialize(out);
+    state.counters["bytes"] = out.str().size();
+}
+BENCHMARK(BM_tuples_decode_vbyte) -> Unit(benchmark::kMillisecond) -> Arg(1) -> Arg(4) -> Arg(32);
+
 } // namespace
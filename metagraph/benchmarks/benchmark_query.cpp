@@ -1,6 +1,7 @@
 #include "benchmark/benchmark.h"
 
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "annotation/representation/column_compressed/annotate_column_compressed.hpp"
@@ -8,6 +9,7 @@
 #include "annotation/representation/annotation_matrix/static_annotators_def.hpp"
 #include "annotation/annotation_converters.hpp"
 #include "cli/query.hpp"
+#include "common/threads/numa.hpp"
 #include "common/utils/string_utils.hpp"
 #include "graph/annotated_dbg.hpp"
 #include "graph/representation/succinct/dbg_succinct.hpp"
@@ -134,6 +136,55 @@ BENCHMARK_TEMPLATE(BM_GetTopLabelSignatures, QueryMode::FAST)
     ->DenseRange(0, queries.size() - 1, 1);
 
 
+// Build the graph on the first NUMA node, optionally interleaving its memory
+// over all nodes, and map k-mers to it from a thread pinned to node |node|.
+// On multi-socket machines, this shows the lookup throughput per socket.
+static void BM_NumaLookup(benchmark::State& state) {
+    const bool interleave = state.range(0);
+    const size_t node = state.range(1);
+
+    std::unique_ptr<AnnotatedDBG> anno_graph;
+    std::thread([&]() {
+        common::pin_thread_to_numa_node(0);
+        common::NumaInterleaveScope numa_interleave(interleave);
+        anno_graph = build_anno_graph<annot::RowCompressed<>>(queries[1]);
+    }).join();
+
+    const auto &graph = anno_graph->get_graph();
+
+    std::vector<std::string> sequences;
+    seq_io::read_fasta_file_critical(queries[1], [&](kseq_t *stream) {
+        sequences.emplace_back(stream->seq.s);
+    });
+
+    size_t num_kmers = 0;
+    for (auto _ : state) {
+        std::thread([&]() {
+            common::pin_thread_to_numa_node(node);
+            for (const auto &sequence : sequences) {
+                graph.map_to_nodes(sequence, [&](auto i) {
+                    benchmark::DoNotOptimize(i);
+                    num_kmers++;
+                });
+            }
+        }).join();
+    }
+
+    state.SetItemsProcessed(num_kmers);
+}
+
+BENCHMARK(BM_NumaLookup)
+    ->Unit(benchmark::kMillisecond)
+    ->ArgNames({ "interleave", "node" })
+    ->Apply([](benchmark::internal::Benchmark *b) {
+        for (int64_t interleave : { 0, 1 }) {
+            for (size_t node = 0; node < common::get_num_numa_nodes(); ++node) {
+                b->Args({ interleave, static_cast<int64_t>(node) });
+            }
+        }
+    });
+
+
 template <size_t file_index>
 static void BM_BRWTCompressTranscripts(benchmark::State& state) {
     auto anno_graph = build_anno_graph<annot::ColumnCompressed<>>(queries[file_index]);
@@ -1,5 +1,7 @@
 #include "benchmark/benchmark.h"
 
+#include <algorithm>
+
 #include <sdsl/sd_vector.hpp>
 
 #include "common/unix_tools.hpp"
@@ -7,6 +9,8 @@
 #include "common/vectors/sd_vector_builder_disk.hpp"
 #include "common/vectors/bit_vector_sdsl.hpp"
 #include "common/vectors/bit_vector_sd.hpp"
+#include "common/vectors/bit_vector_adaptive.hpp"
+#include "common/vectors/bit_vector_cl.hpp"
 #include "common/data_generation.hpp"
 
 
@@ -187,6 +191,77 @@ INST_BV_QUERY_BENCHMARK(bit_vector_rrr<63>, cond_rank);
 INST_BV_QUERY_BENCHMARK(bit_vector_rrr<63>, get_int);
 INST_BV_QUERY_BENCHMARK(bit_vector_rrr<63>, call_ones);
 
+INST_BV_QUERY_BENCHMARK(bit_vector_stat, rank);
+INST_BV_QUERY_BENCHMARK(bit_vector_stat, select);
+INST_BV_QUERY_BENCHMARK(bit_vector_cl, rank);
+INST_BV_QUERY_BENCHMARK(bit_vector_cl, access);
+INST_BV_QUERY_BENCHMARK(bit_vector_cl, select);
+INST_BV_QUERY_BENCHMARK(bit_vector_cl, cond_rank);
+
+
+// Query batches of sorted indexes, either with single queries or with batch queries.
+// The vectors are accessed through the base class, as in annotation matrices.
+#define DEFINE_BV_BATCH_QUERY_BENCHMARK(NAME, OPERATION, BATCH_OPERATION, RESULT_TYPE, MIN_INDEX, RANGE) \
+template <class bit_vector_type, uint64_t size, unsigned int density_promille, bool batch> \
+static void BM_bv_query_batch_##NAME(benchmark::State& state) { \
+    DataGenerator gen; \
+    gen.set_seed(42); \
+ \
+    std::unique_ptr<bit_vector> bv { \
+        new bit_vector_type(gen.generate_random_column(size, density_promille / 1000.)) \
+    }; \
+    uint64_t max_index = bv->RANGE(); \
+    if (max_index <= MIN_INDEX) \
+        return; \
+ \
+    const size_t batch_size = state.range(0); \
+    std::vector<uint64_t> ids(batch_size); \
+    std::unique_ptr<RESULT_TYPE[]> result(new RESULT_TYPE[batch_size]); \
+ \
+    uint64_t i = 0; \
+    for (auto _ : state) { \
+        state.PauseTiming(); \
+        for (auto &id : ids) { \
+            id = MIN_INDEX + (i++ * 87'178'291'199) % (max_index - MIN_INDEX); \
+        } \
+        std::sort(ids.begin(), ids.end()); \
+        state.ResumeTiming(); \
+ \
+        if constexpr(batch) { \
+            bv->BATCH_OPERATION(ids.data(), ids.size(), result.get()); \
+        } else { \
+            for (size_t j = 0; j < ids.size(); ++j) { \
+                result[j] = bv->OPERATION(ids[j]); \
+            } \
+        } \
+        benchmark::DoNotOptimize(result.get()); \
+    } \
+    state.SetItemsProcessed(state.iterations() * batch_size); \
+    state.counters["Density"] = static_cast<double>(bv->num_set_bits()) / bv->size(); \
+}
+
+DEFINE_BV_BATCH_QUERY_BENCHMARK(rank,      rank1,             rank1_many,             uint64_t, 0, size);
+DEFINE_BV_BATCH_QUERY_BENCHMARK(access,    operator[],        get_many,               bool,     0, size);
+DEFINE_BV_BATCH_QUERY_BENCHMARK(select,    select1,           select1_many,           uint64_t, 1, num_set_bits);
+DEFINE_BV_BATCH_QUERY_BENCHMARK(cond_rank, conditional_rank1, conditional_rank1_many, uint64_t, 0, size);
+
+#define INST_BV_BATCH_QUERY_BENCHMARK(BV_TYPE, NAME) \
+BENCHMARK_TEMPLATE(BM_bv_query_batch_##NAME, BV_TYPE, 10000000, 10, false) -> Arg(1'000) -> Arg(100'000) -> Unit(benchmark::kMicrosecond); \
+BENCHMARK_TEMPLATE(BM_bv_query_batch_##NAME, BV_TYPE, 10000000, 10, true) -> Arg(1'000) -> Arg(100'000) -> Unit(benchmark::kMicrosecond); \
+BENCHMARK_TEMPLATE(BM_bv_query_batch_##NAME, BV_TYPE, 10000000, 500, false) -> Arg(1'000) -> Arg(100'000) -> Unit(benchmark::kMicrosecond); \
+BENCHMARK_TEMPLATE(BM_bv_query_batch_##NAME, BV_TYPE, 10000000, 500, true) -> Arg(1'000) -> Arg(100'000) -> Unit(benchmark::kMicrosecond);
+
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_stat, rank);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_stat, access);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_stat, select);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_stat, cond_rank);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_smallrank, rank);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_smallrank, access);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_smallrank, select);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_smallrank, cond_rank);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_cl, rank);
+INST_BV_BATCH_QUERY_BENCHMARK(bit_vector_cl, select);
+
 
 template <class t_ifstream, uint64_t t>
 static void BM_bv_query_random_sd_vector_access_every_nth_bit_set(benchmark::State& state) {
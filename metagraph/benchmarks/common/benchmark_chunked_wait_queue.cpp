@@ -2,12 +2,15 @@
 #include <fstream>
 #include <random>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include <benchmark/benchmark.h>
 #include <sdsl/uint128_t.hpp>
 #include <sdsl/uint256_t.hpp>
 
 #include "common/threads/chunked_wait_queue.hpp"
+#include "common/threads/multi_reader_chunked_wait_queue.hpp"
 
 
 namespace {
@@ -40,4 +43,71 @@ BENCHMARK_TEMPLATE(BM_queue_push_pop, uint64_t);
 BENCHMARK_TEMPLATE(BM_queue_push_pop, sdsl::uint128_t);
 BENCHMARK_TEMPLATE(BM_queue_push_pop, sdsl::uint256_t);
 
+
+constexpr uint32_t STREAM_SIZE = 10'000'000;
+constexpr size_t QUEUE_SIZE = 100'000;
+
+// one writer and one reader consuming the stream concurrently
+template <typename T>
+static void BM_queue_single_reader(benchmark::State &state) {
+    for (auto _ : state) {
+        common::ChunkedWaitQueue<T> queue(QUEUE_SIZE);
+        T sum = 0;
+        std::thread reader([&]() {
+            for (auto &it = queue.begin(); it != queue.end(); ++it) {
+                sum += *it;
+            }
+        });
+        for (uint32_t i = 0; i < STREAM_SIZE; ++i) {
+            queue.push(T(i));
+        }
+        queue.shutdown();
+        reader.join();
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * STREAM_SIZE);
+}
+
+// one writer and state.range(0) readers, each consuming the full stream
+// (BROADCAST) or a part of it (PARTITION)
+template <typename T, typename common::MultiReaderChunkedWaitQueue<T>::Mode mode>
+static void BM_queue_multi_reader(benchmark::State &state) {
+    const size_t num_readers = state.range(0);
+    for (auto _ : state) {
+        common::MultiReaderChunkedWaitQueue<T> queue(num_readers, QUEUE_SIZE, mode);
+        std::vector<T> sums(num_readers, 0);
+        std::vector<std::thread> readers;
+        for (size_t r = 0; r < num_readers; ++r) {
+            readers.emplace_back([&sums, r, reader = queue.reader()]() mutable {
+                T sum = 0;
+                reader.call_elements([&](const T &v) { sum += v; });
+                sums[r] = sum;
+            });
+        }
+        for (uint32_t i = 0; i < STREAM_SIZE; ++i) {
+            queue.push(T(i));
+        }
+        queue.shutdown();
+        for (auto &reader : readers) {
+            reader.join();
+        }
+        benchmark::DoNotOptimize(sums.data());
+    }
+    state.SetItemsProcessed(state.iterations() * STREAM_SIZE);
+}
+
+template <typename T>
+using MRQ = common::MultiReaderChunkedWaitQueue<T>;
+
+BENCHMARK_TEMPLATE(BM_queue_single_reader, uint64_t)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_single_reader, sdsl::uint256_t)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_multi_reader, uint64_t, MRQ<uint64_t>::BROADCAST)
+        ->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_multi_reader, uint64_t, MRQ<uint64_t>::PARTITION)
+        ->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_multi_reader, sdsl::uint256_t, MRQ<sdsl::uint256_t>::BROADCAST)
+        ->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_queue_multi_reader, sdsl::uint256_t, MRQ<sdsl::uint256_t>::PARTITION)
+        ->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+
 } // namespace
@@ -74,13 +74,15 @@ class EliasFanoFixture : public benchmark::Fixture {
         utils::TempFile tempfile;
         EliasFanoEncoderBuffered<T>::append_block(sorted, tempfile.name());
         for (auto _ : state) {
-            EliasFanoDecoder<T> decoder(tempfile.name());
+            EliasFanoDecoder<T> decoder(tempfile.name(), false);
             std::optional<T> value;
             sum_compressed = 0;
             while ((value = decoder.next()).has_value()) {
                 sum_compressed += value.value();
             }
         }
+        // report the decoding throughput in terms of the uncompressed size
+        state.SetBytesProcessed(state.iterations() * sorted.size() * sizeof(T));
     }
 
     void read_uncompressed(benchmark::State &state) {
@@ -103,6 +105,7 @@ class EliasFanoFixture : public benchmark::Fixture {
                           << std::endl;
             }
         }
+        state.SetBytesProcessed(state.iterations() * sorted.size() * sizeof(T));
     }
 
     void read_uncompressed1024(benchmark::State &state) {
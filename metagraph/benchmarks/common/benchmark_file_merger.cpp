@@ -74,7 +74,73 @@ static void BM_merge_files_pairs(benchmark::State &state) {
                   [](const std::string &s) { std::filesystem::remove(s); });
 }
 
+// Elias-Fano encoded chunks, as written by SortedSetDisk
+std::vector<std::string> create_ef_sources(size_t num_sources, size_t item_count) {
+    std::mt19937 rng(123457);
+    std::uniform_int_distribution<std::mt19937::result_type> dist10(0, 10);
+
+    std::vector<std::string> sources;
+    sources.reserve(num_sources);
+    for (uint32_t i = 0; i < num_sources; ++i) {
+        sources.push_back(chunk_prefix + "ef_" + std::to_string(i));
+        elias_fano::EliasFanoEncoderBuffered<uint64_t> encoder(sources.back(), 100'000);
+        for (uint64_t j = 0; j < item_count; ++j) {
+            encoder.add(j * 20 + dist10(rng));
+        }
+        encoder.finish();
+    }
+    return sources;
+}
+
+constexpr size_t EF_ITEM_COUNT = 1'000'000;
+
+static void BM_merge_ef_heap(benchmark::State &state) {
+    std::vector<std::string> sources = create_ef_sources(state.range(0), EF_ITEM_COUNT);
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        elias_fano::MergeDecoder<uint64_t> decoder(sources, false);
+        while (!decoder.empty()) {
+            sum += decoder.pop();
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0) * EF_ITEM_COUNT);
+    elias_fano::remove_chunks(sources);
+}
+
+static void BM_merge_ef_loser_tree(benchmark::State &state) {
+    std::vector<std::string> sources = create_ef_sources(state.range(0), EF_ITEM_COUNT);
+    uint64_t sum = 0;
+    for (auto _ : state) {
+        elias_fano::LoserTreeDecoder<uint64_t> decoder(sources, false);
+        while (!decoder.empty()) {
+            sum += decoder.pop();
+        }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations() * state.range(0) * EF_ITEM_COUNT);
+    elias_fano::remove_chunks(sources);
+}
+
+// merge into EF-encoded segments with the given number of threads
+static void BM_merge_ef_parallel(benchmark::State &state) {
+    std::vector<std::string> sources = create_ef_sources(state.range(0), EF_ITEM_COUNT);
+    for (auto _ : state) {
+        std::vector<std::string> segments = elias_fano::merge_files_parallel<uint64_t>(
+                sources, chunk_prefix + "merged", state.range(1), false);
+        elias_fano::remove_chunks(segments);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0) * EF_ITEM_COUNT);
+    elias_fano::remove_chunks(sources);
+}
+
 BENCHMARK(BM_merge_files)->DenseRange(10, 100, 10);
 BENCHMARK(BM_merge_files_pairs)->DenseRange(10, 100, 10);
+BENCHMARK(BM_merge_ef_heap)->Arg(16)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_merge_ef_loser_tree)->Arg(16)->Arg(64)->Arg(256)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_merge_ef_parallel)
+        ->ArgsProduct({ { 16, 64 }, { 1, 2, 4, 8, 16 } })
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
 
 } // namespace
@@ -1,7 +1,9 @@
 #include <cmath>
+#include <iostream>
 #include <random>
 
 #include <benchmark/benchmark.h>
+#include <htslib/bgzf.h>
 
 #include "graph/representation/succinct/dbg_succinct.hpp"
 #include "graph/representation/succinct/boss_construct.hpp"
@@ -93,4 +95,122 @@ BENCHMARK(BM_WriteContigs)
     ->Unit(benchmark::kMillisecond)
     ->DenseRange(1, 2, 1);
 
+
+const std::string fastq_gzip_file = "/tmp/bm_mg_reads.fq.gz";
+const std::string fastq_bgzf_file = "/tmp/bm_mg_reads.bgzf.fq.gz";
+
+// random reads of length 150
+std::string generate_fastq(size_t num_reads) {
+    const std::string alphabet = "ACGT";
+    std::mt19937 rng(123457);
+    std::string fastq;
+    for (size_t i = 0; i < num_reads; ++i) {
+        fastq += "@read" + std::to_string(i) + "\n";
+        for (size_t j = 0; j < 150; ++j) {
+            fastq += alphabet[rng() % 4];
+        }
+        fastq += "\n+\n";
+        for (size_t j = 0; j < 150; ++j) {
+            fastq += static_cast<char>('!' + rng() % 42);
+        }
+        fastq += '\n';
+    }
+    return fastq;
+}
+
+size_t prepare_fastq_files() {
+    static size_t num_bytes = 0;
+    if (num_bytes)
+        return num_bytes;
+
+    std::string fastq = generate_fastq(1'000'000);
+    num_bytes = fastq.size();
+
+    gzFile gz_out = gzopen(fastq_gzip_file.c_str(), "w");
+    if (gz_out == Z_NULL
+            || gzwrite(gz_out, fastq.data(), fastq.size()) != static_cast<int>(fastq.size())) {
+        std::cerr << "ERROR: Can't write to " << fastq_gzip_file << std::endl;
+        exit(1);
+    }
+    gzclose(gz_out);
+
+    BGZF *bgzf_out = bgzf_open(fastq_bgzf_file.c_str(), "w");
+    if (!bgzf_out
+            || bgzf_write(bgzf_out, fastq.data(), fastq.size()) != static_cast<ssize_t>(fastq.size())) {
+        std::cerr << "ERROR: Can't write to " << fastq_bgzf_file << std::endl;
+        exit(1);
+    }
+    bgzf_close(bgzf_out);
+
+    return num_bytes;
+}
+
+// single-threaded gzread + kseq, for reference
+static void BM_ReadFastqGzipKseq(benchmark::State& state) {
+    size_t num_bytes = prepare_fastq_files();
+
+    for (auto _ : state) {
+        gzFile input_p = gzopen(fastq_gzip_file.c_str(), "r");
+        seq_io::kseq_t *read_stream = seq_io::kseq_init(input_p);
+        size_t total_size = 0;
+        while (seq_io::kseq_read(read_stream) >= 0) {
+            total_size += read_stream->seq.l;
+        }
+        benchmark::DoNotOptimize(total_size);
+        seq_io::kseq_destroy(read_stream);
+        gzclose(input_p);
+    }
+    state.SetBytesProcessed(state.iterations() * num_bytes);
+}
+
+BENCHMARK(BM_ReadFastqGzipKseq)->Unit(benchmark::kMillisecond);
+
+
+template <bool bgzf>
+static void BM_ReadFastq(benchmark::State& state) {
+    size_t num_bytes = prepare_fastq_files();
+
+    set_num_threads(state.range(0));
+    for (auto _ : state) {
+        size_t total_size = 0;
+        seq_io::read_fasta_file_critical(bgzf ? fastq_bgzf_file : fastq_gzip_file,
+                                         [&](seq_io::kseq_t *read_stream) {
+                                             total_size += read_stream->seq.l;
+                                         });
+        benchmark::DoNotOptimize(total_size);
+    }
+    set_num_threads(1);
+    state.SetBytesProcessed(state.iterations() * num_bytes);
+}
+
+BENCHMARK_TEMPLATE(BM_ReadFastq, false)
+    ->Unit(benchmark::kMillisecond)
+    ->Arg(1);
+
+BENCHMARK_TEMPLATE(BM_ReadFastq, true)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(2)
+    ->Range(1, 16);
+
+
+static void BM_IterateFastqBgzf(benchmark::State& state) {
+    size_t num_bytes = prepare_fastq_files();
+
+    set_num_threads(state.range(0));
+    for (auto _ : state) {
+        size_t total_size = 0;
+        for (const seq_io::kseq_t &kseq : seq_io::FastaParser(fastq_bgzf_file)) {
+            total_size += kseq.seq.l;
+        }
+        benchmark::DoNotOptimize(total_size);
+    }
+    set_num_threads(1);
+    state.SetBytesProcessed(state.iterations() * num_bytes);
+}
+
+BENCHMARK(BM_IterateFastqBgzf)
+    ->Unit(benchmark::kMillisecond)
+    ->RangeMultiplier(2)
+    ->Range(1, 16);
+
 } // namespace
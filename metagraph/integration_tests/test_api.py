@@ -1,5 +1,6 @@
 import json
 import os
+import re
 import shlex
 import time
 import unittest
@@ -10,7 +11,7 @@ import requests
 import pandas as pd
 
 from metagraph.client import GraphClientJson, MultiGraphClient
-from concurrent.futures import Future
+from concurrent.futures import Future, ThreadPoolExecutor
 from parameterized import parameterized, parameterized_class
 
 from base import TestingBase, METAGRAPH, TEST_DATA_DIR
@@ -19,6 +20,9 @@ PROTEIN_MODE = os.readlink(METAGRAPH).endswith("_Protein")
 
 
 class TestAPIBase(TestingBase):
+    server_flags = ''
+    num_shards = 1
+
     @classmethod
     def setUpClass(cls, fasta_path, mode='basic', anno_repr='column'):
         super().setUpClass()
@@ -54,11 +58,13 @@ class TestAPIBase(TestingBase):
     def tearDownClass(cls):
         cls.server_process.kill()
 
-    def _start_server(self, graph, annotation):
-        construct_command = f'{METAGRAPH} server_query -i {graph} -a {annotation} \
-                                            --port {self.port} --address {self.host} -p {2}'
+    def _start_server(self, graph, annotation, **popen_args):
+        shards = ' '.join([f'-i {graph} -a {annotation}'] * self.num_shards)
+        construct_command = f'{METAGRAPH} server_query {shards} \
+                                            --port {self.port} --address {self.host} -p {2} \
+                                            {self.server_flags}'
 
-        return subprocess.Popen(shlex.split(construct_command))
+        return subprocess.Popen(shlex.split(construct_command), **popen_args)
 
 
 # No canonical mode for Protein alphabets
@@ -510,6 +516,39 @@ class TestAPIClientWithCoordinates(TestAPIBase):
         self.assertEqual(df['kmer_count'].sum(), self.expected_matches)
         self.assertEqual(df['kmer_coords'].size, self.sample_query_expected_rows)
 
+    def test_api_simple_query_coords_binary(self):
+        json_client = GraphClientJson(self.host, self.port)
+        binary_client = GraphClientJson(self.host, self.port, binary=True)
+
+        ret = requests.post(url=f'http://{self.host}:{self.port}/search',
+                            json={'FASTA': f'>0\n{self.sample_query}', 'num_labels': 100},
+                            headers={'Accept': 'application/x-metagraph-binary'})
+        self.assertEqual(ret.status_code, 200)
+        self.assertEqual(ret.headers['Content-Type'], 'application/x-metagraph-binary')
+
+        for query_coords in [False, True]:
+            json_results = json_client.search(self.sample_query, discovery_threshold=0.01,
+                                              query_coords=query_coords)
+            binary_results = binary_client.search(self.sample_query, discovery_threshold=0.01,
+                                                  query_coords=query_coords)
+
+            self.assertEqual(len(binary_results), 1)
+            self.assertEqual([(r['sample'], r['kmer_count']) for r in binary_results[0]['results']],
+                             [(r['sample'], r['kmer_count']) for r in json_results[0]['results']])
+            # the coordinates are collapsed into the same ranges as in JSON
+            self.assertEqual(binary_results, json_results)
+
+    def test_api_binary_labels_after_reload(self):
+        binary_client = GraphClientJson(self.host, self.port, binary=True)
+        results = binary_client.search(self.sample_query, discovery_threshold=0.01)
+
+        # labels cached for another version of the index are fetched again
+        labels = binary_client._labels[1]
+        binary_client._labels = (binary_client._labels[0] - 1, labels[::-1])
+        self.assertEqual(binary_client.search(self.sample_query, discovery_threshold=0.01),
+                         results)
+        self.assertEqual(binary_client._labels[1], labels)
+
 
 # No canonical mode for Protein alphabets
 @parameterized_class(('mode',),
@@ -647,3 +686,181 @@ class TestAPIClientParallel(TestAPIBase):
 
         for graph in self.graph_names:
             self.assertIsInstance(dfs[graph], ValueError)
+
+
+class TestAPIReload(TestAPIBase):
+    server_flags = '--mmap --allow-reload'
+
+    @classmethod
+    def setUpClass(cls):
+        super().setUpClass(TEST_DATA_DIR + '/transcripts_100.fa')
+
+    def setUp(self) -> None:
+        self.raw_post_request = lambda cmd, payload: requests.post(
+                                    url=f'http://{self.host}:{self.port}/{cmd}',
+                                    data=payload)
+
+    def test_api_reload_missing_file(self):
+        ret = self.raw_post_request('reload', json.dumps({"graph": "not_a_graph.dbg"}))
+
+        self.assertEqual(ret.status_code, 400)
+        self.assertIn("does not exist", ret.json()['error'])
+
+    def test_api_reload_corrupt_annotation(self):
+        stats = requests.get(url=f'http://{self.host}:{self.port}/stats').json()
+
+        corrupt_annotation = self.tempdir.name + '/corrupt.column.annodbg'
+        with open(corrupt_annotation, 'w') as f:
+            f.write('not an annotation')
+
+        ret = self.raw_post_request('reload', json.dumps({"annotation": corrupt_annotation}))
+        self.assertEqual(ret.status_code, 200)
+
+        # the failed reload keeps serving the old index
+        for _ in range(100):
+            ret = self.raw_post_request('reload', json.dumps({"shard": 1}))
+            if ret.status_code == 400:
+                break
+            self.assertEqual(ret.status_code, 409)
+            time.sleep(0.1)
+        else:
+            self.fail("The reload didn't finish")
+
+        self.assertIsNone(self.server_process.poll())
+        ret = requests.get(url=f'http://{self.host}:{self.port}/stats')
+        self.assertEqual(ret.status_code, 200)
+        self.assertEqual(stats, ret.json())
+
+    def test_api_reload(self):
+        stats = requests.get(url=f'http://{self.host}:{self.port}/stats').json()
+
+        ret = self.raw_post_request('reload', '')
+        self.assertEqual(ret.status_code, 200)
+
+        # the old index is served until the new one is loaded,
+        # further reloads are rejected until then
+        for _ in range(100):
+            ret = requests.get(url=f'http://{self.host}:{self.port}/stats')
+            self.assertEqual(ret.status_code, 200)
+            self.assertEqual(stats, ret.json())
+            ret = self.raw_post_request('reload', '')
+            if ret.status_code == 200:
+                break
+            self.assertEqual(ret.status_code, 409)
+            time.sleep(0.1)
+        else:
+            self.fail("The index wasn't reloaded")
+
+
+class TestAPIShards(TestAPIBase):
+    # the same index served twice, so every label is found in both shards
+    num_shards = 2
+    graph_name = 'test_graph'
+
+    sample_query = 'CCTCTGTGGAATCCAATCTGTCTTCCATCCTGCGTGGCCGAGGG'
+
+    @classmethod
+    def setUpClass(cls):
+        super().setUpClass(TEST_DATA_DIR + '/transcripts_100.fa')
+
+        cls.graph_client = MultiGraphClient()
+        cls.graph_client.add_graph(cls.host, cls.port, cls.graph_name)
+
+    def test_api_shards_stats(self):
+        ret = requests.get(url=f'http://{self.host}:{self.port}/stats')
+
+        self.assertEqual(ret.status_code, 200)
+        self.assertEqual(len(ret.json()['shards']), 2)
+
+    def test_api_shards_column_labels(self):
+        label_list = self.graph_client.column_labels()[self.graph_name]
+
+        self.assertEqual(len(label_list), 200)
+
+    def test_api_shards_merge_top_labels(self):
+        ret = self.graph_client.search(self.sample_query, parallel=False,
+                                       discovery_threshold=0.01, top_labels=1000)
+        df = ret[self.graph_name]
+
+        self.assertEqual(df.shape, (98 * 2, 3))
+        self.assertEqual(df['kmer_count'].sum(), 840 * 2)
+
+        ret = self.graph_client.search(self.sample_query, parallel=False,
+                                       discovery_threshold=0.01, top_labels=10)
+        df = ret[self.graph_name]
+
+        self.assertEqual(df.shape, (10, 3))
+        self.assertTrue(df['kmer_count'].is_monotonic_decreasing)
+
+
+class TestAPIBatching(TestAPIBase):
+    # the batches are logged in verbose mode
+    server_flags = '--batch-delay 100 -v'
+    graph_name = 'test_graph'
+
+    sample_query = 'CCTCTGTGGAATCCAATCTGTCTTCCATCCTGCGTGGCCGAGGG'
+
+    @classmethod
+    def setUpClass(cls):
+        super().setUpClass(TEST_DATA_DIR + '/transcripts_100.fa')
+
+        cls.graph_client = MultiGraphClient()
+        cls.graph_client.add_graph(cls.host, cls.port, cls.graph_name)
+
+    def _start_server(self, graph, annotation):
+        self.server_log = self.tempdir.name + '/server.log'
+        with open(self.server_log, 'w') as log:
+            return super()._start_server(self, graph, annotation, stderr=log)
+
+    def _batch_sizes(self):
+        with open(self.server_log) as log:
+            return [int(n) for n in re.findall(r'Querying a batch of (\d+) sequences', log.read())]
+
+    def test_api_batched_queries(self):
+        num_logged_batches = len(self._batch_sizes())
+
+        # concurrent requests with different sequences, batched together
+        queries = [self.sample_query, 'SEQUENCE_NOT_IN_GRAPH', self.sample_query[:30]]
+        with ThreadPoolExecutor(max_workers=len(queries) * 2) as executor:
+            futures = [executor.submit(self.graph_client.search, query, parallel=False,
+                                       discovery_threshold=0.01)
+                       for query in queries * 2]
+            dfs = [future.result()[self.graph_name] for future in futures]
+
+        for i in range(len(queries)):
+            self.assertTrue(dfs[i].equals(dfs[i + len(queries)]))
+
+        self.assertEqual(dfs[0].shape, (98, 3))
+        self.assertEqual(dfs[0]['kmer_count'].sum(), 840)
+        self.assertTrue(dfs[1].empty)
+        self.assertFalse(dfs[2].empty)
+
+        # all sequences were queried, some of them in the same batch
+        batch_sizes = self._batch_sizes()[num_logged_batches:]
+        self.assertEqual(sum(batch_sizes), len(queries) * 2)
+        self.assertLess(len(batch_sizes), len(queries) * 2)
+
+    def test_api_batched_request_without_header(self):
+        # the same parameters as in the client's requests, so they are batched together
+        payload = {'FASTA': self.sample_query, 'count_labels': True,
+                   'discovery_fraction': 0.01, 'num_labels': 100,
+                   'with_signature': False, 'abundance_sum': False,
+                   'query_counts': False, 'query_coords': False}
+
+        def post_without_header():
+            # let the valid request open the batch first
+            time.sleep(0.02)
+            return requests.post(url=f'http://{self.host}:{self.port}/search', json=payload)
+
+        with ThreadPoolExecutor(max_workers=2) as executor:
+            valid = executor.submit(self.graph_client.search, self.sample_query,
+                                    parallel=False, discovery_threshold=0.01)
+            without_header = executor.submit(post_without_header)
+            df = valid.result()[self.graph_name]
+            ret = without_header.result()
+
+        # the lines without a header don't extend the sequence of the valid request
+        self.assertEqual(ret.status_code, 200)
+        self.assertEqual(ret.json(), [])
+        self.assertEqual(df.shape, (98, 3))
+        self.assertEqual(df['kmer_count'].sum(), 840)
@@ -1719,5 +1719,36 @@ template
 StaticBinRelAnnotator<TupleBRWT, std::string>
 load_coords<MultiBRWTAnnotator>(MultiBRWTAnnotator&&, const std::vector<std::string> &);
 
+template <class BaseMatrix>
+TupleCSCMatrix<BaseMatrix, TupleVByteVector>
+pack_coords(TupleCSCMatrix<BaseMatrix>&& matrix, size_t num_threads) {
+    BaseMatrix index_matrix;
+    std::vector<bit_vector_smart> delimiters;
+    std::vector<sdsl::int_vector<>> column_values;
+    std::tie(index_matrix, delimiters, column_values) = matrix.release();
+
+    std::vector<TupleVByteVector> packed_values(column_values.size());
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (size_t j = 0; j < column_values.size(); ++j) {
+        packed_values[j] = TupleVByteVector(delimiters[j], column_values[j]);
+        column_values[j] = sdsl::int_vector<>();
+    }
+
+    logger->trace("Compressed coordinates in {} columns", packed_values.size());
+
+    return TupleCSCMatrix<BaseMatrix, TupleVByteVector>(std::move(index_matrix),
+                                                        std::move(delimiters),
+                                                        std::move(packed_values));
+}
+
+template
+TupleCSCMatrix<ColumnMajor, TupleVByteVector>
+pack_coords<ColumnMajor>(TupleCSC&&, size_t);
+
+template
+TupleCSCMatrix<BRWT, TupleVByteVector>
+pack_coords<BRWT>(TupleBRWT&&, size_t);
+
 } // namespace annot
 } // namespace mtg
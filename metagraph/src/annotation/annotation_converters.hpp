@@ -135,6 +135,15 @@ template <class Annotator>
 StaticBinRelAnnotator<matrix::TupleCSCMatrix<typename Annotator::binary_matrix_type>, std::string>
 load_coords(Annotator&& anno, const std::vector<std::string> &files);
 
+/**
+ * Compress the tuples of a coordinate matrix with delta and variable-byte
+ * encoding (see matrix::TupleVByteVector). The columns are converted in
+ * parallel, each one released right after it is compressed.
+ */
+template <class BaseMatrix>
+matrix::TupleCSCMatrix<BaseMatrix, matrix::TupleVByteVector>
+pack_coords(matrix::TupleCSCMatrix<BaseMatrix>&& matrix, size_t num_threads = 1);
+
 } // namespace annot
 } // namespace mtg
 
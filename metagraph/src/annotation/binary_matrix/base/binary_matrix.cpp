@@ -1,5 +1,8 @@
 #include "binary_matrix.hpp"
 
+#include <algorithm>
+#include <cassert>
+
 #include <ips4o.hpp>
 
 #include "common/vectors/bitmap.hpp"
@@ -15,6 +18,92 @@ namespace annot {
 namespace matrix {
 
 const size_t kRowBatchSize = 10'000;
+// scan the entire array of counts instead of sorting the touched columns
+// if more than 1/kDenseScanRatio of the columns are touched
+const size_t kDenseScanRatio = 16;
+
+
+/**
+ * Counts of columns accumulated over rows. The array of counts is reused
+ * across queries on the same thread, and only the touched entries are reset,
+ * so the cost of a query doesn't depend on the total number of columns.
+ */
+class ColumnCounts {
+  public:
+    typedef BinaryMatrix::Column Column;
+
+    // Get an empty accumulator owned by the calling thread
+    static ColumnCounts& get(uint64_t num_columns) {
+        static thread_local ColumnCounts col_counts;
+        // reset if a previous query was interrupted (e.g., by an exception)
+        col_counts.clear();
+        if (col_counts.counts_.size() < num_columns)
+            col_counts.counts_.resize(num_columns, 0);
+        col_counts.num_columns_ = num_columns;
+        return col_counts;
+    }
+
+    // If |admit_new| is false, only add to the columns counted already
+    inline void add(Column j, size_t count, bool admit_new = true) {
+        assert(j < num_columns_);
+        if (!counts_[j]) {
+            if (!admit_new || !count)
+                return;
+            touched_.push_back(j);
+        }
+        counts_[j] += count;
+        max_count_ = std::max(max_count_, counts_[j]);
+    }
+
+    // maximum count accumulated for a column
+    size_t max_count() const { return max_count_; }
+
+    // Return the columns with counts >= |min_count| in increasing order
+    // and reset the counts
+    std::vector<std::pair<Column, size_t>> extract(size_t min_count) {
+        std::vector<std::pair<Column, size_t>> result;
+
+        if (max_count_ < min_count) {
+            clear();
+            return result;
+        }
+
+        auto call_column = [&](Column j) {
+            if (counts_[j] >= min_count)
+                result.emplace_back(j, counts_[j]);
+            counts_[j] = 0;
+        };
+
+        if (touched_.size() * kDenseScanRatio > num_columns_) {
+            for (Column j = 0; j < num_columns_; ++j) {
+                call_column(j);
+            }
+        } else {
+            std::sort(touched_.begin(), touched_.end());
+            std::for_each(touched_.begin(), touched_.end(), call_column);
+        }
+
+        touched_.clear();
+        max_count_ = 0;
+        return result;
+    }
+
+  private:
+    ColumnCounts() {}
+
+    void clear() {
+        for (Column j : touched_) {
+            counts_[j] = 0;
+        }
+        touched_.clear();
+        max_count_ = 0;
+    }
+
+    std::vector<size_t> counts_;
+    std::vector<Column> touched_;
+    uint64_t num_columns_ = 0;
+    size_t max_count_ = 0;
+};
 
 
 std::vector<BinaryMatrix::SetBitPositions>
@@ -70,18 +159,29 @@ BinaryMatrix::sum_rows(const std::vector<std::pair<Row, size_t>> &index_counts,
                        size_t min_count) const {
     min_count = std::max(min_count, (size_t)1);
 
-    auto ic = index_counts;
+    // the total count of the rows not processed yet
+    size_t rest = 0;
+    for (const auto &[i, count] : index_counts) {
+        rest += count;
+    }
 
-    // FYI: one could use tsl::hopscotch_map for counting but it is slower
-    // than std::vector unless the number of columns is ~1M or higher
-    Vector<size_t> col_counts(num_columns(), 0);
+    if (rest < min_count)
+        return {};
+
+    auto ic = index_counts;
 
     // don't break the topological order for row-diff annotation
     if (!dynamic_cast<const IRowDiff *>(this))
         std::sort(ic.begin(), ic.end(), utils::LessFirst());
 
+    ColumnCounts &col_counts = ColumnCounts::get(num_columns());
+
     // limit the RAM usage by avoiding querying all the rows at once
     for (uint64_t begin = 0; begin < ic.size(); begin += kRowBatchSize) {
+        // stop if no column can reach |min_count| anymore
+        if (col_counts.max_count() + rest < min_count)
+            break;
+
         const uint64_t end = std::min(begin + kRowBatchSize,
                                       static_cast<uint64_t>(ic.size()));
 
@@ -93,24 +193,18 @@ BinaryMatrix::sum_rows(const std::vector<std::pair<Row, size_t>> &index_counts,
         const auto &rows = get_rows(ids);
 
         for (uint64_t i = begin; i < end; ++i) {
+            // columns not counted yet can't reach |min_count| anymore
+            const bool admit_new = rest >= min_count;
             for (size_t j : rows[i - begin]) {
-                col_counts[j] += ic[i].second;
+                col_counts.add(j, ic[i].second, admit_new);
             }
+            rest -= ic[i].second;
         }
     }
 
-    std::vector<std::pair<Column, size_t>> result;
-    result.reserve(col_counts.size());
-
-    for (Column j = 0; j < col_counts.size(); ++j) {
-        if (col_counts[j] >= min_count)
-            result.emplace_back(j, col_counts[j]);
-    }
-
-    return result;
+    return col_counts.extract(min_count);
 }
 
-
 std::vector<RainbowMatrix::SetBitPositions>
 RainbowMatrix::get_rows(const std::vector<Row> &rows) const {
     std::vector<Row> pointers = rows;
@@ -196,24 +290,19 @@ RainbowMatrix::sum_rows(const std::vector<std::pair<Row, size_t>> &index_counts,
         counts[row_ids[i]] += index_counts[i].second;
     }
 
-    // FYI: one could use tsl::hopscotch_map for counting but it is slower
-    // than std::vector unless the number of columns is ~1M or higher
-    Vector<size_t> col_counts(num_columns(), 0);
+    ColumnCounts &col_counts = ColumnCounts::get(num_columns());
+
+    size_t rest = total_sum_count;
     for (size_t i = 0; i < counts.size(); ++i) {
+        // columns not counted yet can't reach |min_count| anymore
+        const bool admit_new = rest >= min_count;
         for (size_t j : distinct_rows[i]) {
-            col_counts[j] += counts[i];
+            col_counts.add(j, counts[i], admit_new);
         }
+        rest -= counts[i];
     }
 
-    std::vector<std::pair<Column, size_t>> result;
-    result.reserve(col_counts.size());
-
-    for (Column j = 0; j < col_counts.size(); ++j) {
-        if (col_counts[j] >= min_count)
-            result.emplace_back(j, col_counts[j]);
-    }
-
-    return result;
+    return col_counts.extract(min_count);
 }
 
 
@@ -0,0 +1,186 @@
+#include "column_overlap.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "common/vectors/bit_vector_adaptive.hpp"
+#include "common/vectors/bit_vector_sdsl.hpp"
+#include "common/vectors/vector_algorithm.hpp"
+
+
+namespace mtg {
+namespace annot {
+namespace matrix {
+
+// store the positions of set bits if they take less space than the bitmap
+const uint64_t kMinDensityInverseSparse = 64;
+// gallop through the longer array if the arrays differ in length by this factor
+const uint64_t kGallopRatio = 32;
+// number of columns in each side of a tile
+const size_t kTileSize = 32;
+
+
+// A column prepared for computing overlaps
+struct OverlapColumn {
+    // uncompressed bitmap, either owned or borrowed from the input column
+    sdsl::bit_vector owned_bits;
+    const sdsl::bit_vector *bits = NULL;
+    // positions of the set bits if the column is sparse
+    std::vector<uint64_t> set_bits;
+
+    bool is_sparse() const { return !bits; }
+};
+
+static const sdsl::bit_vector* get_uncompressed(const bitmap &column) {
+    const bitmap *vector = &column;
+    if (const auto *adaptive = dynamic_cast<const bit_vector_adaptive *>(vector))
+        vector = &adaptive->data();
+
+    if (const auto *stat = dynamic_cast<const bit_vector_stat *>(vector))
+        return &stat->data();
+
+    return NULL;
+}
+
+static void prepare_column(const bitmap &column, OverlapColumn *result) {
+    if (column.num_set_bits() * kMinDensityInverseSparse < column.size()) {
+        result->set_bits.reserve(column.num_set_bits());
+        column.call_ones([&](uint64_t i) { result->set_bits.push_back(i); });
+
+    } else if (const sdsl::bit_vector *bits = get_uncompressed(column)) {
+        result->bits = bits;
+
+    } else {
+        result->owned_bits = sdsl::bit_vector(column.size(), false);
+        column.add_to(&result->owned_bits);
+        result->bits = &result->owned_bits;
+    }
+}
+
+static std::vector<OverlapColumn> prepare_columns(const std::vector<const bitmap *> &columns,
+                                                  size_t num_threads) {
+    std::vector<OverlapColumn> result(columns.size());
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (size_t i = 0; i < columns.size(); ++i) {
+        prepare_column(*columns[i], &result[i]);
+    }
+
+    return result;
+}
+
+// number of shared elements in two sorted arrays
+static uint64_t count_shared(const std::vector<uint64_t> &first,
+                             const std::vector<uint64_t> &second) {
+    if (first.size() > second.size())
+        return count_shared(second, first);
+
+    uint64_t count = 0;
+
+    if (first.size() * kGallopRatio < second.size()) {
+        auto it = second.begin();
+        for (uint64_t i : first) {
+            it = std::lower_bound(it, second.end(), i);
+            if (it == second.end())
+                break;
+
+            count += *it == i;
+        }
+        return count;
+    }
+
+    auto it_1 = first.begin();
+    auto it_2 = second.begin();
+    while (it_1 != first.end() && it_2 != second.end()) {
+        if (*it_1 < *it_2) {
+            ++it_1;
+        } else if (*it_1 > *it_2) {
+            ++it_2;
+        } else {
+            count++;
+            ++it_1;
+            ++it_2;
+        }
+    }
+    return count;
+}
+
+static uint64_t count_shared(const sdsl::bit_vector &bits,
+                             const std::vector<uint64_t> &set_bits) {
+    uint64_t count = 0;
+    for (uint64_t i : set_bits) {
+        count += bits[i];
+    }
+    return count;
+}
+
+static uint64_t compute_overlap(const OverlapColumn &first, const OverlapColumn &second) {
+    if (!first.is_sparse() && !second.is_sparse())
+        return inner_prod(*first.bits, *second.bits);
+
+    if (first.is_sparse() && second.is_sparse())
+        return count_shared(first.set_bits, second.set_bits);
+
+    return first.is_sparse() ? count_shared(*second.bits, first.set_bits)
+                             : count_shared(*first.bits, second.set_bits);
+}
+
+OverlapMatrix compute_column_overlaps(const std::vector<const bitmap *> &first,
+                                      const std::vector<const bitmap *> &second,
+                                      size_t num_threads) {
+    if (first.empty() || second.empty())
+        return OverlapMatrix::Zero(first.size(), second.size());
+
+    const bool symmetric = first == second;
+
+    for (const auto *columns : { &first, &second }) {
+        for (const bitmap *column : *columns) {
+            if (column->size() != first.front()->size())
+                throw std::runtime_error("Columns must have the same size");
+        }
+    }
+
+    std::vector<OverlapColumn> first_cols = prepare_columns(first, num_threads);
+    std::vector<OverlapColumn> second_cols;
+    if (!symmetric)
+        second_cols = prepare_columns(second, num_threads);
+
+    const auto &rows = first_cols;
+    const auto &cols = symmetric ? first_cols : second_cols;
+
+    OverlapMatrix result = OverlapMatrix::Zero(rows.size(), cols.size());
+
+    const size_t num_row_tiles = (rows.size() + kTileSize - 1) / kTileSize;
+    const size_t num_col_tiles = (cols.size() + kTileSize - 1) / kTileSize;
+
+    #pragma omp parallel for num_threads(num_threads) collapse(2) schedule(dynamic)
+    for (size_t ti = 0; ti < num_row_tiles; ++ti) {
+        for (size_t tj = 0; tj < num_col_tiles; ++tj) {
+            if (symmetric && tj < ti)
+                continue;
+
+            const size_t i_end = std::min((ti + 1) * kTileSize, rows.size());
+            const size_t j_end = std::min((tj + 1) * kTileSize, cols.size());
+            for (size_t i = ti * kTileSize; i < i_end; ++i) {
+                for (size_t j = symmetric ? std::max(i, tj * kTileSize) : tj * kTileSize;
+                                                                    j < j_end; ++j) {
+                    result(i, j) = compute_overlap(rows[i], cols[j]);
+                }
+            }
+        }
+    }
+
+    if (symmetric) {
+        for (size_t i = 1; i < rows.size(); ++i) {
+            for (size_t j = 0; j < i; ++j) {
+                result(i, j) = result(j, i);
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace matrix
+} // namespace annot
+} // namespace mtg
@@ -0,0 +1,40 @@
+#ifndef __COLUMN_OVERLAP_HPP__
+#define __COLUMN_OVERLAP_HPP__
+
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include "common/vectors/bitmap.hpp"
+
+
+namespace mtg {
+namespace annot {
+namespace matrix {
+
+typedef Eigen::Matrix<uint64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> OverlapMatrix;
+
+/**
+ * Compute the overlaps (inner products) of all pairs of columns, that is,
+ * result(i, j) = |first[i] & second[j]|, the number of rows in which both
+ * columns have a set bit. All columns must have the same size.
+ *
+ * Each column is prepared once, either as an uncompressed bitmap (reused
+ * without copying for bit_vector_stat columns) or, if it is sparse, as a
+ * sorted array of its set bits. Then, dense pairs are intersected with the
+ * SIMD popcount of |inner_prod|, sparse pairs by merging (or galloping), and
+ * mixed pairs by accessing the dense column at the set bits of the sparse
+ * one. The column pairs are split into tiles processed in parallel.
+ *
+ * If |first| and |second| are the same, only a half of the symmetric matrix
+ * is computed.
+ */
+OverlapMatrix compute_column_overlaps(const std::vector<const bitmap *> &first,
+                                      const std::vector<const bitmap *> &second,
+                                      size_t num_threads = 1);
+
+} // namespace matrix
+} // namespace annot
+} // namespace mtg
+
+#endif // __COLUMN_OVERLAP_HPP__
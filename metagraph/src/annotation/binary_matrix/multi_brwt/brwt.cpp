@@ -104,73 +104,44 @@ Vector<T> BRWT::slice_rows(const std::vector<Row> &row_ids) const {
     if (!child_nodes_.size()) {
         assert(assignments_.size() == 1);
 
-        for (Row i : row_ids) {
-            assert(i < num_rows());
-
-            if constexpr(utils::is_pair_v<T>) {
-                if (uint64_t rank = nonzero_rows_->conditional_rank1(i)) {
+        if constexpr(utils::is_pair_v<T>) {
+            std::vector<uint64_t> ranks(row_ids.size());
+            nonzero_rows_->conditional_rank1_many(row_ids.data(), row_ids.size(),
+                                                  ranks.data());
+            for (uint64_t rank : ranks) {
+                if (rank) {
                     // only a single column is stored in leaves
                     slice.emplace_back(0, rank);
                 }
-            } else {
-                if ((*nonzero_rows_)[i]) {
+                slice.push_back(delim);
+            }
+        } else {
+            std::unique_ptr<bool[]> bits(new bool[row_ids.size()]);
+            nonzero_rows_->get_many(row_ids.data(), row_ids.size(), bits.get());
+            for (size_t i = 0; i < row_ids.size(); ++i) {
+                if (bits[i]) {
                     // only a single column is stored in leaves
                     slice.push_back(0);
                 }
+                slice.push_back(delim);
             }
-            slice.push_back(delim);
         }
 
         return slice;
     }
 
-    // construct indexing for children and the inverse mapping
+    // map indexes from parent's to children's coordinate system,
+    // the rows with zero ranks are skipped
+    std::vector<uint64_t> ranks(row_ids.size());
+    nonzero_rows_->conditional_rank1_many(row_ids.data(), row_ids.size(), ranks.data());
+
+    // construct indexing for children
     std::vector<Row> child_row_ids;
     child_row_ids.reserve(row_ids.size());
 
-    std::vector<bool> skip_row(row_ids.size(), true);
-
-    for (size_t i = 0; i < row_ids.size(); ++i) {
-        assert(row_ids[i] < num_rows());
-
-        uint64_t global_offset = row_ids[i];
-
-        // if next word contains 5 or more positions, query the whole word
-        // we assume that get_int is roughly 5 times slower than operator[]
-        if (i + 4 < row_ids.size()
-                && row_ids[i + 4] < global_offset + 64
-                && row_ids[i + 4] >= global_offset
-                && global_offset + 64 <= nonzero_rows_->size()) {
-            // get the word
-            uint64_t word = nonzero_rows_->get_int(global_offset, 64);
-            uint64_t rank = -1ULL;
-
-            do {
-                // check index
-                uint8_t offset = row_ids[i] - global_offset;
-                if (word & (1ULL << offset)) {
-                    if (rank == -1ULL)
-                        rank = global_offset > 0
-                                ? nonzero_rows_->rank1(global_offset - 1)
-                                : 0;
-
-                    // map index from parent's to children's coordinate system
-                    child_row_ids.push_back(rank + sdsl::bits::cnt(word & sdsl::bits::lo_set[offset + 1]) - 1);
-                    skip_row[i] = false;
-                }
-            } while (++i < row_ids.size()
-                        && row_ids[i] < global_offset + 64
-                        && row_ids[i] >= global_offset);
-            --i;
-
-        } else {
-            // check index
-            if (uint64_t rank = nonzero_rows_->conditional_rank1(global_offset)) {
-                // map index from parent's to children's coordinate system
-                child_row_ids.push_back(rank - 1);
-                skip_row[i] = false;
-            }
-        }
+    for (uint64_t rank : ranks) {
+        if (rank)
+            child_row_ids.push_back(rank - 1);
     }
 
     if (!child_row_ids.size())
@@ -199,7 +170,7 @@ Vector<T> BRWT::slice_rows(const std::vector<Row> &row_ids) const {
     }
 
     for (size_t i = 0; i < row_ids.size(); ++i) {
-        if (!skip_row[i]) {
+        if (ranks[i]) {
             // merge rows from child submatrices
             for (auto &p : pos) {
                 while (*(++p) != delim) {
@@ -265,9 +236,11 @@ std::vector<BRWT::Row> BRWT::get_column(Column column) const {
 
     // shift indexes
     for (size_t i = 0; i < rows.size(); ++i) {
-        rows[i] = nonzero_rows_->select1(rows[i] + 1);
+        rows[i]++;
     }
-    return rows;
+    std::vector<BRWT::Row> result(rows.size());
+    nonzero_rows_->select1_many(rows.data(), rows.size(), result.data());
+    return result;
 }
 
 bool BRWT::load(std::istream &in) {
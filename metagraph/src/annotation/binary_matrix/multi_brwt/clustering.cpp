@@ -2,6 +2,7 @@
 
 #include <algorithm>
 
+#include <omp.h>
 #include <ips4o.hpp>
 #include <progress_bar.hpp>
 
@@ -216,21 +217,15 @@ inline bool first_closest(const P &first, const P &second) {
                     < std::min(std::get<0>(second), std::get<1>(second)));
 }
 
-// Input: columns, where each column `T` is either `sdsl::bit_vector` or
-// `SparseColumn` storing the column size and the positions of its set bits.
-// Output: a set of greedily matched column pairs.
-template <class T>
-Partition greedy_matching(const std::vector<T> &columns, size_t num_threads) {
-    if (!columns.size())
-        return {};
-
-    if (columns.size() > std::numeric_limits<uint32_t>::max()) {
-        std::cerr << "ERROR: too many columns" << std::endl;
-        exit(1);
-    }
-
-    auto similarities = correlation_similarity(columns, num_threads);
+typedef std::vector<std::tuple<uint32_t, uint32_t, float>> Similarities;
 
+// Pick pairs of the most similar columns greedily. If |pair_unmatched| is
+// true, the columns not matched to any other column are then paired in the
+// order of their indexes. Otherwise, they form singleton groups.
+Partition match_greedily(Similarities&& similarities,
+                         size_t num_columns,
+                         size_t num_threads,
+                         bool pair_unmatched = false) {
     ProgressBar progress_bar(similarities.size(), "Matching",
                              std::cerr, !common::get_verbose());
 
@@ -246,9 +241,9 @@ Partition greedy_matching(const std::vector<T> &columns, size_t num_threads) {
     );
 
     Partition partition;
-    partition.reserve((columns.size() + 1) / 2);
+    partition.reserve((num_columns + 1) / 2);
 
-    std::vector<uint_fast8_t> matched(columns.size(), false);
+    std::vector<uint_fast8_t> matched(num_columns, false);
 
     for (const auto &[i, j, sim] : similarities) {
         if (!matched[i] && !matched[j]) {
@@ -258,14 +253,223 @@ Partition greedy_matching(const std::vector<T> &columns, size_t num_threads) {
         ++progress_bar;
     }
 
-    for (size_t i = 0; i < columns.size(); ++i) {
-        if (!matched[i])
+    for (size_t i = 0; i < num_columns; ++i) {
+        if (matched[i])
+            continue;
+
+        if (pair_unmatched && partition.size() && partition.back().size() == 1
+                && !matched[partition.back()[0]]) {
+            matched[partition.back()[0]] = true;
+            partition.back().push_back(i);
+        } else {
             partition.push_back({ i });
+        }
     }
 
     return partition;
 }
 
+// Input: columns, where each column `T` is either `sdsl::bit_vector` or
+// `SparseColumn` storing the column size and the positions of its set bits.
+// Output: a set of greedily matched column pairs.
+template <class T>
+Partition greedy_matching(const std::vector<T> &columns, size_t num_threads) {
+    if (!columns.size())
+        return {};
+
+    if (columns.size() > std::numeric_limits<uint32_t>::max()) {
+        std::cerr << "ERROR: too many columns" << std::endl;
+        exit(1);
+    }
+
+    return match_greedily(correlation_similarity(columns, num_threads),
+                          columns.size(), num_threads);
+}
+
+
+// MinHash sketches for approximate matching (one-permutation hashing).
+// Every set bit is hashed once, the hash picks one of the bins of the sketch,
+// and the minimum hash value is kept in each bin. Thus, the sketch of a union
+// of columns is the element-wise minimum of their sketches.
+typedef uint32_t SketchValue;
+constexpr SketchValue kEmptyBin = std::numeric_limits<SketchValue>::max();
+// buckets of colliding columns larger than this are only
+// partially traversed to generate candidate pairs
+constexpr size_t kMaxBucketWindow = 32;
+
+inline uint64_t mix_hash(uint64_t x) {
+    // splitmix64 finalizer
+    x += 0x9e3779b97f4a7c15;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+template <class Callback>
+inline void call_set_bits(const sdsl::bit_vector &column, Callback callback) {
+    call_ones(column, callback);
+}
+
+template <class Callback>
+inline void call_set_bits(const SparseColumn &column, Callback callback) {
+    std::for_each(column.set_bits.begin(), column.set_bits.end(), callback);
+}
+
+template <class T>
+std::vector<SketchValue> compute_sketches(const std::vector<T> &columns,
+                                          size_t sketch_size,
+                                          size_t num_threads) {
+    std::vector<SketchValue> sketches(columns.size() * sketch_size, kEmptyBin);
+
+    ProgressBar progress_bar(columns.size(), "Sketching",
+                             std::cerr, !common::get_verbose());
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 64)
+    for (size_t i = 0; i < columns.size(); ++i) {
+        SketchValue *sketch = sketches.data() + i * sketch_size;
+        call_set_bits(columns[i], [&](uint64_t pos) {
+            uint64_t hash = mix_hash(pos);
+            SketchValue &bin = sketch[(hash >> 32) % sketch_size];
+            bin = std::min(bin, static_cast<SketchValue>(hash));
+        });
+        ++progress_bar;
+    }
+
+    return sketches;
+}
+
+// The sketch of each group is the element-wise minimum of the sketches
+// of the columns merged into that group
+std::vector<SketchValue> merge_sketches(const std::vector<SketchValue> &sketches,
+                                        const Partition &groups,
+                                        size_t sketch_size,
+                                        size_t num_threads) {
+    std::vector<SketchValue> merged(groups.size() * sketch_size, kEmptyBin);
+
+    #pragma omp parallel for num_threads(num_threads) schedule(static, 1024)
+    for (size_t g = 0; g < groups.size(); ++g) {
+        SketchValue *sketch = merged.data() + g * sketch_size;
+        for (uint64_t i : groups[g]) {
+            const SketchValue *other = sketches.data() + i * sketch_size;
+            for (size_t b = 0; b < sketch_size; ++b) {
+                sketch[b] = std::min(sketch[b], other[b]);
+            }
+        }
+    }
+
+    return merged;
+}
+
+// Fill in the empty bins with the values of their closest non-empty bins
+// to the right (rotation densification), so that columns with only a few
+// set bits can still collide with the others
+void densify(const SketchValue *sketch, size_t sketch_size, SketchValue *out) {
+    std::copy(sketch, sketch + sketch_size, out);
+
+    size_t last = sketch_size;
+    for (size_t b = 0; b < sketch_size; ++b) {
+        if (sketch[b] != kEmptyBin)
+            last = b;
+    }
+    // all bins are empty
+    if (last == sketch_size)
+        return;
+
+    SketchValue value = sketch[last];
+    uint64_t dist = 0;
+    for (size_t b = last + sketch_size; b > last; --b) {
+        size_t pos = b % sketch_size;
+        if (sketch[pos] != kEmptyBin) {
+            value = sketch[pos];
+            dist = 0;
+        } else {
+            out[pos] = mix_hash(value + ++dist);
+        }
+    }
+}
+
+// Generate candidate pairs of columns whose sketches coincide in at least
+// one band and compute the exact similarities only for these pairs
+template <class T>
+Similarities lsh_similarity(const std::vector<T> &cols,
+                            const std::vector<SketchValue> &sketches,
+                            size_t num_bands,
+                            size_t band_width,
+                            size_t num_threads) {
+    const size_t sketch_size = num_bands * band_width;
+    assert(sketches.size() == cols.size() * sketch_size);
+
+    // (band key, column)
+    std::vector<std::pair<uint64_t, uint32_t>> keys(cols.size() * num_bands);
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        std::vector<SketchValue> dense(sketch_size);
+
+        #pragma omp for schedule(static, 1024)
+        for (size_t i = 0; i < cols.size(); ++i) {
+            densify(sketches.data() + i * sketch_size, sketch_size, dense.data());
+            for (size_t b = 0; b < num_bands; ++b) {
+                uint64_t key = mix_hash(b);
+                for (size_t r = b * band_width; r < (b + 1) * band_width; ++r) {
+                    key = mix_hash(key ^ dense[r]);
+                }
+                keys[i * num_bands + b] = std::make_pair(key, i);
+            }
+        }
+    }
+
+    ips4o::parallel::sort(keys.begin(), keys.end(), std::less<>(), num_threads);
+
+    std::vector<size_t> bucket_begin;
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (!i || keys[i].first != keys[i - 1].first)
+            bucket_begin.push_back(i);
+    }
+    bucket_begin.push_back(keys.size());
+
+    std::vector<std::vector<std::pair<uint32_t, uint32_t>>> thread_pairs(num_threads);
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1024)
+    for (size_t k = 0; k + 1 < bucket_begin.size(); ++k) {
+        auto &pairs = thread_pairs[omp_get_thread_num()];
+        for (size_t i = bucket_begin[k]; i < bucket_begin[k + 1]; ++i) {
+            size_t end = std::min(bucket_begin[k + 1], i + 1 + kMaxBucketWindow);
+            for (size_t j = i + 1; j < end; ++j) {
+                pairs.emplace_back(keys[i].second, keys[j].second);
+            }
+        }
+    }
+    keys = decltype(keys)();
+
+    std::vector<std::pair<uint32_t, uint32_t>> candidates;
+    for (auto &pairs : thread_pairs) {
+        candidates.insert(candidates.end(), pairs.begin(), pairs.end());
+        pairs = std::vector<std::pair<uint32_t, uint32_t>>();
+    }
+
+    ips4o::parallel::sort(candidates.begin(), candidates.end(), std::less<>(), num_threads);
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    logger->trace("LSH: {} candidate pairs for {} columns", candidates.size(), cols.size());
+
+    Similarities similarities(candidates.size());
+
+    ProgressBar progress_bar(similarities.size(), "Correlations",
+                             std::cerr, !common::get_verbose());
+
+    #pragma omp parallel for num_threads(num_threads) schedule(static, 64)
+    for (size_t t = 0; t < candidates.size(); ++t) {
+        const auto [i, j] = candidates[t];
+        assert(i < j);
+        float sim = intersection_ratio(cols[i], cols[j]);
+        similarities[t] = std::tie(i, j, sim);
+        ++progress_bar;
+    }
+
+    return similarities;
+}
+
 void union_merge(const sdsl::bit_vector &first, sdsl::bit_vector *second) {
     assert(second);
     assert(first.size() == second->size());
@@ -299,8 +503,12 @@ uint64_t count_set_bits(const SparseColumn &v) {
     return v.set_bits.size();
 }
 
-template <class T>
-LinkageMatrix agglomerative_greedy_linkage(std::vector<T>&& columns, size_t num_threads) {
+// Merge the groups of columns returned by |get_groups| into new clusters
+// until a single cluster remains
+template <class T, class GetGroups>
+LinkageMatrix agglomerative_linkage(std::vector<T>&& columns,
+                                    size_t num_threads,
+                                    const GetGroups &get_groups) {
     if (columns.empty())
         return LinkageMatrix(0, 4);
 
@@ -314,7 +522,7 @@ LinkageMatrix agglomerative_greedy_linkage(std::vector<T>&& columns, size_t num_
     for (size_t level = 1; columns.size() > 1; ++level) {
         logger->trace("Clustering: level {}", level);
 
-        Partition groups = greedy_matching(columns, num_threads);
+        Partition groups = get_groups(columns);
 
         assert(groups.size() > 0);
         assert(groups.size() < columns.size());
@@ -365,12 +573,58 @@ LinkageMatrix agglomerative_greedy_linkage(std::vector<T>&& columns, size_t num_
     return linkage_matrix;
 }
 
+template <class T>
+LinkageMatrix agglomerative_greedy_linkage(std::vector<T>&& columns, size_t num_threads) {
+    return agglomerative_linkage(std::move(columns), num_threads,
+        [num_threads](const std::vector<T> &columns) {
+            return greedy_matching(columns, num_threads);
+        }
+    );
+}
+
 template
 LinkageMatrix agglomerative_greedy_linkage(std::vector<sdsl::bit_vector>&&, size_t);
 
 template
 LinkageMatrix agglomerative_greedy_linkage(std::vector<SparseColumn>&&, size_t);
 
+template <class T>
+LinkageMatrix agglomerative_lsh_linkage(std::vector<T>&& columns,
+                                        size_t num_threads,
+                                        size_t num_bands,
+                                        size_t band_width) {
+    if (!num_bands || !band_width)
+        throw std::runtime_error("Number of bands and band width must be non-zero");
+
+    if (columns.size() > std::numeric_limits<uint32_t>::max()) {
+        std::cerr << "ERROR: too many columns" << std::endl;
+        exit(1);
+    }
+
+    const size_t sketch_size = num_bands * band_width;
+    std::vector<SketchValue> sketches
+            = compute_sketches(columns, sketch_size, num_threads);
+
+    return agglomerative_linkage(std::move(columns), num_threads,
+        [&](const std::vector<T> &columns) {
+            Partition groups = match_greedily(
+                lsh_similarity(columns, sketches, num_bands, band_width, num_threads),
+                columns.size(), num_threads, true
+            );
+            sketches = merge_sketches(sketches, groups, sketch_size, num_threads);
+            return groups;
+        }
+    );
+}
+
+template
+LinkageMatrix agglomerative_lsh_linkage(std::vector<sdsl::bit_vector>&&,
+                                        size_t, size_t, size_t);
+
+template
+LinkageMatrix agglomerative_lsh_linkage(std::vector<SparseColumn>&&,
+                                        size_t, size_t, size_t);
+
 
 LinkageMatrix agglomerative_linkage_trivial(size_t num_columns) {
     if (!num_columns)
@@ -38,6 +38,17 @@ template <class T>
 LinkageMatrix
 agglomerative_greedy_linkage(std::vector<T>&& columns, size_t num_threads = 1);
 
+// Approximate version of |agglomerative_greedy_linkage| for large numbers of
+// columns. Instead of computing similarities for all column pairs, each column
+// is summarized by a MinHash sketch of |num_bands| x |band_width| values and
+// only pairs colliding in at least one band (LSH) are compared. Columns left
+// unmatched at a level are merged pairwise in their current order.
+// The output has the same format as the result of |agglomerative_greedy_linkage|.
+template <class T>
+LinkageMatrix
+agglomerative_lsh_linkage(std::vector<T>&& columns, size_t num_threads = 1,
+                          size_t num_bands = 16, size_t band_width = 4);
+
 // Merges points in their original order
 LinkageMatrix agglomerative_linkage_trivial(size_t num_columns);
 
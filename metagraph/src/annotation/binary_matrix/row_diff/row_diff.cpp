@@ -7,6 +7,7 @@
 #include "annotation/binary_matrix/multi_brwt/brwt.hpp"
 #include "annotation/binary_matrix/row_sparse/row_sparse.hpp"
 #include "common/utils/file_utils.hpp"
+#include "common/vectors/vector_algorithm.hpp"
 
 namespace mtg {
 namespace annot {
@@ -57,13 +58,17 @@ IRowDiff::get_rd_ids(const std::vector<BinaryMatrix::Row> &row_ids) const {
     const graph::boss::BOSS &boss = graph_->get_boss();
     const bit_vector &rd_succ = fork_succ_.size() ? fork_succ_ : boss.get_last();
 
+    // the queried rows start the paths, so check them all at once
+    std::unique_ptr<bool[]> is_anchor(new bool[row_ids.size()]);
+    anchor_.get_many(row_ids.data(), row_ids.size(), is_anchor.get());
+
     for (size_t i = 0; i < row_ids.size(); ++i) {
         Row row = row_ids[i];
 
         graph::boss::BOSS::edge_index boss_edge = graph_->kmer_to_boss_index(
                 graph::AnnotatedSequenceGraph::anno_to_graph_index(row));
 
-        while (true) {
+        for (bool first = true; ; first = false) {
             row = graph::AnnotatedSequenceGraph::graph_to_anno_index(
                     graph_->boss_to_kmer_index(boss_edge));
 
@@ -77,7 +82,7 @@ IRowDiff::get_rd_ids(const std::vector<BinaryMatrix::Row> &row_ids) const {
             if (!is_new)
                 break;
 
-            if (anchor_[row])
+            if (first ? is_anchor[i] : anchor_[row])
                 break;
 
             boss_edge = boss.row_diff_successor(boss_edge, rd_succ);
@@ -111,6 +116,83 @@ IRowDiff::get_rd_ids(const std::vector<BinaryMatrix::Row> &row_ids) const {
     return std::make_tuple(std::move(rd_ids), std::move(rd_paths_trunc), std::move(times_traversed));
 }
 
+std::vector<BinaryMatrix::Row>
+IRowDiff::reconstruct_column(const std::vector<BinaryMatrix::Row> &diff_column,
+                             uint64_t num_rows,
+                             size_t num_threads) const {
+    assert(graph_ && "graph must be loaded");
+    assert(anchor_.size() == num_rows && "anchors must be loaded");
+    assert(!fork_succ_.size() || fork_succ_.size() == graph_->get_boss().get_last().size());
+
+    using Row = BinaryMatrix::Row;
+
+    const graph::boss::BOSS &boss = graph_->get_boss();
+    const bit_vector &rd_succ = fork_succ_.size() ? fork_succ_ : boss.get_last();
+
+    sdsl::bit_vector diff(num_rows, false);
+    for (Row row : diff_column) {
+        diff[row] = true;
+    }
+
+    // rows for which the value in the column has been computed
+    sdsl::bit_vector computed(num_rows, false);
+    // the values in the reconstructed column
+    sdsl::bit_vector column(num_rows, false);
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        std::vector<Row> path;
+        path.reserve(RD_PATH_RESERVE_SIZE);
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (Row i = 0; i < num_rows; ++i) {
+            if (fetch_bit(computed.data(), i, true, __ATOMIC_ACQUIRE))
+                continue;
+
+            graph::boss::BOSS::edge_index boss_edge = graph_->kmer_to_boss_index(
+                    graph::AnnotatedSequenceGraph::anno_to_graph_index(i));
+
+            // skip dummy edges
+            if (!boss.get_W(boss_edge))
+                continue;
+
+            // walk the row-diff path until an anchor or a row that has
+            // already been computed (possibly, by another thread)
+            bool value = false;
+            Row row = i;
+            while (true) {
+                if (fetch_bit(computed.data(), row, true, __ATOMIC_ACQUIRE)) {
+                    value = fetch_bit(column.data(), row, true, __ATOMIC_RELAXED);
+                    break;
+                }
+
+                path.push_back(row);
+
+                if (anchor_[row])
+                    break;
+
+                boss_edge = boss.row_diff_successor(boss_edge, rd_succ);
+                row = graph::AnnotatedSequenceGraph::graph_to_anno_index(
+                        graph_->boss_to_kmer_index(boss_edge));
+            }
+
+            // propagate the value back to the rows in the path
+            for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                value ^= diff[*it];
+                if (value)
+                    set_bit(column.data(), *it, true, __ATOMIC_RELAXED);
+                set_bit(computed.data(), *it, true, __ATOMIC_RELEASE);
+            }
+            path.clear();
+        }
+    }
+
+    std::vector<Row> result;
+    result.reserve(sdsl::util::cnt_one_bits(column));
+    call_ones(column, [&](Row row) { result.push_back(row); });
+    return result;
+}
+
 } // namespace matrix
 } // namespace annot
 } // namespace mtg
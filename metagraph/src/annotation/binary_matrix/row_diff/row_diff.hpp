@@ -12,6 +12,7 @@
 #include "common/vector.hpp"
 #include "common/logger.hpp"
 #include "common/utils/template_utils.hpp"
+#include "common/threads/threading.hpp"
 #include "graph/annotated_dbg.hpp"
 #include "graph/representation/succinct/boss.hpp"
 #include "graph/representation/succinct/dbg_succinct.hpp"
@@ -25,6 +26,9 @@ const std::string kRowDiffAnchorExt = ".anchors";
 const std::string kRowDiffForkSuccExt = ".rd_succ";
 
 const size_t RD_PATH_RESERVE_SIZE = 2;
+// reconstruct rows with a dense bitmap if the total number of steps in the
+// row-diff paths is at least num_columns / RD_BITMAP_ACCUMULATION_RATIO
+const size_t RD_BITMAP_ACCUMULATION_RATIO = 64;
 
 
 class IRowDiff {
@@ -49,6 +53,13 @@ class IRowDiff {
     std::tuple<std::vector<BinaryMatrix::Row>, std::vector<std::vector<size_t>>, std::vector<size_t>>
     get_rd_ids(const std::vector<BinaryMatrix::Row> &row_ids) const;
 
+    // Reconstruct a column of the full matrix from the respective column of
+    // the diff matrix by propagating its set bits along the row-diff paths.
+    // Each row-diff path is traversed only once, in parallel over ranges of rows.
+    std::vector<BinaryMatrix::Row>
+    reconstruct_column(const std::vector<BinaryMatrix::Row> &diff_column,
+                       uint64_t num_rows, size_t num_threads) const;
+
     const graph::DBGSuccinct *graph_ = nullptr;
     anchor_bv_type anchor_;
     fork_succ_bv_type fork_succ_;
@@ -116,25 +127,9 @@ template <class BaseMatrix>
 std::vector<BinaryMatrix::Row> RowDiff<BaseMatrix>::get_column(Column column) const {
     assert(graph_ && "graph must be loaded");
     assert(anchor_.size() == diffs_.num_rows() && "anchors must be loaded");
+    assert(!fork_succ_.size() || fork_succ_.size() == graph_->get_boss().get_last().size());
 
-    const graph::boss::BOSS &boss = graph_->get_boss();
-    assert(!fork_succ_.size() || fork_succ_.size() == boss.get_last().size());
-
-    std::vector<Row> result;
-    // TODO: implement a more efficient algorithm
-    for (Row row = 0; row < num_rows(); ++row) {
-        auto edge = graph_->kmer_to_boss_index(
-            graph::AnnotatedSequenceGraph::anno_to_graph_index(row)
-        );
-
-        if (!boss.get_W(edge))
-            continue;
-
-        SetBitPositions set_bits = get_rows({ row })[0];
-        if (std::binary_search(set_bits.begin(), set_bits.end(), column))
-            result.push_back(row);
-    }
-    return result;
+    return reconstruct_column(diffs_.get_column(column), num_rows(), get_num_threads());
 }
 
 template <class BaseMatrix>
@@ -152,23 +147,80 @@ RowDiff<BaseMatrix>::get_rows(const std::vector<Row> &row_ids) const {
 
     rd_ids = std::vector<Row>();
 
+    // each diff row is decoded and sorted only once, even if it's shared by
+    // the row-diff paths of multiple query rows
+    size_t num_steps = 0;
+    for (size_t j = 0; j < rd_rows.size(); ++j) {
+        std::sort(rd_rows[j].begin(), rd_rows[j].end());
+        num_steps += times_traversed[j];
+    }
+
     // reconstruct annotation rows from row-diff
     std::vector<SetBitPositions> rows(row_ids.size());
 
+    if (num_columns() > num_steps * RD_BITMAP_ACCUMULATION_RATIO) {
+        // too few diffs to amortize the initialization of a dense bitmap,
+        // merge the sorted rows instead
+        for (size_t i = 0; i < row_ids.size(); ++i) {
+            SetBitPositions &result = rows[i];
+            // propagate back and reconstruct full annotations for predecessors
+            for (auto it = rd_paths_trunc[i].rbegin(); it != rd_paths_trunc[i].rend(); ++it) {
+                add_diff(rd_rows[*it], &result);
+                // replace diff row with full reconstructed annotation
+                if (--times_traversed[*it]) {
+                    rd_rows[*it] = result;
+                } else {
+                    // free memory
+                    rd_rows[*it] = {};
+                }
+            }
+        }
+        DEBUG_LOG("Reconstructed annotations for {} rows", rows.size());
+        assert(times_traversed == std::vector<size_t>(rd_rows.size(), 0));
+
+        return rows;
+    }
+
+    // Accumulate the diffs in a dense bitmap, which costs O(|diff|) per step
+    // instead of O(|row| + |diff|) for merging sorted rows. Full rows are only
+    // extracted from the bitmap at the end of each path and at the rows shared
+    // with other paths.
+    std::vector<uint64_t> bitmap((num_columns() + 63) / 64, 0);
+    // columns flipped in the bitmap since the last extraction (may repeat)
+    SetBitPositions touched;
+
+    // keep in |touched| only the unique columns currently set in the bitmap
+    auto extract_row = [&]() {
+        std::sort(touched.begin(), touched.end());
+        touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+        touched.erase(std::remove_if(touched.begin(), touched.end(),
+                                     [&](Column j) { return !((bitmap[j >> 6] >> (j & 63)) & 1); }),
+                      touched.end());
+    };
+
     for (size_t i = 0; i < row_ids.size(); ++i) {
-        SetBitPositions &result = rows[i];
         // propagate back and reconstruct full annotations for predecessors
         for (auto it = rd_paths_trunc[i].rbegin(); it != rd_paths_trunc[i].rend(); ++it) {
-            std::sort(rd_rows[*it].begin(), rd_rows[*it].end());
-            add_diff(rd_rows[*it], &result);
+            for (Column j : rd_rows[*it]) {
+                bitmap[j >> 6] ^= 1ull << (j & 63);
+                touched.push_back(j);
+            }
             // replace diff row with full reconstructed annotation
             if (--times_traversed[*it]) {
-                rd_rows[*it] = result;
+                extract_row();
+                rd_rows[*it] = touched;
             } else {
                 // free memory
                 rd_rows[*it] = {};
             }
         }
+        extract_row();
+        // reset the bitmap for the next row
+        for (Column j : touched) {
+            bitmap[j >> 6] &= ~(1ull << (j & 63));
+        }
+        rows[i] = touched;
+        touched.clear();
     }
     DEBUG_LOG("Reconstructed annotations for {} rows", rows.size());
     assert(times_traversed == std::vector<size_t>(rd_rows.size(), 0));
@@ -1,9 +1,12 @@
 #ifndef __TUPLE_CSC_MATRIX_HPP__
 #define __TUPLE_CSC_MATRIX_HPP__
 
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
 #include "annotation/int_matrix/base/int_matrix.hpp"
+#include "annotation/int_matrix/rank_extended/tuple_vbyte_vector.hpp"
 #include "common/logger.hpp"
 
 
@@ -17,6 +20,9 @@ namespace matrix {
  * Matrix which stores the non-empty tuples externally and indexes their
  * positions in a binary matrix. These values are indexed by rank1 called
  * on binary columns of the indexing matrix.
+ *
+ * The tuples are stored either as plain integers (sdsl::int_vector<>), or
+ * compressed (TupleVByteVector), in which case they are decoded in bulk.
  */
 template <class BaseMatrix,
           class Values = sdsl::int_vector<>,
@@ -66,6 +72,11 @@ class TupleCSCMatrix : public BinaryMatrix, public MultiIntMatrix, public GetEnt
 
     const BaseMatrix& get_binary_matrix() const { return binary_matrix_; }
 
+    // move out the index matrix, the tuple delimiters, and the tuples
+    std::tuple<BaseMatrix, std::vector<Delims>, std::vector<Values>> release() {
+        return { std::move(binary_matrix_), std::move(delimiters_), std::move(column_values_) };
+    }
+
   private:
     BaseMatrix binary_matrix_;
     std::vector<Delims> delimiters_;
@@ -112,9 +123,13 @@ TupleCSCMatrix<BaseMatrix, Values, Delims>::get_row_tuples(const std::vector<Row
             size_t begin = delimiters_[j].select1(r) + 1 - r;
             size_t end = delimiters_[j].select1(r + 1) - r;
             Tuple tuple;
-            tuple.reserve(end - begin);
-            for (size_t t = begin; t < end; ++t) {
-                tuple.push_back(column_values_[j][t]);
+            if constexpr(std::is_same_v<Values, TupleVByteVector>) {
+                column_values_[j].decode(begin, end, &tuple);
+            } else {
+                tuple.reserve(end - begin);
+                for (size_t t = begin; t < end; ++t) {
+                    tuple.push_back(column_values_[j][t]);
+                }
             }
             row_tuples[i].emplace_back(j, std::move(tuple));
         }
@@ -0,0 +1,256 @@
+#ifndef __TUPLE_VBYTE_VECTOR_HPP__
+#define __TUPLE_VBYTE_VECTOR_HPP__
+
+#include <cassert>
+#include <cstring>
+#include <array>
+#include <iostream>
+#include <vector>
+
+#ifdef __SSSE3__
+#include <immintrin.h>
+#endif
+
+#include <sdsl/int_vector.hpp>
+
+
+namespace mtg {
+namespace annot {
+namespace matrix {
+
+/**
+ * Compressed storage for the tuples (e.g., k-mer coordinates) of a column
+ * of TupleCSCMatrix.
+ *
+ * Tuples are delta encoded: the first value of each tuple is stored as is,
+ * each next one as the difference to its predecessor. The resulting numbers
+ * are stored in a layout similar to StreamVByte: a stream of 2-bit codes for
+ * the byte lengths of the numbers (1, 2, 4, or 8 bytes) and a stream of their
+ * bytes. Decoding takes one shuffle per pair of numbers. The position in the
+ * data stream is sampled every kSampleRate numbers.
+ *
+ * Tuples are expected to be sorted. Unsorted tuples are still decoded
+ * correctly, but their negative deltas take 8 bytes.
+ */
+class TupleVByteVector {
+  public:
+    static constexpr uint64_t kSampleRate = 64;
+
+    TupleVByteVector() {}
+
+    // |delims| delimits the tuples in |values| as in TupleCSCMatrix:
+    // 1 0^{size of tuple 1} 1 0^{size of tuple 2} 1 ... 1
+    template <class Delims, class Values>
+    TupleVByteVector(const Delims &delims, const Values &values);
+
+    // number of values stored
+    uint64_t size() const { return size_; }
+
+    // Decode values [begin, end), |begin| must be the first value of a tuple.
+    template <class Tuple>
+    void decode(uint64_t begin, uint64_t end, Tuple *tuple) const;
+
+    void load(std::istream &in);
+    void serialize(std::ostream &out) const;
+
+  private:
+    // padding for reading whole words past the end of the streams
+    static constexpr uint64_t kPadding = 16;
+
+    static uint8_t get_code(uint64_t value) {
+        return value < (1llu << 8) ? 0 : value < (1llu << 16) ? 1 : value < (1llu << 32) ? 2 : 3;
+    }
+
+    // read |size| bytes of a little-endian number at |data|
+    static uint64_t read_number(const uint8_t *data, uint8_t code) {
+        uint64_t value;
+        std::memcpy(&value, data, sizeof(value));
+        return code == 3 ? value : value & ((1llu << (8 << code)) - 1);
+    }
+
+    const uint8_t* codes() const { return reinterpret_cast<const uint8_t *>(codes_.data()); }
+    const uint8_t* data() const { return reinterpret_cast<const uint8_t *>(data_.data()); }
+
+    // position of the i-th number in the data stream
+    uint64_t get_offset(uint64_t i) const;
+
+    uint64_t size_ = 0;
+    // 2-bit codes, four per byte
+    sdsl::int_vector<8> codes_;
+    // bytes of the numbers
+    sdsl::int_vector<8> data_;
+    // positions of every kSampleRate-th number in data_
+    sdsl::int_vector<> samples_;
+};
+
+
+namespace vbyte {
+
+// total length of the four numbers whose codes are packed in a byte
+constexpr std::array<uint8_t, 256> kQuadLength = []() {
+    std::array<uint8_t, 256> lengths {};
+    for (size_t c = 0; c < 256; ++c) {
+        for (size_t t = 0; t < 4; ++t) {
+            lengths[c] += 1 << ((c >> (2 * t)) & 3);
+        }
+    }
+    return lengths;
+}();
+
+// total length of the two numbers whose codes are packed in 4 bits
+constexpr std::array<uint8_t, 16> kPairLength = []() {
+    std::array<uint8_t, 16> lengths {};
+    for (size_t c = 0; c < 16; ++c) {
+        lengths[c] = (1 << (c & 3)) + (1 << (c >> 2));
+    }
+    return lengths;
+}();
+
+// shuffle masks moving the bytes of two numbers to two 64-bit lanes
+constexpr std::array<std::array<uint8_t, 16>, 16> kPairShuffle = []() {
+    std::array<std::array<uint8_t, 16>, 16> masks {};
+    for (size_t c = 0; c < 16; ++c) {
+        const uint8_t first = 1 << (c & 3);
+        const uint8_t second = 1 << (c >> 2);
+        for (uint8_t b = 0; b < 8; ++b) {
+            // bytes with the highest bit set are zeroed
+            masks[c][b] = b < first ? b : 0x80;
+            masks[c][8 + b] = b < second ? first + b : 0x80;
+        }
+    }
+    return masks;
+}();
+
+} // namespace vbyte
+
+
+template <class Delims, class Values>
+TupleVByteVector::TupleVByteVector(const Delims &delims, const Values &values)
+      : size_(values.size()) {
+    std::vector<uint8_t> codes((size_ + 3) / 4 + kPadding, 0);
+    std::vector<uint8_t> data;
+    data.reserve(size_ * 4 + kPadding);
+    std::vector<uint64_t> samples;
+    samples.reserve(size_ / kSampleRate + 1);
+
+    uint64_t i = 0;
+    auto add_number = [&](uint64_t number) {
+        if (i % kSampleRate == 0)
+            samples.push_back(data.size());
+
+        uint8_t code = get_code(number);
+        codes[i / 4] |= code << (2 * (i % 4));
+        for (uint8_t b = 0; b < (1 << code); ++b) {
+            data.push_back(number >> (8 * b));
+        }
+        i++;
+    };
+
+    bool first = true;
+    uint64_t last_delim = 0;
+    delims.call_ones([&](uint64_t pos) {
+        if (!first) {
+            // encode the tuple of size |pos - last_delim - 1|
+            const uint64_t end = i + pos - last_delim - 1;
+            assert(end <= size_);
+            uint64_t prev = 0;
+            while (i < end) {
+                uint64_t value = values[i];
+                // unsigned difference, decoded back by the unsigned sum
+                add_number(value - prev);
+                prev = value;
+            }
+        }
+        first = false;
+        last_delim = pos;
+    });
+    assert(i == size_ && "delimiters must cover all values");
+    samples.push_back(data.size());
+
+    data.resize(data.size() + kPadding, 0);
+
+    codes_ = sdsl::int_vector<8>(codes.size());
+    std::copy(codes.begin(), codes.end(), codes_.begin());
+    data_ = sdsl::int_vector<8>(data.size());
+    std::copy(data.begin(), data.end(), data_.begin());
+
+    samples_ = sdsl::int_vector<>(samples.size());
+    std::copy(samples.begin(), samples.end(), samples_.begin());
+    sdsl::util::bit_compress(samples_);
+}
+
+inline uint64_t TupleVByteVector::get_offset(uint64_t i) const {
+    static_assert(kSampleRate % 4 == 0);
+
+    uint64_t offset = samples_[i / kSampleRate];
+    uint64_t j = i - i % kSampleRate;
+    for ( ; j + 4 <= i; j += 4) {
+        offset += vbyte::kQuadLength[codes()[j / 4]];
+    }
+    for ( ; j < i; ++j) {
+        offset += 1 << ((codes()[j / 4] >> (2 * (j % 4))) & 3);
+    }
+    return offset;
+}
+
+template <class Tuple>
+inline void TupleVByteVector::decode(uint64_t begin, uint64_t end, Tuple *tuple) const {
+    assert(begin <= end);
+    assert(end <= size_);
+
+    tuple->resize(end - begin);
+    if (begin == end)
+        return;
+
+    const uint8_t *data = this->data() + get_offset(begin);
+    uint64_t *out = tuple->data();
+
+    uint64_t i = begin;
+    for ( ; i + 1 < end; i += 2, out += 2) {
+        // codes of the two numbers, may span two bytes
+        uint16_t code_bytes;
+        std::memcpy(&code_bytes, codes() + i / 4, sizeof(code_bytes));
+        const uint8_t pair = (code_bytes >> (2 * (i % 4))) & 0xF;
+#ifdef __SSSE3__
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data));
+        __m128i mask = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(vbyte::kPairShuffle[pair].data())
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_shuffle_epi8(bytes, mask));
+#else
+        out[0] = read_number(data, pair & 3);
+        out[1] = read_number(data + (1 << (pair & 3)), pair >> 2);
+#endif
+        data += vbyte::kPairLength[pair];
+    }
+    if (i < end)
+        *out = read_number(data, (codes()[i / 4] >> (2 * (i % 4))) & 3);
+
+    // prefix sums restore the values from the deltas
+    uint64_t *values = tuple->data();
+    for (uint64_t t = 1; t < end - begin; ++t) {
+        values[t] += values[t - 1];
+    }
+}
+
+inline void TupleVByteVector::load(std::istream &in) {
+    in.read(reinterpret_cast<char *>(&size_), sizeof(size_));
+    codes_.load(in);
+    data_.load(in);
+    samples_.load(in);
+    if (!in.good())
+        throw std::ios_base::failure("Can't load TupleVByteVector");
+}
+
+inline void TupleVByteVector::serialize(std::ostream &out) const {
+    out.write(reinterpret_cast<const char *>(&size_), sizeof(size_));
+    codes_.serialize(out);
+    data_.serialize(out);
+    samples_.serialize(out);
+}
+
+} // namespace matrix
+} // namespace annot
+} // namespace mtg
+
+#endif // __TUPLE_VBYTE_VECTOR_HPP__
@@ -197,5 +197,8 @@ template class StaticBinRelAnnotator<TupleCSCMatrix<BRWT>, std::string>;
 template class StaticBinRelAnnotator<TupleRowDiff<TupleCSCMatrix<ColumnMajor>>, std::string>;
 template class StaticBinRelAnnotator<TupleRowDiff<TupleCSCMatrix<BRWT>>, std::string>;
 
+template class StaticBinRelAnnotator<TupleCSCMatrix<BRWT, TupleVByteVector>, std::string>;
+template class StaticBinRelAnnotator<TupleRowDiff<TupleCSCMatrix<BRWT, TupleVByteVector>>, std::string>;
+
 } // namespace annot
 } // namespace mtg
@@ -69,6 +69,10 @@ typedef StaticBinRelAnnotator<matrix::TupleRowDiff<matrix::TupleCSCMatrix<matrix
 
 typedef StaticBinRelAnnotator<matrix::TupleRowDiff<matrix::TupleCSCMatrix<matrix::BRWT>>, std::string> RowDiffBRWTCoordAnnotator;
 
+typedef StaticBinRelAnnotator<matrix::TupleCSCMatrix<matrix::BRWT, matrix::TupleVByteVector>, std::string> MultiBRWTCoordVByteAnnotator;
+
+typedef StaticBinRelAnnotator<matrix::TupleRowDiff<matrix::TupleCSCMatrix<matrix::BRWT, matrix::TupleVByteVector>>, std::string> RowDiffBRWTCoordVByteAnnotator;
+
 
 template <>
 inline const std::string RowFlatAnnotator::kExtension = ".flat.annodbg";
@@ -112,6 +116,10 @@ template <>
 inline const std::string RowDiffCoordAnnotator::kExtension = ".row_diff_coord.annodbg";
 template <>
 inline const std::string RowDiffBRWTCoordAnnotator::kExtension = ".row_diff_brwt_coord.annodbg";
+template <>
+inline const std::string MultiBRWTCoordVByteAnnotator::kExtension = ".brwt_coord_vbyte.annodbg";
+template <>
+inline const std::string RowDiffBRWTCoordVByteAnnotator::kExtension = ".row_diff_brwt_coord_vbyte.annodbg";
 
 } // namespace annot
 } // namespace mtg
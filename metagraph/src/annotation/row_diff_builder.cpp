@@ -39,6 +39,23 @@ using Encoder = mtg::elias_fano::EliasFanoEncoderBuffered<T>;
 #define _OMP_NONRCTGLR_LOOP schedule(dynamic)
 #endif
 
+// maximum number of blocks buffered for asynchronous reads and writes
+static size_t io_queue_depth = 2;
+// maximum memory taken by the buffered blocks
+static uint64_t io_buffer_bytes = 4'000'000'000;
+
+void set_row_diff_io_queue(size_t depth, uint64_t buffer_bytes) {
+    io_queue_depth = std::max(depth, size_t(1));
+    io_buffer_bytes = buffer_bytes;
+}
+
+// the depth of the I/O queue for blocks taking |block_bytes| bytes each
+size_t get_io_queue_depth(uint64_t block_bytes) {
+    return std::max(std::min(io_queue_depth,
+                             static_cast<size_t>(io_buffer_bytes / std::max(block_bytes, uint64_t(1)))),
+                    size_t(1));
+}
+
 std::vector<annot::ColumnCompressed<>>
 load_columns(const std::vector<std::string> &source_files, uint64_t *num_rows) {
     *num_rows = 0;
@@ -145,10 +162,9 @@ void count_labels_per_row(const std::vector<std::string> &source_files,
 
     // total number of set bits in the original rows
     std::vector<uint32_t> row_count_block;
-    // buffer for writing previous block while populating next row_count_block
-    std::vector<uint32_t> row_count_block_other;
 
-    ThreadPool async_writer(1, 1);
+    // write-behind: the blocks are moved to the queue and written asynchronously
+    AsyncIOQueue async_writer(get_io_queue_depth(BLOCK_SIZE * sizeof(uint32_t)));
 
     ProgressBar progress_bar(num_rows, "Count row labels", std::cerr, !common::get_verbose());
     uint64_t next_block_size = std::min(BLOCK_SIZE, num_rows);
@@ -182,12 +198,9 @@ void count_labels_per_row(const std::vector<std::string> &source_files,
 
         __atomic_thread_fence(__ATOMIC_ACQUIRE);
 
-        async_writer.join();
-        row_count_block_other.swap(row_count_block);
-
-        async_writer.enqueue([&,block_begin]() {
-            for (size_t i = 0; i < row_count_block_other.size(); ++i) {
-                uint32_t c = row_count_block_other[i];
+        async_writer.submit([&,block_begin,block=std::move(row_count_block)]() {
+            for (size_t i = 0; i < block.size(); ++i) {
+                uint32_t c = block[i];
                 if (new_vector) {
                     row_count.push_back(c);
                 } else if (c) {
@@ -199,7 +212,7 @@ void count_labels_per_row(const std::vector<std::string> &source_files,
         progress_bar += block_size;
     }
 
-    async_writer.join();
+    async_writer.wait();
 }
 
 
@@ -240,24 +253,49 @@ void sum_and_call_counts(const fs::path &dir,
         exit(1);
     }
 
-    std::vector<int32_t> buf;
+    const uint64_t size = vectors.front().size();
+
+    // read-ahead: the next blocks are read and summed up while
+    // the callback is called for the current one
+    AsyncIOQueue async_reader(get_io_queue_depth(BLOCK_SIZE * sizeof(int32_t)));
+    std::vector<std::vector<int32_t>> bufs(async_reader.depth() + 1);
+    std::vector<std::shared_future<void>> ready(bufs.size());
+    size_t num_blocks_submitted = 0;
+
+    auto read_ahead = [&]() {
+        uint64_t i = num_blocks_submitted * BLOCK_SIZE;
+        if (i >= size)
+            return;
+
+        std::vector<int32_t> &buf = bufs[num_blocks_submitted % bufs.size()];
+        ready[num_blocks_submitted % bufs.size()] = async_reader.submit([&,i]() {
+            // adjust if the last block
+            buf.assign(std::min(BLOCK_SIZE, size - i), 0);
+
+            #pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
+            for (size_t j = 0; j < vectors.size(); ++j) {
+                for (uint64_t t = 0; t < buf.size(); ++t) {
+                    __atomic_add_fetch(&buf[t], (int32_t)vectors[j][i + t], __ATOMIC_RELAXED);
+                }
+            }
 
-    ProgressBar progress_bar(vectors.front().size(), "Sum " + counts_name,
-                             std::cerr, !common::get_verbose());
+            __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        });
+        num_blocks_submitted++;
+    };
 
-    for (uint64_t i = 0; i < vectors.front().size(); i += BLOCK_SIZE) {
-        // adjust if the last block
-        buf.assign(std::min(BLOCK_SIZE, vectors.front().size() - i), 0);
+    for (size_t b = 0; b < async_reader.depth(); ++b) {
+        read_ahead();
+    }
 
-        #pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
-        for (size_t j = 0; j < vectors.size(); ++j) {
-            for (uint64_t t = 0; t < buf.size(); ++t) {
-                __atomic_add_fetch(&buf[t], (int32_t)vectors[j][i + t], __ATOMIC_RELAXED);
-            }
-        }
+    ProgressBar progress_bar(size, "Sum " + counts_name,
+                             std::cerr, !common::get_verbose());
 
-        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    for (uint64_t i = 0, b = 0; i < size; i += BLOCK_SIZE, ++b) {
+        ready[b % bufs.size()].get();
+        read_ahead();
 
+        const std::vector<int32_t> &buf = bufs[b % bufs.size()];
         std::for_each(buf.begin(), buf.end(), callback);
 
         progress_bar += buf.size();
@@ -368,6 +406,8 @@ void build_pred_succ(const std::string &graph_fname,
                              !common::get_verbose());
 
     const uint64_t BS = 1'000'000;
+    // write-behind: the blocks are appended to the files asynchronously
+    AsyncIOQueue async_writer(get_io_queue_depth(BS * 2 * (sizeof(uint64_t) + 1)));
     // traverse BOSS table in parallel processing blocks of size |BS|
     // use static scheduling to make threads process ordered contiguous blocks
     #pragma omp parallel for ordered num_threads(num_threads) schedule(dynamic)
@@ -414,13 +454,20 @@ void build_pred_succ(const std::string &graph_fname,
         #pragma omp ordered
         {
             // append to the files on disk
-            for (uint64_t v : succ_buf) { succ.push_back(v); }
-            for (bool v : succ_boundary_buf) { succ_boundary.push_back(v); }
-            for (uint64_t v : pred_buf) { pred.push_back(v); }
-            for (bool v : pred_boundary_buf) { pred_boundary.push_back(v); }
+            async_writer.submit([&,succ_buf=std::move(succ_buf),
+                                   succ_boundary_buf=std::move(succ_boundary_buf),
+                                   pred_buf=std::move(pred_buf),
+                                   pred_boundary_buf=std::move(pred_boundary_buf)]() {
+                for (uint64_t v : succ_buf) { succ.push_back(v); }
+                for (bool v : succ_boundary_buf) { succ_boundary.push_back(v); }
+                for (uint64_t v : pred_buf) { pred.push_back(v); }
+                for (bool v : pred_boundary_buf) { pred_boundary.push_back(v); }
+            });
         }
     }
 
+    async_writer.wait();
+
     logger->trace("Pred/succ nodes written to {}.pred/succ", outfbase);
 }
 
@@ -618,37 +665,50 @@ void traverse_anno_chunked(
     auto pred_it = pred.begin();
     auto pred_boundary_it = pred_boundary.begin();
 
-    ThreadPool async_reader(1, 1);
-    // start reading the first block
-    uint64_t next_block_size = std::min(BLOCK_SIZE, num_rows);
-    std::array<std::vector<uint64_t>, 4> context;
-    std::array<std::vector<uint64_t>, 4> context_other;
-    async_reader.enqueue(read_next_blocks,
-                         &succ_it, &succ_boundary_it,
-                         &pred_it, &pred_boundary_it,
-                         next_block_size, &context_other);
+    // read-ahead: up to |depth| next blocks are read while the current one
+    // is processed, each block is stored in its own context (succ/pred arrays)
+    AsyncIOQueue async_reader(get_io_queue_depth(BLOCK_SIZE * 4 * sizeof(uint64_t)));
+    std::vector<std::array<std::vector<uint64_t>, 4>> contexts(async_reader.depth() + 1);
+    std::vector<std::shared_future<void>> ready(contexts.size());
+    size_t num_blocks_submitted = 0;
+
+    auto read_ahead = [&]() {
+        uint64_t block_begin = num_blocks_submitted * BLOCK_SIZE;
+        if (block_begin >= num_rows)
+            return;
+
+        size_t slot = num_blocks_submitted % contexts.size();
+        ready[slot] = async_reader.submit(read_next_blocks,
+                                          &succ_it, &succ_boundary_it,
+                                          &pred_it, &pred_boundary_it,
+                                          std::min(BLOCK_SIZE, num_rows - block_begin),
+                                          &contexts[slot]);
+        num_blocks_submitted++;
+    };
+
+    // start reading the first blocks
+    for (size_t b = 0; b < async_reader.depth(); ++b) {
+        read_ahead();
+    }
 
     ProgressBar progress_bar(num_rows, "Compute diffs", std::cerr, !common::get_verbose());
 
     for (uint64_t chunk = 0; chunk < num_rows; chunk += BLOCK_SIZE) {
-        uint64_t block_size = next_block_size;
-        next_block_size = std::min(BLOCK_SIZE, num_rows - (chunk + block_size));
+        uint64_t block_size = std::min(BLOCK_SIZE, num_rows - chunk);
 
         before_chunk(block_size);
 
         // finish reading this block
-        async_reader.join();
-        context.swap(context_other);
+        size_t slot = (chunk / BLOCK_SIZE) % contexts.size();
+        ready[slot].get();
+        std::array<std::vector<uint64_t>, 4> &context = contexts[slot];
         std::vector<uint64_t> &succ_chunk = context[0];
         std::vector<uint64_t> &succ_chunk_idx = context[1];
         std::vector<uint64_t> &pred_chunk = context[2];
         std::vector<uint64_t> &pred_chunk_idx = context[3];
 
-        // start reading next block
-        async_reader.enqueue(read_next_blocks,
-                             &succ_it, &succ_boundary_it,
-                             &pred_it, &pred_boundary_it,
-                             next_block_size, &context_other);
+        // start reading the next block into the context released last
+        read_ahead();
 
         assert(succ_chunk.size() == succ_chunk_idx.back());
         assert(pred_chunk.size() == pred_chunk_idx.back());
@@ -679,6 +739,8 @@ void traverse_anno_chunked(
         progress_bar += block_size;
     }
 
+    async_reader.wait();
+
     if (succ_it != succ.end()
             || succ_boundary_it != succ_boundary.end()
             || pred_it != pred.end()
@@ -861,7 +923,8 @@ void convert_batch_to_row_diff(const std::string &pred_succ_fprefix,
         }
     }
 
-    ThreadPool async_writer(1, 1);
+    // write-behind: the blocks are moved to the queue and written asynchronously
+    AsyncIOQueue async_writer(get_io_queue_depth(BLOCK_SIZE * sizeof(uint32_t)));
     sdsl::int_vector_buffer<> row_reduction;
     const bool new_reduction_vector = !fs::exists(row_reduction_fname);
     if (compute_row_reduction) {
@@ -888,8 +951,6 @@ void convert_batch_to_row_diff(const std::string &pred_succ_fprefix,
 
     // total number of set bits in the original rows
     std::vector<uint32_t> row_nbits_block;
-    // buffer for writing previous block while populating next row_nbits_block
-    std::vector<uint32_t> row_nbits_block_other;
 
     // get bit at position |i| or its value
     auto get_value = [&](const bit_vector &col,
@@ -963,15 +1024,12 @@ void convert_batch_to_row_diff(const std::string &pred_succ_fprefix,
 
                 __atomic_thread_fence(__ATOMIC_ACQUIRE);
 
-                async_writer.join();
-                row_nbits_block_other.swap(row_nbits_block);
-
-                async_writer.enqueue([&,block_begin]() {
-                    for (size_t i = 0; i < row_nbits_block_other.size(); ++i) {
+                async_writer.submit([&,block_begin,block=std::move(row_nbits_block)]() {
+                    for (size_t i = 0; i < block.size(); ++i) {
                         if (new_reduction_vector) {
-                            row_reduction.push_back(row_nbits_block_other[i]);
+                            row_reduction.push_back(block[i]);
                         } else {
-                            row_reduction[block_begin + i] += row_nbits_block_other[i];
+                            row_reduction[block_begin + i] += block[i];
                         }
                     }
                 });
@@ -990,7 +1048,7 @@ void convert_batch_to_row_diff(const std::string &pred_succ_fprefix,
         }
     }
 
-    async_writer.join();
+    async_writer.wait();
 
     anchor = anchor_bv_type();
 
@@ -1091,21 +1149,18 @@ void convert_batch_to_row_diff(const std::string &pred_succ_fprefix,
 
         __atomic_thread_fence(__ATOMIC_ACQUIRE);
 
-        async_writer.join();
-        row_nbits_block_other.swap(row_nbits_block);
-
-        async_writer.enqueue([&,chunk]() {
-            for (uint64_t i = 0; i < row_nbits_block_other.size(); ++i) {
-                row_reduction[chunk + i] -= row_nbits_block_other[i];
+        async_writer.submit([&,chunk,block=std::move(row_nbits_block)]() {
+            for (uint64_t i = 0; i < block.size(); ++i) {
+                row_reduction[chunk + i] -= block[i];
                 // check if the row reduction is negative
                 if (row_reduction[chunk + i] >> (row_reduction.width() - 1))
                     num_larger_rows++;
             }
-            progress_bar += row_nbits_block_other.size();
+            progress_bar += block.size();
         });
     }
 
-    async_writer.join();
+    async_writer.wait();
 
     logger->trace("Rows with negative row reduction: {} in vector {}",
                   num_larger_rows, row_reduction_fname);
@@ -1183,7 +1238,8 @@ void convert_batch_to_row_diff_coord(const std::string &pred_succ_fprefix,
     };
 
     if (compute_row_reduction) {
-        ThreadPool async_writer(1, 1);
+        // write-behind: the blocks are moved to the queue and written asynchronously
+        AsyncIOQueue async_writer(get_io_queue_depth(BLOCK_SIZE * sizeof(uint32_t)));
         sdsl::int_vector_buffer<> row_reduction;
         const bool new_reduction_vector = !fs::exists(row_reduction_fname);
         logger->trace("Row reduction vector: {}", row_reduction_fname);
@@ -1208,8 +1264,6 @@ void convert_batch_to_row_diff_coord(const std::string &pred_succ_fprefix,
 
         // total number of set bits in the original rows
         std::vector<uint32_t> row_nbits_block;
-        // buffer for writing previous block while populating next row_nbits_block
-        std::vector<uint32_t> row_nbits_block_other;
 
         traverse_anno_chunked(
                 num_rows, pred_succ_fprefix, sources,
@@ -1233,22 +1287,19 @@ void convert_batch_to_row_diff_coord(const std::string &pred_succ_fprefix,
                 [&](uint64_t block_begin) {
                     __atomic_thread_fence(__ATOMIC_ACQUIRE);
 
-                    async_writer.join();
-                    row_nbits_block_other.swap(row_nbits_block);
-
-                    async_writer.enqueue([&,block_begin]() {
-                        for (size_t i = 0; i < row_nbits_block_other.size(); ++i) {
+                    async_writer.submit([&,block_begin,block=std::move(row_nbits_block)]() {
+                        for (size_t i = 0; i < block.size(); ++i) {
                             if (new_reduction_vector) {
-                                row_reduction.push_back(row_nbits_block_other[i]);
+                                row_reduction.push_back(block[i]);
                             } else {
-                                row_reduction[block_begin + i] += row_nbits_block_other[i];
+                                row_reduction[block_begin + i] += block[i];
                             }
                         }
                     });
                 }
         );
 
-        async_writer.join();
+        async_writer.wait();
         return;
     }
 
@@ -12,6 +12,11 @@
 namespace mtg {
 namespace annot {
 
+// Set the maximum number of blocks buffered for asynchronous reads (read-ahead)
+// and writes (write-behind) in the row-diff transform, and the maximum memory
+// these buffered blocks may take in total
+void set_row_diff_io_queue(size_t depth, uint64_t buffer_bytes);
+
 void count_labels_per_row(const std::vector<std::string> &source_files,
                           const std::string &row_count_fname,
                           bool with_coordinates = false);
@@ -1,5 +1,7 @@
 #include "align.hpp"
 
+#include <mutex>
+
 #include <tsl/hopscotch_set.h>
 
 #include "common/logger.hpp"
@@ -26,6 +28,9 @@ using namespace mtg::graph::align;
 using mtg::seq_io::kseq_t;
 using mtg::common::logger;
 
+// number of entries per thread in the caches shared by all alignment threads
+const size_t kCacheSizePerThread = 100'000;
+
 
 DBGAlignerConfig initialize_aligner_config(const Config &config,
                                            const DeBruijnGraph &graph) {
@@ -220,9 +225,11 @@ void gfa_map_files(const Config *config,
     logger->trace("Starting GFA mapping:");
 
     tsl::hopscotch_set<uint64_t> is_unitig_end_node;
+    std::mutex end_node_mutex;
 
     graph.call_unitigs(
         [&](const auto &, const auto &path) {
+            std::lock_guard<std::mutex> lock(end_node_mutex);
             is_unitig_end_node.insert(path.back());
         },
         get_num_threads()
@@ -362,6 +369,23 @@ int align_to_graph(Config *config) {
         anno_dbg = initialize_annotated_dbg(graph, *config);
     }
 
+    // Wrap the graph in CanonicalDBG if needed. The wrapper and its caches are
+    // thread-safe, so a single instance is shared by all threads and its caches
+    // stay warm across the batches.
+    std::shared_ptr<DeBruijnGraph> aln_graph = graph;
+    if (graph->get_mode() == DeBruijnGraph::PRIMARY) {
+        aln_graph = std::make_shared<CanonicalDBG>(graph, kCacheSizePerThread
+                                                            * get_num_threads());
+        logger->trace("Primary graph wrapped into canonical");
+        // If backwards traversal on DBGSuccinct will be needed, then
+        // add a cache to speed it up.
+        if (dbg_succ) {
+            aln_graph->add_extension(std::make_shared<NodeFirstCache>(
+                *dbg_succ, kCacheSizePerThread * get_num_threads()
+            ));
+        }
+    }
+
     for (const auto &file : files) {
         logger->trace("Align sequences from file {}", file);
         seq_io::FastaParser fasta_parser(file, config->forward_and_reverse);
@@ -400,22 +424,7 @@ int align_to_graph(Config *config) {
             }
 
             ++num_batches;
-            thread_pool.enqueue([&,graph,batch=std::move(seq_batch)]() {
-                // Make a dummy shared_ptr
-                auto aln_graph
-                    = std::shared_ptr<DeBruijnGraph>(std::shared_ptr<DeBruijnGraph>{}, graph.get());
-
-                // Wrap it in CanonicalDBG if needed. This way, each thread gets its
-                // own wrapper (and more importantly, its own local cache).
-                if (aln_graph->get_mode() == DeBruijnGraph::PRIMARY) {
-                    aln_graph = std::make_shared<CanonicalDBG>(aln_graph);
-                    logger->trace("Primary graph wrapped into canonical");
-                    // If backwards traversal on DBGSuccinct will be needed, then
-                    // add a cache to speed it up.
-                    if (dbg_succ)
-                        aln_graph->add_extension(std::make_shared<NodeFirstCache>(*dbg_succ));
-                }
-
+            thread_pool.enqueue([&,batch=std::move(seq_batch)]() {
                 std::unique_ptr<IDBGAligner> aligner;
 
                 if (anno_dbg) {
@@ -444,6 +453,17 @@ int align_to_graph(Config *config) {
                       get_curr_RSS() / 1e6, timer.elapsed());
     }
 
+    if (const auto *canonical = dynamic_cast<const CanonicalDBG*>(aln_graph.get())) {
+        logger->trace("Palindrome cache hits: {}, misses: {}",
+                      canonical->get_cache().num_hits(),
+                      canonical->get_cache().num_misses());
+    }
+    if (auto node_first_cache = aln_graph->get_extension<NodeFirstCache>()) {
+        logger->trace("Node first character cache hits: {}, misses: {}",
+                      node_first_cache->get_cache().num_hits(),
+                      node_first_cache->get_cache().num_misses());
+    }
+
     return 0;
 }
 
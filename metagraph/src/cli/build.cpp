@@ -34,6 +34,17 @@ void push_sequences(const std::vector<std::string> &files,
                     GraphConstructor *constructor) {
     #pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic, 1)
     for (size_t i = 0; i < files.size(); ++i) {
+        if (file_format(files[i]) == "KMC") {
+            // pass the packed nucleotide codes to the constructor directly,
+            // without decoding the k-mers into strings
+            parse_kmc_kmers(files[i], config,
+                [constructor](size_t k, auto&& codes, auto&& counts) {
+                    constructor->add_kmers(k, std::move(codes), std::move(counts));
+                }
+            );
+            continue;
+        }
+
         BatchAccumulator<std::pair<std::string, uint64_t>> batcher(
             [constructor](auto&& sequences) {
                 constructor->add_sequences(std::move(sequences));
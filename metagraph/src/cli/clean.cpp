@@ -6,6 +6,7 @@
 #include "common/algorithms.hpp"
 #include "common/unix_tools.hpp"
 #include "common/utils/template_utils.hpp"
+#include "common/threads/per_thread.hpp"
 #include "common/threads/threading.hpp"
 #include "common/vectors/vector_algorithm.hpp"
 #include "graph/representation/succinct/dbg_succinct.hpp"
@@ -23,6 +24,11 @@ namespace cli {
 using mtg::common::logger;
 using mtg::seq_io::FastaWriter;
 using mtg::seq_io::ExtendedFastaWriter;
+using mtg::common::PerThread;
+using mtg::common::BufferedSequenceWriter;
+
+// Estimated number of bytes accumulated by each thread before writing to disk
+const uint64_t kThreadBufferSize = 1'000'000;
 
 
 int clean_graph(Config *config) {
@@ -77,12 +83,16 @@ int clean_graph(Config *config) {
             // skip zero k-mer counts for dummy k-mers in DBGSuccinct
             const auto _graph = dynamic_cast<graph::DBGSuccinct*>(graph.get())
                     ? std::make_shared<graph::MaskedDeBruijnGraph>(graph,
-                        [&](auto i) { return (*node_weights)[i] > 0; }, true)
+                        graph::materialize_mask(*graph,
+                            [&](auto i) { return (*node_weights)[i] > 0; },
+                            get_num_threads()),
+                        true)
                     : graph;
 
             uint64_t cutoff
                 = estimate_min_kmer_abundance(*_graph, *node_weights,
-                                              config->num_singleton_kmers);
+                                              config->num_singleton_kmers,
+                                              get_num_threads());
 
             if (cutoff != static_cast<uint64_t>(-1)) {
                 config->min_unitig_median_kmer_abundance = cutoff;
@@ -103,8 +113,10 @@ int clean_graph(Config *config) {
             const auto &weights = *graph->get_extension<graph::NodeWeights>();
 
             graph = std::make_shared<graph::MaskedDeBruijnGraph>(graph,
-                [&](auto i) { return weights[i] >= config->min_count
-                                    && weights[i] <= config->max_count; },
+                graph::materialize_mask(*graph,
+                    [&](auto i) { return weights[i] >= config->min_count
+                                        && weights[i] <= config->max_count; },
+                    get_num_threads()),
                 true,
                 graph->get_mode()
             );
@@ -155,11 +167,12 @@ int clean_graph(Config *config) {
     };
 
     auto dump_contigs_to_fasta = [&](const std::string &outfbase, auto call_contigs) {
-        std::mutex seq_mutex;
         uint64_t num_bp = 0;
         uint64_t num_kmers = 0;
         std::string fasta_fname;
 
+        // the unitigs are filtered and prepared for writing concurrently,
+        // and passed to the writer in large batches
         if (node_weights) {
             if (!node_weights->is_compatible(*graph)) {
                 logger->error("k-mer counts are not compatible with the subgraph");
@@ -172,20 +185,31 @@ int clean_graph(Config *config) {
                                                  config->header,
                                                  config->enumerate_out_sequences,
                                                  get_num_threads() > 1);
-            call_contigs([&](const std::string &contig, const auto &path) {
-                std::vector<uint32_t> kmer_counts;
-                kmer_counts.reserve(path.size());
-                for (auto node : path) {
-                    kmer_counts.push_back((*node_weights)[node]);
-                }
-                // smooth k-mer counts in the unitig
-                utils::smooth_vector(config->smoothing_window, &kmer_counts);
-
-                std::lock_guard<std::mutex> lock(seq_mutex);
-                writer.write(contig, kmer_counts);
-                num_bp += contig.size();
-                num_kmers += contig.size() - graph->get_k() + 1;
-            }, get_num_threads());
+            {
+                typedef std::pair<std::string, std::vector<uint32_t>> Contig;
+                BufferedSequenceWriter<Contig> buffered_writer(
+                    [&](std::vector<Contig>&& batch) {
+                        for (auto &[contig, kmer_counts] : batch) {
+                            num_bp += contig.size();
+                            num_kmers += contig.size() - graph->get_k() + 1;
+                            writer.write(std::move(contig), std::move(kmer_counts));
+                        }
+                    },
+                    kThreadBufferSize
+                );
+                call_contigs([&](const std::string &contig, const auto &path) {
+                    std::vector<uint32_t> kmer_counts;
+                    kmer_counts.reserve(path.size());
+                    for (auto node : path) {
+                        kmer_counts.push_back((*node_weights)[node]);
+                    }
+                    // smooth k-mer counts in the unitig
+                    utils::smooth_vector(config->smoothing_window, &kmer_counts);
+
+                    uint64_t num_bytes = contig.size() + kmer_counts.size() * sizeof(uint32_t);
+                    buffered_writer.write(Contig(contig, std::move(kmer_counts)), num_bytes);
+                }, get_num_threads());
+            }
 
             fasta_fname = writer.get_fasta_fname();
 
@@ -193,13 +217,21 @@ int clean_graph(Config *config) {
             FastaWriter writer(outfbase, config->header,
                                config->enumerate_out_sequences,
                                get_num_threads() > 1);
-
-            call_contigs([&](const std::string &contig, const auto &) {
-                std::lock_guard<std::mutex> lock(seq_mutex);
-                writer.write(contig);
-                num_bp += contig.size();
-                num_kmers += contig.size() - graph->get_k() + 1;
-            }, get_num_threads());
+            {
+                BufferedSequenceWriter<std::string> buffered_writer(
+                    [&](std::vector<std::string>&& batch) {
+                        for (std::string &contig : batch) {
+                            num_bp += contig.size();
+                            num_kmers += contig.size() - graph->get_k() + 1;
+                            writer.write(std::move(contig));
+                        }
+                    },
+                    kThreadBufferSize
+                );
+                call_contigs([&](const std::string &contig, const auto &) {
+                    buffered_writer.write(std::string(contig), contig.size());
+                }, get_num_threads());
+            }
 
             fasta_fname = writer.get_fname();
         }
@@ -231,14 +263,24 @@ int clean_graph(Config *config) {
             // cleaning required
             sdsl::bit_vector removed_nodes(weights.size(), 1);
 
+            // the callback is called concurrently, so count k-mers per thread
+            PerThread<tsl::hopscotch_map<uint64_t, uint64_t>> thread_hists;
+
             call_clean_contigs([&](const std::string&, const auto &path) {
+                auto &hist = thread_hists.local();
                 for (auto i : path) {
                     assert(weights[i]);
-                    count_hist[weights[i]]++;
-                    removed_nodes[i] = 0;
+                    hist[weights[i]]++;
+                    unset_bit(removed_nodes.data(), i, true, __ATOMIC_RELAXED);
                 }
             }, get_num_threads());
 
+            thread_hists.for_each([&](const auto &hist) {
+                for (const auto &[count, num_kmers] : hist) {
+                    count_hist[count] += num_kmers;
+                }
+            });
+
             call_ones(removed_nodes, [&weights](auto i) { weights[i] = 0; });
 
         } else if (auto dbg_succ = std::dynamic_pointer_cast<graph::DBGSuccinct>(graph)) {
@@ -292,7 +334,8 @@ int clean_graph(Config *config) {
             assert(node_weights->is_compatible(*graph));
 
             graph::MaskedDeBruijnGraph graph_slice(graph,
-                [&](auto i) { return weights[i] >= min_count && weights[i] < max_count; },
+                graph::materialize_mask(*graph,
+                    [&](auto i) { return weights[i] >= min_count && weights[i] < max_count; }),
                 true,
                 graph->get_mode()
             );
@@ -177,6 +177,10 @@ Config::Config(int argc, char *argv[]) {
             parallel_each = atoi(get_value(i++));
         } else if (!strcmp(argv[i], "--max-path-length")) {
             max_path_length = atoi(get_value(i++));
+        } else if (!strcmp(argv[i], "--io-depth")) {
+            io_queue_depth = atoi(get_value(i++));
+        } else if (!strcmp(argv[i], "--io-mem-gb")) {
+            io_buffers_gb = atof(get_value(i++));
         } else if (!strcmp(argv[i], "--parts-total")) {
             parts_total = atoi(get_value(i++));
         } else if (!strcmp(argv[i], "--part-idx")) {
@@ -302,7 +306,15 @@ Config::Config(int argc, char *argv[]) {
             port = atoi(get_value(i++));
         } else if (!strcmp(argv[i], "--address")) {
             host_address = get_value(i++);
-        }else if (!strcmp(argv[i], "--suffix")) {
+        } else if (!strcmp(argv[i], "--numa")) {
+            numa_interleave = true;
+        } else if (!strcmp(argv[i], "--allow-reload")) {
+            allow_reload = true;
+        } else if (!strcmp(argv[i], "--batch-delay")) {
+            batch_delay_ms = atoi(get_value(i++));
+        } else if (!strcmp(argv[i], "--batch-max-bases")) {
+            batch_max_bases = atoll(get_value(i++));
+        } else if (!strcmp(argv[i], "--suffix")) {
             suffix = get_value(i++);
         } else if (!strcmp(argv[i], "--diff-assembly-rules")) {
             assembly_config_file = get_value(i++);
@@ -327,6 +339,7 @@ Config::Config(int argc, char *argv[]) {
             infbase_annotators.emplace_back(get_value(i++));
         } else if (!strcmp(argv[i], "-i") || !strcmp(argv[i], "--infile-base")) {
             infbase = std::string(get_value(i++));
+            infbase_graphs.push_back(infbase);
         } else if (!strcmp(argv[i], "--to-adj-list")) {
             to_adj_list = true;
         } else if (!strcmp(argv[i], "--to-fasta")) {
@@ -384,6 +397,8 @@ Config::Config(int argc, char *argv[]) {
             num_rows_subsampled = atoll(get_value(i++));
         } else if (!strcmp(argv[i], "--subsample-rows")) {
             subsample_rows = true;
+        } else if (!strcmp(argv[i], "--lsh-bands")) {
+            lsh_bands = atoi(get_value(i++));
         } else if (!strcmp(argv[i], "--linkage-file")) {
             linkage_file = get_value(i++);
         } else if (!strcmp(argv[i], "--arity")) {
@@ -573,9 +588,16 @@ Config::Config(int argc, char *argv[]) {
     if (identity == EXTEND && infbase.empty())
         print_usage_and_exit = true;
 
-    if ((identity == QUERY || identity == SERVER_QUERY) && infbase_annotators.size() != 1)
+    if (identity == QUERY && infbase_annotators.size() != 1)
         print_usage_and_exit = true;
 
+    // the server can serve multiple shards, each given by a pair of -i and -a
+    if (identity == SERVER_QUERY && (infbase_annotators.empty()
+                                        || infbase_annotators.size() != infbase_graphs.size())) {
+        std::cerr << "Error: pass a graph (-i) for each annotation (-a)" << std::endl;
+        print_usage_and_exit = true;
+    }
+
     if ((identity == TRANSFORM
             || identity == CLEAN
             || identity == ASSEMBLE
@@ -609,6 +631,7 @@ Config::Config(int argc, char *argv[]) {
                                     || anno_type == RowDiffRowSparse
                                     || anno_type == RowDiffDiskCoord
                                     || anno_type == RowDiffBRWTCoord
+                                    || anno_type == RowDiffBRWTCoordVByte
                                     || anno_type == RowDiffCoord;
         if (to_row_diff && !infbase.size()) {
             std::cerr << "Path to graph must be passed with '-i <GRAPH>'" << std::endl;
@@ -745,6 +768,10 @@ std::string Config::annotype_to_string(AnnotationType state) {
             return "row_diff_coord";
         case RowDiffBRWTCoord:
             return "row_diff_brwt_coord";
+        case BRWTCoordVByte:
+            return "brwt_coord_vbyte";
+        case RowDiffBRWTCoordVByte:
+            return "row_diff_brwt_coord_vbyte";
     }
     throw std::runtime_error("Never happens");
 }
@@ -792,6 +819,10 @@ Config::AnnotationType Config::string_to_annotype(const std::string &string) {
         return AnnotationType::RowDiffCoord;
     } else if (string == "row_diff_brwt_coord") {
         return AnnotationType::RowDiffBRWTCoord;
+    } else if (string == "brwt_coord_vbyte") {
+        return AnnotationType::BRWTCoordVByte;
+    } else if (string == "row_diff_brwt_coord_vbyte") {
+        return AnnotationType::RowDiffBRWTCoordVByte;
     } else {
         std::cerr << "Error: unknown annotation representation" << std::endl;
         exit(1);
@@ -892,6 +923,7 @@ QueryMode Config::string_to_querymode(const std::string &string) {
 void Config::print_usage(const std::string &prog_name, IdentityType identity) {
     const char annotation_list[] = "\t\t( column, brwt, rb_brwt, int_brwt,\n"
                                    "\t\t  column_coord, brwt_coord, row_diff_coord, row_diff_brwt_coord,\n"
+                                   "\t\t  brwt_coord_vbyte, row_diff_brwt_coord_vbyte,\n"
                                    "\t\t  row_diff, row_diff_brwt, row_diff_flat, row_diff_sparse, row_diff_int_brwt,\n"
                                    "\t\t  row_diff_disk, row_diff_int_disk, row_diff_disk_coord,\n"
                                    "\t\t  row, flat, row_sparse, rbfish, bin_rel_wt )";
@@ -1239,6 +1271,7 @@ if (advanced) {
             fprintf(stderr, "\t   --max-count [INT] \t\texclude k-mers appearing in more than this number of columns [inf]\n");
             fprintf(stderr, "\t   --max-fraction [FLOAT] \texclude k-mers appearing in more than this fraction of columns [1.0]\n");
             fprintf(stderr, "\t   --compute-overlap [STR] \tcompute the number of shared bits in columns of this annotation and ANNOTATOR [off]\n");
+            fprintf(stderr, "\t                          \t(the full matrix is also written to <OUTFBASE>.overlap.{tsv,bin})\n");
             fprintf(stderr, "\t   --rename-cols [STR] \tfile with rules for renaming annotation labels []\n");
             fprintf(stderr, "\t                       \texample: 'L_1 L_1_renamed\n");
             fprintf(stderr, "\t                       \t          L_2 L_2_renamed\n");
@@ -1255,11 +1288,14 @@ if (advanced) {
             fprintf(stderr, "\t                       \t          4 5 <dist> 6'\n");
             fprintf(stderr, "\t   --subsample [INT] \tnumber of bits subsampled for distance estimation in column clustering [1'000'000]\n");
             fprintf(stderr, "\t   --subsample-rows \tsubsample rows (the same positions in all columns) instead of only set bits [off]\n");
+            fprintf(stderr, "\t   --lsh-bands [INT] \tapproximate greedy clustering with MinHash LSH with this many bands (0: exact) [0]\n");
             fprintf(stderr, "\t   --dump-text-anno \tdump the columns of the annotator as separate text files [off]\n");
             fprintf(stderr, "\n");
             fprintf(stderr, "\t   --row-diff-stage [0|1|2] \tstage of the row_diff construction [0]\n");
             fprintf(stderr, "\t   --max-path-length [INT] \tmaximum path length in row_diff annotation [100]\n");
             fprintf(stderr, "\t   --mem-cap-gb [FLOAT]\tmemory in GB available for the transform [1000]\n");
+            fprintf(stderr, "\t   --io-depth [INT] \tnumber of blocks read ahead and written behind asynchronously in row_diff transform [2]\n");
+            fprintf(stderr, "\t   --io-mem-gb [FLOAT]\tmemory in GB available for the asynchronously read and written blocks [4]\n");
             fprintf(stderr, "\t-i --infile-base [STR] \t\tgraph for generating succ/pred/anchors (for row_diff types) []\n");
             fprintf(stderr, "\t   --count-kmers \t\tadd k-mer counts to the row_diff annotation [off]\n");
             fprintf(stderr, "\t   --coordinates \t\tadd k-mer coordinates to the row_diff annotation [off]\n");
@@ -1288,6 +1324,7 @@ if (advanced) {
             fprintf(stderr, "\t   --align \t\talign sequences instead of mapping k-mers [off]\n");
 if (advanced) {
             fprintf(stderr, "\t   --sparse \t\tuse row-major sparse matrix for row annotation [off]\n");
+            fprintf(stderr, "\t   --numa \t\tinterleave the index across NUMA nodes and spread the threads over them [off]\n");
 }
             fprintf(stderr, "\t   --json \t\toutput query results in JSON format [off]\n");
             fprintf(stderr, "\n");
@@ -1365,12 +1402,19 @@ if (advanced) {
 }
         } break;
         case SERVER_QUERY: {
-            fprintf(stderr, "Usage: %s server_query -i <GRAPH> -a <ANNOTATION> [options]\n\n", prog_name.c_str());
+            fprintf(stderr, "Usage: %s server_query -i <GRAPH> -a <ANNOTATION> [-i <GRAPH> -a <ANNOTATION> ...] [options]\n"
+                            "\tMultiple pairs of graph and annotation are served as shards of one index.\n"
+                            "\tEach query is run on all shards in parallel and their top labels are merged.\n\n", prog_name.c_str());
 
             fprintf(stderr, "Available options for server_query:\n");
             fprintf(stderr, "\t   --port [INT] \tTCP port for incoming connections [5555]\n");
             fprintf(stderr, "\t   --address \t\tinterface for incoming connections (default: all)\n");
             fprintf(stderr, "\t   --sparse \t\tuse the row-major sparse matrix to annotate graph [off]\n");
+            fprintf(stderr, "\t   --numa \t\tinterleave the index across NUMA nodes and spread the threads over them [off]\n");
+            fprintf(stderr, "\t   --mmap \t\tmap the index files into memory, sharing the page cache between processes [off]\n");
+            fprintf(stderr, "\t   --allow-reload \tenable POST /reload to swap in a new index without downtime [off]\n");
+            fprintf(stderr, "\t   --batch-delay [INT] \tbatch the search requests arriving within this time (in ms) and query them together [0: off]\n");
+            fprintf(stderr, "\t   --batch-max-bases [INT] \tmax number of bases in a batch of search requests [1000000]\n");
             // fprintf(stderr, "\t-o --outfile-base [STR] \tbasename of output file []\n");
             // fprintf(stderr, "\t-d --distance [INT] \tmax allowed alignment distance [0]\n");
             fprintf(stderr, "\t-p --parallel [INT] \tmaximum number of parallel connections [1]\n");
@@ -62,6 +62,8 @@ class Config {
     bool aggregate_columns = false;
     bool coordinates = false;
     bool advanced = false;
+    bool numa_interleave = false;
+    bool allow_reload = false;
 
     unsigned int k = 3;
 
@@ -80,6 +82,7 @@ class Config {
     unsigned int frequency = 1;
     unsigned int alignment_length = 0;
     double memory_available = 1;
+    double io_buffers_gb = 4;
     unsigned int min_count = 1;
     unsigned int max_count = std::numeric_limits<unsigned int>::max();
     unsigned int min_value = 1;
@@ -88,20 +91,24 @@ class Config {
     unsigned int genome_binsize_anno = 1000;
     unsigned int arity_brwt = 2;
     unsigned int relax_arity_brwt = 10;
+    unsigned int lsh_bands = 0;  // exact greedy clustering by default
     unsigned long long RA_ivbuffer_size = 16'384; // in B
     unsigned int min_tip_size = 1;
     unsigned int min_unitig_median_kmer_abundance = 1;
     int fallback_abundance_cutoff = 1;
     unsigned int port = 5555;
+    unsigned int batch_delay_ms = 0;
     unsigned int bloom_max_num_hash_functions = 10;
     unsigned int num_columns_cached = 10;
     unsigned int max_hull_forks = 4;
     unsigned int row_diff_stage = 0;
     unsigned int max_path_length = 100;
+    unsigned int io_queue_depth = 2;
     unsigned int smoothing_window = 1;  // no smoothing by default
     unsigned int num_kmers_in_seq = 0;  // assume all input reads have this length
 
     unsigned long long int query_batch_size = 100'000'000;
+    unsigned long long int batch_max_bases = 1'000'000;
     unsigned long long int num_rows_subsampled = 1'000'000;
     unsigned long long int num_singleton_kmers = 0;
     unsigned long long int max_hull_depth = -1;  // the default is a function of input
@@ -149,6 +156,7 @@ class Config {
     std::vector<std::string> fnames;
     std::vector<std::string> anno_labels;
     std::vector<std::string> infbase_annotators;
+    std::vector<std::string> infbase_graphs;
     std::string outfbase;
     std::string infbase;
     std::string rename_instructions_file;
@@ -215,6 +223,8 @@ class Config {
         RowDiffCoord,
         RowDiffBRWTCoord,
         RowDiffDiskCoord,
+        BRWTCoordVByte,
+        RowDiffBRWTCoordVByte,
     };
 
     enum GraphType {
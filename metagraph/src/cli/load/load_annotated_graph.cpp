@@ -1,5 +1,8 @@
 #include "load_annotated_graph.hpp"
 
+#include <filesystem>
+#include <stdexcept>
+
 #include "annotation/binary_matrix/multi_brwt/brwt.hpp"
 #include "annotation/binary_matrix/column_sparse/column_major.hpp"
 #include "annotation/binary_matrix/row_diff/row_diff.hpp"
@@ -20,9 +23,20 @@ using namespace mtg::graph;
 using mtg::common::logger;
 
 
-std::unique_ptr<AnnotatedDBG> initialize_annotated_dbg(std::shared_ptr<DeBruijnGraph> graph,
-                                                       const Config &config,
-                                                       size_t max_chunks_open) {
+// Log the error and exit if |critical|, otherwise throw it
+[[noreturn]] static void fail(bool critical, const std::string &message) {
+    if (!critical)
+        throw std::runtime_error(message);
+
+    logger->error("{}", message);
+    exit(1);
+}
+
+static std::unique_ptr<AnnotatedDBG>
+init_annotated_dbg(std::shared_ptr<DeBruijnGraph> graph,
+                   const Config &config,
+                   size_t max_chunks_open,
+                   bool critical) {
     uint64_t max_index = graph->max_index();
     const auto *dbg_graph = dynamic_cast<const DBGSuccinct*>(graph.get());
 
@@ -46,25 +60,29 @@ std::unique_ptr<AnnotatedDBG> initialize_annotated_dbg(std::shared_ptr<DeBruijnG
             }
             loaded = annotation_temp->load(config.infbase_annotators.at(0));
         }
-        if (!loaded) {
-            logger->error("Cannot load annotations for graph {}, file corrupted",
-                          config.infbase);
-            exit(1);
-        }
+        if (!loaded)
+            fail(critical, "Cannot load annotations for graph " + config.infbase
+                                + ", file corrupted");
 
         // row_diff annotation is special, as it must know the graph structure
         using namespace annot::matrix;
         BinaryMatrix &matrix = const_cast<BinaryMatrix &>(annotation_temp->get_matrix());
         if (IRowDiff *row_diff = dynamic_cast<IRowDiff*>(&matrix)) {
             if (!dbg_graph) {
-                logger->error("Only succinct de Bruijn graph representations"
-                              " are supported for row-diff annotations");
-                std::exit(1);
+                fail(critical, "Only succinct de Bruijn graph representations"
+                               " are supported for row-diff annotations");
             }
 
             row_diff->set_graph(dbg_graph);
 
             if (auto *row_diff_column = dynamic_cast<RowDiff<ColumnMajor> *>(&matrix)) {
+                // the loaders below terminate the process if the files are missing
+                for (const auto &ext : { kRowDiffAnchorExt, kRowDiffForkSuccExt }) {
+                    if (!critical && !std::filesystem::exists(config.infbase + ext)) {
+                        throw std::runtime_error("Missing file " + config.infbase + ext
+                                                    + " required by the row-diff annotation");
+                    }
+                }
                 row_diff_column->load_anchor(config.infbase + kRowDiffAnchorExt);
                 row_diff_column->load_fork_succ(config.infbase + kRowDiffForkSuccExt);
             }
@@ -75,14 +93,24 @@ std::unique_ptr<AnnotatedDBG> initialize_annotated_dbg(std::shared_ptr<DeBruijnG
     auto anno_graph
             = std::make_unique<AnnotatedDBG>(std::move(graph), std::move(annotation_temp));
 
-    if (!anno_graph->check_compatibility()) {
-        logger->error("Graph and annotation are not compatible");
-        exit(1);
-    }
+    if (!anno_graph->check_compatibility())
+        fail(critical, "Graph and annotation are not compatible");
 
     return anno_graph;
 }
 
+std::unique_ptr<AnnotatedDBG> initialize_annotated_dbg(std::shared_ptr<DeBruijnGraph> graph,
+                                                       const Config &config,
+                                                       size_t max_chunks_open) {
+    return init_annotated_dbg(graph, config, max_chunks_open, true);
+}
+
+std::unique_ptr<AnnotatedDBG> load_annotated_dbg(std::shared_ptr<DeBruijnGraph> graph,
+                                                 const Config &config,
+                                                 size_t max_chunks_open) {
+    return init_annotated_dbg(graph, config, max_chunks_open, false);
+}
+
 std::unique_ptr<AnnotatedDBG> initialize_annotated_dbg(const Config &config) {
     return initialize_annotated_dbg(load_critical_dbg(config.infbase), config);
 }
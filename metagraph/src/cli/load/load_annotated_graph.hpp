@@ -22,6 +22,14 @@ initialize_annotated_dbg(std::shared_ptr<graph::DeBruijnGraph> graph,
                          const Config &config,
                          size_t max_chunks_open = 2000);
 
+// Same as initialize_annotated_dbg, but throws std::runtime_error instead of
+// terminating the process if the annotation cannot be loaded or doesn't match
+// the graph (e.g., for reloading the index served by a running server).
+std::unique_ptr<graph::AnnotatedDBG>
+load_annotated_dbg(std::shared_ptr<graph::DeBruijnGraph> graph,
+                   const Config &config,
+                   size_t max_chunks_open = 2000);
+
 std::unique_ptr<graph::AnnotatedDBG> initialize_annotated_dbg(const Config &config);
 
 } // namespace cli
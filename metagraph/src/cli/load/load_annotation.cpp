@@ -33,6 +33,12 @@ Config::AnnotationType parse_annotation_type(const std::string &filename) {
     } else if (utils::ends_with(filename, annot::RowDiffBRWTCoordAnnotator::kExtension)) {
         return Config::AnnotationType::RowDiffBRWTCoord;
 
+    } else if (utils::ends_with(filename, annot::MultiBRWTCoordVByteAnnotator::kExtension)) {
+        return Config::AnnotationType::BRWTCoordVByte;
+
+    } else if (utils::ends_with(filename, annot::RowDiffBRWTCoordVByteAnnotator::kExtension)) {
+        return Config::AnnotationType::RowDiffBRWTCoordVByte;
+
     } else if (utils::ends_with(filename, annot::RowDiffColumnAnnotator::kExtension)) {
         return Config::AnnotationType::RowDiff;
 
@@ -188,6 +194,14 @@ initialize_annotation(Config::AnnotationType anno_type,
             annotation.reset(new annot::RowDiffBRWTCoordAnnotator());
             break;
         }
+        case Config::BRWTCoordVByte: {
+            annotation.reset(new annot::MultiBRWTCoordVByteAnnotator());
+            break;
+        }
+        case Config::RowDiffBRWTCoordVByte: {
+            annotation.reset(new annot::RowDiffBRWTCoordVByteAnnotator());
+            break;
+        }
     }
 
     return annotation;
@@ -41,34 +41,46 @@ Config::GraphType parse_graph_type(const std::string &filename) {
     }
 }
 
-std::shared_ptr<DeBruijnGraph> load_critical_dbg(const std::string &filename) {
-    auto graph_type = parse_graph_type(filename);
-    switch (graph_type) {
+std::shared_ptr<DeBruijnGraph> load_dbg(const std::string &filename) {
+    switch (parse_graph_type(filename)) {
         case Config::GraphType::SUCCINCT:
-            return load_critical_graph_from_file<DBGSuccinct>(filename);
+            return load_graph_from_file<DBGSuccinct>(filename);
 
         case Config::GraphType::HASH:
-            return load_critical_graph_from_file<DBGHashOrdered>(filename);
+            return load_graph_from_file<DBGHashOrdered>(filename);
 
         case Config::GraphType::HASH_PACKED:
-            return load_critical_graph_from_file<DBGHashOrdered>(filename);
+            return load_graph_from_file<DBGHashOrdered>(filename);
 
         case Config::GraphType::HASH_STR:
-            return load_critical_graph_from_file<DBGHashString>(filename);
+            return load_graph_from_file<DBGHashString>(filename);
 
         case Config::GraphType::HASH_FAST:
-            return load_critical_graph_from_file<DBGHashFast>(filename);
+            return load_graph_from_file<DBGHashFast>(filename);
 
         case Config::GraphType::BITMAP:
-            return load_critical_graph_from_file<graph::DBGBitmap>(filename);
+            return load_graph_from_file<graph::DBGBitmap>(filename);
 
         case Config::GraphType::INVALID:
-            logger->error("Cannot load graph from file '{}', needs a valid file extension",
-                          filename);
-            exit(1);
+            return nullptr;
     }
     assert(false);
-    exit(1);
+    return nullptr;
+}
+
+std::shared_ptr<DeBruijnGraph> load_critical_dbg(const std::string &filename) {
+    if (parse_graph_type(filename) == Config::GraphType::INVALID) {
+        logger->error("Cannot load graph from file '{}', needs a valid file extension",
+                      filename);
+        exit(1);
+    }
+
+    auto graph = load_dbg(filename);
+    if (!graph) {
+        logger->error("Cannot load graph from file '{}'", filename);
+        exit(1);
+    }
+    return graph;
 }
 
 } // namespace cli
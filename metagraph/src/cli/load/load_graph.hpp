@@ -14,15 +14,27 @@ namespace cli {
 Config::GraphType parse_graph_type(const std::string &filename);
 
 template <class Graph>
-std::shared_ptr<Graph> load_critical_graph_from_file(const std::string &filename) {
+std::shared_ptr<Graph> load_graph_from_file(const std::string &filename) {
     auto graph = std::make_shared<Graph>(2);
-    if (!graph->load(filename)) {
+    if (!graph->load(filename))
+        return nullptr;
+
+    return graph;
+}
+
+template <class Graph>
+std::shared_ptr<Graph> load_critical_graph_from_file(const std::string &filename) {
+    auto graph = load_graph_from_file<Graph>(filename);
+    if (!graph) {
         common::logger->error("Cannot load graph from file '{}'", filename);
         exit(1);
     }
     return graph;
 }
 
+// Return nullptr if the graph cannot be loaded
+std::shared_ptr<graph::DeBruijnGraph> load_dbg(const std::string &filename);
+
 std::shared_ptr<graph::DeBruijnGraph> load_critical_dbg(const std::string &filename);
 
 } // namespace cli
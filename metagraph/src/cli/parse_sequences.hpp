@@ -54,6 +54,93 @@ void parse_sequences_and_log(const std::string &file,
 }
 
 
+// Get the k-mer count thresholds for a KMC database, computing the quantiles
+// of the count histogram if they are requested.
+inline std::pair<uint64_t, uint64_t>
+get_kmc_count_thresholds(const std::string &file, const Config &config) {
+    uint64_t min_count = config.min_count;
+    uint64_t max_count = config.max_count;
+
+    // compute the quantiles to update the thresholds
+    if (config.min_count_quantile > 0 || config.max_count_quantile < 1) {
+        tsl::hopscotch_map<uint64_t, uint64_t> count_hist;
+        read_kmers(file, [&](auto, uint32_t count) { count_hist[count]++; }, false);
+
+        if (count_hist.size()) {
+            std::vector<std::pair<uint64_t, uint64_t>> count_hist_v(count_hist.begin(),
+                                                                    count_hist.end());
+
+            ips4o::parallel::sort(count_hist_v.begin(), count_hist_v.end(),
+                                  utils::LessFirst(), get_num_threads());
+
+            if (config.min_count_quantile > 0)
+                min_count = utils::get_quantile(count_hist_v, config.min_count_quantile);
+            if (config.max_count_quantile < 1)
+                max_count = utils::get_quantile(count_hist_v, config.max_count_quantile);
+
+            mtg::common::logger->info("Used k-mer count thresholds:\n"
+                                     "min (including): {}\n"
+                                     "max (excluding): {}", min_count, max_count);
+        }
+    }
+
+    return { min_count, max_count };
+}
+
+/**
+ * Read k-mers from a KMC database in batches of nucleotide codes, without
+ * decoding them into strings (see seq_io::read_kmer_batches).
+ * The batches are passed to |call_kmers| as (k, codes, counts).
+ */
+template <class Callback>
+void parse_kmc_kmers(const std::string &file,
+                     const Config &config,
+                     Callback call_kmers) {
+    mtg::common::logger->trace("Parsing {}", file);
+
+    if (config.graph_mode == graph::DeBruijnGraph::PRIMARY) {
+        mtg::common::logger->error("Primary graphs can only be constructed from"
+                                   " primary contigs");
+        exit(1);
+    }
+
+    uint64_t num_kmers = 0;
+    Timer timer;
+
+    auto [min_count, max_count] = get_kmc_count_thresholds(file, config);
+
+    read_kmer_batches(
+        file,
+        [&](size_t k, std::vector<uint8_t>&& codes, std::vector<uint64_t>&& counts) {
+            if (!num_kmers && k != config.k) {
+                mtg::common::logger->warn("k-mers parsed from KMC database {} have "
+                                         "length {} but graph is constructed for k={}",
+                                         file, k, config.k);
+            }
+            if (config.forward_and_reverse) {
+                size_t size = counts.size();
+                codes.resize(2 * size * k);
+                counts.resize(2 * size);
+                for (size_t i = 0; i < size; ++i) {
+                    for (size_t j = 0; j < k; ++j) {
+                        codes[(size + i) * k + j] = 3 - codes[i * k + k - 1 - j];
+                    }
+                    counts[size + i] = counts[i];
+                }
+            }
+            num_kmers += counts.size();
+            call_kmers(k, std::move(codes), std::move(counts));
+        },
+        // For canonical graph the rev-compl k-mers will be added automatically anyway.
+        // Also, if forward_and_reverse = true, the rev-compl will be computed in the callback.
+        config.graph_mode != graph::DeBruijnGraph::CANONICAL && !config.forward_and_reverse,
+        min_count, max_count
+    );
+
+    mtg::common::logger->trace("Extracted all k-mers (total of {}) from KMC database {} in {} sec",
+                               num_kmers, file, timer.elapsed());
+}
+
 template <class Callback>
 void parse_sequences(const std::string &file,
                      const Config &config,
@@ -76,31 +163,7 @@ void parse_sequences(const std::string &file,
     } else if (file_format(file) == "KMC") {
         bool warning_different_k = false;
 
-        auto min_count = config.min_count;
-        auto max_count = config.max_count;
-
-        // compute the quantiles to update the thresholds
-        if (config.min_count_quantile > 0 || config.max_count_quantile < 1) {
-            tsl::hopscotch_map<uint64_t, uint64_t> count_hist;
-            read_kmers(file, [&](auto, uint32_t count) { count_hist[count]++; }, false);
-
-            if (count_hist.size()) {
-                std::vector<std::pair<uint64_t, uint64_t>> count_hist_v(count_hist.begin(),
-                                                                        count_hist.end());
-
-                ips4o::parallel::sort(count_hist_v.begin(), count_hist_v.end(),
-                                      utils::LessFirst(), get_num_threads());
-
-                if (config.min_count_quantile > 0)
-                    min_count = utils::get_quantile(count_hist_v, config.min_count_quantile);
-                if (config.max_count_quantile < 1)
-                    max_count = utils::get_quantile(count_hist_v, config.max_count_quantile);
-
-                mtg::common::logger->info("Used k-mer count thresholds:\n"
-                                         "min (including): {}\n"
-                                         "max (excluding): {}", min_count, max_count);
-            }
-        }
+        auto [min_count, max_count] = get_kmc_count_thresholds(file, config);
 
         read_kmers(
             file,
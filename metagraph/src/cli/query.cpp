@@ -10,10 +10,12 @@
 #include "common/hashers/hash.hpp"
 #include "common/utils/template_utils.hpp"
 #include "common/threads/threading.hpp"
+#include "common/threads/numa.hpp"
 #include "common/vectors/vector_algorithm.hpp"
 #include "annotation/representation/annotation_matrix/static_annotators_def.hpp"
 #include "graph/alignment/dbg_aligner.hpp"
 #include "graph/representation/hash/dbg_hash_ordered.hpp"
+#include "graph/representation/sorted/dbg_sorted.hpp"
 #include "graph/representation/succinct/dbg_succinct.hpp"
 #include "graph/representation/succinct/boss_construct.hpp"
 #include "graph/graph_extensions/node_rc.hpp"
@@ -843,12 +845,14 @@ void add_to_graph(Graph &graph, const Contigs &contigs, size_t k) {
  *
  *  Algorithm.
  *
- * 1. Index k-mers from the query sequences in a non-canonical query de Bruijn
+ * 1. Index k-mers from the query sequences in a non-canonical batch de Bruijn
  *    graph (with pre-filtering by a Bloom filter, if initialized).
+ *    The batch graph stores the k-mers in a sorted array, which is constructed
+ *    in parallel and takes a single word per k-mer.
  *    This query graph will be rebuilt as a canonical one in step 2.b), if the
  *    full graph is canonical.
  *
- * 2. Extract contigs from this small de Bruijn graph and map them to the full
+ * 2. Extract unitigs from this small de Bruijn graph and map them to the full
  *    graph to map each k-mer to its respective annotation row index.
  *    --> here we map each unique k-mer in sequences only once.
  *
@@ -899,33 +903,31 @@ construct_query_graph(const AnnotatedDBG &anno_graph,
     Timer timer;
 
     // construct graph storing all k-mers in query
-    auto graph_init = std::make_shared<DBGHashOrdered>(full_dbg.get_k());
+    auto graph_init = std::make_shared<DBGSorted>(full_dbg.get_k(), num_threads);
     size_t max_input_sequence_length = 0;
 
     logger->trace("[Query graph construction] Building the batch graph...");
 
+    DBGSorted::GetSkipper get_skipper;
+
     if (kPrefilterWithBloom && dbg_succ && sub_k == full_dbg.get_k()) {
         if (dbg_succ->get_bloom_filter())
             logger->trace(
                     "[Query graph construction] Started indexing k-mers pre-filtered "
                     "with Bloom filter");
 
+        get_skipper = [&](std::string_view sequence) {
+            return get_missing_kmer_skipper(dbg_succ->get_bloom_filter(), sequence);
+        };
+    }
+
+    graph_init->add_sequences([&](const auto &callback) {
         call_sequences([&](const std::string &sequence) {
-            // TODO: implement add_sequence with filter for all graph representations
-            graph_init->add_sequence(
-                sequence,
-                get_missing_kmer_skipper(dbg_succ->get_bloom_filter(), sequence)
-            );
-            if (max_input_sequence_length < sequence.length())
-                max_input_sequence_length = sequence.length();
-        });
-    } else {
-        call_sequences([&](const std::string &sequence) {
-            graph_init->add_sequence(sequence);
+            callback(sequence);
             if (max_input_sequence_length < sequence.length())
                 max_input_sequence_length = sequence.length();
         });
-    }
+    }, get_skipper);
 
     max_hull_depth = std::min(
         max_hull_depth,
@@ -986,9 +988,11 @@ construct_query_graph(const AnnotatedDBG &anno_graph,
         timer.reset();
 
         // add k-mers with sub_k-suffix matches
-        for (size_t i = original_size; i < contigs.size(); ++i) {
-            graph_init->add_sequence(contigs[i].first);
-        }
+        graph_init->add_sequences([&](const auto &callback) {
+            for (size_t i = original_size; i < contigs.size(); ++i) {
+                callback(contigs[i].first);
+            }
+        });
 
         size_t hull_contigs_begin = contigs.size();
 
@@ -1089,6 +1093,10 @@ int query_graph(Config *config) {
 
     assert(config->infbase_annotators.size() == 1);
 
+    // interleave the index across NUMA nodes while loading it
+    std::optional<common::NumaInterleaveScope> numa_interleave;
+    numa_interleave.emplace(config->numa_interleave);
+
     std::shared_ptr<DeBruijnGraph> graph = load_critical_dbg(config->infbase);
 
     if (auto dbg_succ = std::dynamic_pointer_cast<DBGSuccinct>(graph)) {
@@ -1107,6 +1115,8 @@ int query_graph(Config *config) {
 
     std::unique_ptr<AnnotatedDBG> anno_graph = initialize_annotated_dbg(graph, *config);
 
+    numa_interleave.reset();
+
     ThreadPool thread_pool(std::max(1u, get_num_threads()) - 1, 1000);
 
     std::unique_ptr<align::DBGAlignerConfig> aligner_config;
@@ -1262,6 +1272,9 @@ size_t QueryExecutor::query_fasta(const string &file,
 
     for (const seq_io::kseq_t &kseq : fasta_parser) {
         thread_pool_.enqueue([&](QuerySequence &sequence) {
+            if (config_.numa_interleave)
+                common::pin_thread_to_next_numa_node();
+
             // Callback with the SeqSearchResult
             callback(query_sequence(std::move(sequence), anno_graph_,
                                     config_, aligner_config_.get()));
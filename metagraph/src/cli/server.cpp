@@ -1,8 +1,15 @@
+#include <atomic>
+#include <condition_variable>
+#include <filesystem>
+#include <future>
+#include <unordered_map>
+
 #include <json/json.h>
 #include <server_http.hpp>
 
 #include "common/logger.hpp"
 #include "common/unix_tools.hpp"
+#include "common/threads/numa.hpp"
 #include "common/utils/string_utils.hpp"
 #include "common/utils/file_utils.hpp"
 #include "common/utils/template_utils.hpp"
@@ -26,10 +33,516 @@ using namespace mtg::graph;
 
 using HttpServer = SimpleWeb::Server<SimpleWeb::HTTP>;
 
+// An index (or a shard of an index) served by the server
+struct ServedIndex {
+    std::unique_ptr<AnnotatedDBG> anno_graph;
+    std::string graph_filename;
+    std::string annotation_filename;
+    // increases with every index loaded
+    uint64_t version;
+};
+
+typedef std::vector<std::shared_ptr<const ServedIndex>> Shards;
+
+// Changes whenever any of the shards is reloaded, as the shard loaded last
+// has the highest version.
+uint64_t get_index_version(const Shards &shards) {
+    uint64_t version = 0;
+    for (const auto &shard : shards) {
+        version = std::max(version, shard->version);
+    }
+    return version;
+}
+
+
+// Run |query| for each shard, the first one in the caller thread and the others
+// in |shard_pool|, and return the results in the order of the shards.
+template <class Query>
+auto query_shards(size_t num_shards, const Query &query, ThreadPool &shard_pool) {
+    std::vector<decltype(query(0))> results(num_shards);
+    // the tasks in the pool must not throw, so their exceptions are passed here
+    std::vector<std::exception_ptr> errors(num_shards);
+    auto query_shard = [&](size_t s) {
+        try {
+            results[s] = query(s);
+        } catch (...) {
+            errors[s] = std::current_exception();
+        }
+    };
+
+    std::vector<std::shared_future<void>> shards_done;
+    for (size_t s = 1; s < num_shards; ++s) {
+        shards_done.push_back(shard_pool.enqueue(query_shard, s));
+    }
+    if (num_shards)
+        query_shard(0);
+
+    for (auto &done : shards_done) {
+        done.wait();
+    }
+    for (const auto &error : errors) {
+        if (error)
+            std::rethrow_exception(error);
+    }
+    return results;
+}
+
+// Merge the results of the same query sequences returned from different shards.
+// The entries in |field| are merged and the |max_num_entries| of them with
+// the highest |key| are kept. The remaining fields (e.g., the alignment of
+// the query sequence) are taken from the shard with the highest score.
+Json::Value merge_shard_results(std::vector<Json::Value>&& shard_results,
+                                const char *field,
+                                const char *key,
+                                size_t max_num_entries) {
+    assert(shard_results.size());
+    if (shard_results.size() == 1)
+        return std::move(shard_results[0]);
+
+    auto get_score = [](const Json::Value &value, const char *name) {
+        return value.get(name, 0).asDouble();
+    };
+
+    for (const Json::Value &results : shard_results) {
+        if (results.size() != shard_results[0].size())
+            throw std::runtime_error("Shards returned results for different queries");
+    }
+
+    Json::Value merged(Json::arrayValue);
+    for (Json::ArrayIndex i = 0; i < shard_results[0].size(); ++i) {
+        size_t best = 0;
+        std::vector<Json::Value> entries;
+        for (size_t s = 0; s < shard_results.size(); ++s) {
+            Json::Value &result = shard_results[s][i];
+            if (get_score(result, SeqSearchResult::SCORE_JSON_FIELD)
+                    > get_score(shard_results[best][i], SeqSearchResult::SCORE_JSON_FIELD))
+                best = s;
+
+            for (Json::Value &entry : result[field]) {
+                entries.push_back(std::move(entry));
+            }
+        }
+
+        std::stable_sort(entries.begin(), entries.end(),
+                         [&](const Json::Value &a, const Json::Value &b) {
+                             return get_score(a, key) > get_score(b, key);
+                         });
+        if (entries.size() > max_num_entries)
+            entries.resize(max_num_entries);
+
+        Json::Value &result = merged.append(std::move(shard_results[best][i]));
+        Json::Value &merged_entries = (result[field] = Json::arrayValue);
+        for (Json::Value &entry : entries) {
+            merged_entries.append(std::move(entry));
+        }
+    }
+
+    return merged;
+}
+
+// Results of a search on all shards
+struct SearchResults {
+    // the shards queried
+    Shards shards;
+    // results from each shard, in the order of the query sequences
+    std::vector<std::vector<SeqSearchResult>> shard_results;
+};
+
+// Results for the query sequences [begin, end) of a search request
+struct RequestResults {
+    std::shared_ptr<const SearchResults> results;
+    size_t begin;
+    size_t end;
+};
+
+/**
+ * Coalesces concurrent search requests into batches queried at once, so that
+ * their sequences share a single batch query graph. The first request of a
+ * batch waits for the others for up to |max_delay_ms| milliseconds or until
+ * the batch has |max_num_bases| bases, queries the whole batch, and passes
+ * to each request the results for its own sequences.
+ */
+class SearchBatcher {
+  public:
+    typedef std::function<SearchResults(const std::string &fasta_file)> Search;
+
+    // The server serves more requests at once than it has threads, as the
+    // requests waiting for their batch block their threads. At most
+    // |max_num_running| batches are queried at the same time.
+    SearchBatcher(size_t max_delay_ms, size_t max_num_bases, const Config &config,
+                  size_t max_num_running = get_num_threads())
+          : max_delay_(max_delay_ms), max_num_bases_(max_num_bases),
+            tmp_dir_(config.tmp_dir), forward_and_reverse_(config.forward_and_reverse),
+            max_num_running_(std::max(max_num_running, size_t(1))) {}
+
+    /**
+     * Search the sequences in |fasta| batched with the other requests
+     * with the same |params|.
+     *
+     * @param fasta       query sequences in FASTA format
+     * @param params      parameters of the search
+     * @param run_search  queries the sequences in a FASTA file, called once per batch
+     * @return results of the batch with the positions of the sequences from |fasta|
+     */
+    RequestResults search(const std::string &fasta, const std::string &params,
+                          const Search &run_search) {
+        // Write the parsed records back instead of pasting the raw text, so that
+        // malformed input (e.g., lines before the first header) can't merge with
+        // the records of the other requests in the batch. Only the names and the
+        // sequences are used by the query, so FASTQ records are written as FASTA.
+        std::string records;
+        size_t num_sequences = 0;
+        size_t num_bases = 0;
+        seq_io::read_fasta_from_string(fasta, [&](seq_io::kseq_t *read_stream) {
+            records += '>';
+            records.append(read_stream->name.s, read_stream->name.l);
+            records += '\n';
+            records.append(read_stream->seq.s, read_stream->seq.l);
+            records += '\n';
+            num_sequences++;
+            num_bases += read_stream->seq.l;
+        });
+
+        // the query adds the reverse complements of the sequences
+        if (forward_and_reverse_) {
+            num_sequences *= 2;
+            num_bases *= 2;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+
+        std::shared_ptr<Batch> &open_batch = open_batches_[params];
+        const bool first = !open_batch;
+        if (first)
+            open_batch = std::make_shared<Batch>();
+
+        std::shared_ptr<Batch> batch = open_batch;
+        const size_t offset = batch->num_sequences;
+        batch->fasta += records;
+        batch->num_sequences += num_sequences;
+        batch->num_bases += num_bases;
+
+        if (batch->num_bases >= max_num_bases_) {
+            open_batches_.erase(params);
+            batch->full.notify_one();
+        }
+
+        if (first) {
+            batch->full.wait_for(lock, max_delay_, [&]() {
+                return batch->num_bases >= max_num_bases_;
+            });
+            // wait for a running batch to finish, the batch keeps collecting requests
+            slot_freed_.wait(lock, [&]() { return num_running_ < max_num_running_; });
+            ++num_running_;
+
+            // close the batch for new requests
+            auto it = open_batches_.find(params);
+            if (it != open_batches_.end() && it->second == batch)
+                open_batches_.erase(it);
+
+            lock.unlock();
+
+            try {
+                utils::TempFile tf(tmp_dir_);
+                tf.ofstream() << batch->fasta;
+                tf.ofstream().close();
+
+                logger->trace("[Server] Querying a batch of {} sequences with {} bases",
+                              batch->num_sequences, batch->num_bases);
+
+                auto results = std::make_shared<SearchResults>(run_search(tf.name()));
+                for (const auto &shard_results : results->shard_results) {
+                    if (shard_results.size() != batch->num_sequences)
+                        throw std::runtime_error("Unexpected number of results in batch");
+                }
+
+                batch->results.set_value(std::move(results));
+            } catch (...) {
+                batch->results.set_exception(std::current_exception());
+            }
+
+            lock.lock();
+            --num_running_;
+            lock.unlock();
+            slot_freed_.notify_one();
+        } else {
+            lock.unlock();
+        }
+
+        // rethrows the error (if any) to all requests in the batch
+        return RequestResults { batch->future.get(), offset, offset + num_sequences };
+    }
+
+  private:
+    struct Batch {
+        std::string fasta;
+        size_t num_sequences = 0;
+        size_t num_bases = 0;
+        std::condition_variable full;
+        std::promise<std::shared_ptr<const SearchResults>> results;
+        std::shared_future<std::shared_ptr<const SearchResults>> future
+                = results.get_future().share();
+    };
+
+    const std::chrono::milliseconds max_delay_;
+    const size_t max_num_bases_;
+    const std::string tmp_dir_;
+    const bool forward_and_reverse_;
+    const size_t max_num_running_;
+
+    std::mutex mutex_;
+    // batches still accepting requests, one per set of search parameters
+    std::unordered_map<std::string, std::shared_ptr<Batch>> open_batches_;
+    // batches being queried
+    size_t num_running_ = 0;
+    std::condition_variable slot_freed_;
+};
+
+// Query the sequences in |fasta_file| on all shards
+SearchResults search_shards(const std::string &fasta_file,
+                            const Shards &shards,
+                            const Config &config,
+                            ThreadPool &shard_pool) {
+    auto shard_results = query_shards(shards.size(), [&](size_t s) {
+        const graph::AnnotatedDBG &anno_graph = *shards[s]->anno_graph;
+
+        std::unique_ptr<align::DBGAlignerConfig> aligner_config;
+        if (config.align_sequences) {
+            aligner_config.reset(new align::DBGAlignerConfig(
+                initialize_aligner_config(config, anno_graph.get_graph())
+            ));
+        }
+
+        // Need mutex while appending to vector
+        std::vector<SeqSearchResult> search_results;
+        std::mutex result_mutex;
+
+        // dummy pool doing everything in the caller thread
+        ThreadPool dummy_pool(0);
+        QueryExecutor engine(config, anno_graph, std::move(aligner_config), dummy_pool);
+
+        // Query sequences and callback by appending result to vector with mutex for thread safety
+        engine.query_fasta(fasta_file,
+            [&](const SeqSearchResult &result) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                search_results.emplace_back(std::move(result));
+            }
+        );
+
+        // Ensure results are sorted by their ID
+        std::sort(search_results.begin(), search_results.end(),
+                  [](const SeqSearchResult &lhs, const SeqSearchResult &rhs) {
+                      return lhs.get_sequence().id < rhs.get_sequence().id;
+                  });
+
+        return search_results;
+    }, shard_pool);
+
+    return SearchResults { shards, std::move(shard_results) };
+}
+
+Json::Value search_results_to_json(const RequestResults &request, const Config &config) {
+    const SearchResults &results = *request.results;
+
+    std::vector<Json::Value> shard_responses;
+    for (size_t s = 0; s < results.shards.size(); ++s) {
+        const graph::AnnotatedDBG &anno_graph = *results.shards[s]->anno_graph;
+
+        // Create full JSON object
+        Json::Value search_response(Json::arrayValue);
+        for (size_t i = request.begin; i < request.end; ++i) {
+            search_response.append(results.shard_results[s][i].to_json(config.verbose_output,
+                                                                       anno_graph));
+        }
+        shard_responses.push_back(std::move(search_response));
+    }
+
+    // Merge the top labels found in all shards
+    return merge_shard_results(std::move(shard_responses), "results",
+                               SeqSearchResult::KMER_COUNT_FIELD,
+                               config.num_top_labels);
+}
+
+// Append |value| to |out| as an unsigned LEB128 varint
+void write_varint(std::string *out, uint64_t value) {
+    for ( ; value >= 0x80; value >>= 7) {
+        out->push_back(static_cast<char>(value | 0x80));
+    }
+    out->push_back(static_cast<char>(value));
+}
+
+// Append a signed |value| to |out| as a zigzag-encoded varint
+void write_signed(std::string *out, int64_t value) {
+    write_varint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void write_string(std::string *out, const std::string &str) {
+    write_varint(out, str.size());
+    out->append(str);
+}
+
+// Accessors for the entries of the result types of SeqSearchResult
+const std::string& get_label(const std::string &label) { return label; }
+
+template <typename T>
+const std::string& get_label(const std::pair<std::string, T> &entry) { return entry.first; }
+
+template <typename T>
+const std::string& get_label(const std::tuple<std::string, size_t, T> &entry) {
+    return std::get<0>(entry);
+}
+
+uint64_t get_kmer_count(const std::string &) { return 0; }
+
+uint64_t get_kmer_count(const std::pair<std::string, size_t> &entry) { return entry.second; }
+
+uint64_t get_kmer_count(const std::pair<std::string, sdsl::bit_vector> &entry) {
+    return sdsl::util::cnt_one_bits(entry.second);
+}
+
+template <typename T>
+uint64_t get_kmer_count(const std::tuple<std::string, size_t, T> &entry) {
+    return std::get<1>(entry);
+}
+
+void write_kmer_data(std::string *, const std::string &) {}
+
+void write_kmer_data(std::string *, const std::pair<std::string, size_t> &) {}
+
+void write_kmer_data(std::string *out, const std::pair<std::string, sdsl::bit_vector> &entry) {
+    const sdsl::bit_vector &mask = entry.second;
+    write_varint(out, mask.size());
+    for (uint64_t i = 0; i < mask.size(); i += 8) {
+        out->push_back(static_cast<char>(mask.get_int(i, std::min(uint64_t(8), mask.size() - i))));
+    }
+}
+
+void write_kmer_data(std::string *out,
+                     const std::tuple<std::string, size_t, std::vector<size_t>> &entry) {
+    const auto &abundances = std::get<2>(entry);
+    write_varint(out, abundances.size());
+    for (size_t abundance : abundances) {
+        write_varint(out, abundance);
+    }
+}
+
+void write_kmer_data(std::string *out,
+                     const std::tuple<std::string, size_t,
+                                      std::vector<SmallVector<uint64_t>>> &entry) {
+    const auto &tuples = std::get<2>(entry);
+    write_varint(out, tuples.size());
+    for (const auto &coords : tuples) {
+        write_varint(out, coords.size());
+        uint64_t prev = 0;
+        for (uint64_t coord : coords) {
+            write_signed(out, static_cast<int64_t>(coord - prev));
+            prev = coord;
+        }
+    }
+}
+
+/**
+ * Compact binary encoding of the search results, an alternative to JSON
+ * requested with the header "Accept: application/x-metagraph-binary".
+ * The integers are unsigned LEB128 varints (signed ones are zigzag-encoded)
+ * and the strings are prefixed with their lengths. The labels are given by
+ * their positions in the list returned from /column_labels. The labels change
+ * when the index is reloaded, so the response starts with the version of the
+ * index, also returned by /column_labels in the header "X-Index-Version".
+ *
+ *   response  := index_version num_queries query*
+ *   query     := name has_alignment [alignment] result_type num_labels label*
+ *   alignment := sequence score max_score cigar orientation
+ *   label     := label_id kmer_count [kmer_data]
+ *
+ * The data per k-mer depends on the result type (the query mode):
+ *   0 (labels), 1 (counts): none
+ *   2 (signature): num_kmers, presence mask packed in bytes (LSB first)
+ *   3 (abundances): num_kmers, abundance of each k-mer
+ *   4 (coordinates): num_kmers, for each k-mer: num_coords, deltas of coordinates
+ */
+std::string search_results_to_binary(const RequestResults &request, const Config &config) {
+    const SearchResults &results = *request.results;
+    const Shards &shards = results.shards;
+
+    // positions of the first labels of the shards in /column_labels
+    std::vector<uint64_t> label_offsets(shards.size(), 0);
+    for (size_t s = 1; s < shards.size(); ++s) {
+        label_offsets[s] = label_offsets[s - 1]
+                            + shards[s - 1]->anno_graph->get_annotator().num_labels();
+    }
+
+    std::string out;
+    write_varint(&out, get_index_version(shards));
+    write_varint(&out, request.end - request.begin);
+
+    for (size_t i = request.begin; i < request.end; ++i) {
+        // (k-mer count, shard, position in the result) for the labels from all shards
+        std::vector<std::tuple<uint64_t, size_t, size_t>> labels;
+        // take the alignment with the highest score
+        size_t best = 0;
+        for (size_t s = 0; s < shards.size(); ++s) {
+            const SeqSearchResult &result = results.shard_results[s][i];
+            const auto &alignment = result.get_alignment();
+            const auto &best_alignment = results.shard_results[best][i].get_alignment();
+            if (alignment && (!best_alignment || alignment->score > best_alignment->score))
+                best = s;
+
+            std::visit([&](const auto &entries) {
+                for (size_t j = 0; j < entries.size(); ++j) {
+                    labels.emplace_back(get_kmer_count(entries[j]), s, j);
+                }
+            }, result.get_result());
+        }
+
+        // keep the top labels from all shards, as in merge_shard_results
+        if (shards.size() > 1) {
+            std::stable_sort(labels.begin(), labels.end(),
+                             [](const auto &a, const auto &b) {
+                                 return std::get<0>(a) > std::get<0>(b);
+                             });
+            if (labels.size() > config.num_top_labels)
+                labels.resize(config.num_top_labels);
+        }
+
+        const SeqSearchResult &result = results.shard_results[best][i];
+        write_string(&out, result.get_sequence().name);
+
+        if (const auto &alignment = result.get_alignment()) {
+            out.push_back(1);
+            write_string(&out, result.get_sequence().sequence);
+            write_signed(&out, alignment->score);
+            write_signed(&out, alignment->max_score);
+            write_string(&out, alignment->cigar);
+            out.push_back(alignment->orientation);
+        } else {
+            out.push_back(0);
+        }
+
+        write_varint(&out, result.get_result().index());
+        write_varint(&out, labels.size());
+
+        for (const auto &label : labels) {
+            const size_t s = std::get<1>(label);
+            const size_t j = std::get<2>(label);
+            const auto &label_encoder = shards[s]->anno_graph->get_annotator().get_label_encoder();
+            std::visit([&](const auto &entries) {
+                write_varint(&out, label_offsets[s] + label_encoder.encode(get_label(entries[j])));
+                write_varint(&out, std::get<0>(label));
+                write_kmer_data(&out, entries[j]);
+            }, results.shard_results[s][i].get_result());
+        }
+    }
+
+    return out;
+}
 
 std::string process_search_request(const std::string &received_message,
-                                   const graph::AnnotatedDBG &anno_graph,
-                                   const Config &config_orig) {
+                                   const Shards &shards,
+                                   const Config &config_orig,
+                                   ThreadPool &shard_pool,
+                                   SearchBatcher *batcher = nullptr,
+                                   bool binary = false) {
     Json::Value json = parse_json_string(received_message);
 
     const auto &fasta = json["FASTA"];
@@ -77,76 +590,71 @@ std::string process_search_request(const std::string &received_message,
     }
 
     // Throw client an error if they try to query coordinates/kmer-counts on unsupported indexes
-    if ((config.query_mode == COUNTS || config.query_mode == COUNTS_SUM)
-            && !dynamic_cast<const annot::matrix::IntMatrix *>(
-                            &anno_graph.get_annotator().get_matrix())) {
-        throw std::invalid_argument("Annotation does not support k-mer count queries");
-    }
+    for (const auto &shard : shards) {
+        if ((config.query_mode == COUNTS || config.query_mode == COUNTS_SUM)
+                && !dynamic_cast<const annot::matrix::IntMatrix *>(
+                                &shard->anno_graph->get_annotator().get_matrix())) {
+            throw std::invalid_argument("Annotation does not support k-mer count queries");
+        }
 
-    if (config.query_mode == COORDS
-            && !dynamic_cast<const annot::matrix::MultiIntMatrix *>(
-                            &anno_graph.get_annotator().get_matrix())) {
-        throw std::invalid_argument("Annotation does not support k-mer coordinate queries");
+        if (config.query_mode == COORDS
+                && !dynamic_cast<const annot::matrix::MultiIntMatrix *>(
+                                &shard->anno_graph->get_annotator().get_matrix())) {
+            throw std::invalid_argument("Annotation does not support k-mer coordinate queries");
+        }
     }
 
-    std::unique_ptr<align::DBGAlignerConfig> aligner_config;
-    if (json.get("align", false).asBool()) {
-        aligner_config.reset(new align::DBGAlignerConfig(
-            initialize_aligner_config(config, anno_graph.get_graph())
-        ));
+    config.align_sequences = json.get("align", false).asBool();
+
+    RequestResults request_results;
+
+    if (batcher) {
+        // only the requests with the same parameters are batched together
+        std::string params = fmt::format("{} {} {} {} {} {}",
+                                         static_cast<int>(config.query_mode),
+                                         config.num_top_labels,
+                                         config.discovery_fraction,
+                                         config.alignment_min_exact_match,
+                                         config.alignment_max_nodes_per_seq_char,
+                                         config.align_sequences);
+        request_results = batcher->search(fasta.asString(), params,
+            [&](const std::string &fasta_file) {
+                return search_shards(fasta_file, shards, config, shard_pool);
+            }
+        );
+    } else {
+        // writing to temporary file in order to reuse query code. This is not optimal and
+        // may turn out to be an issue in production. However, adapting FastaParser to
+        // work on strings seems non-trivial. An alternative would be to use
+        // read_fasta_from_string.
+        utils::TempFile tf(config.tmp_dir);
+        tf.ofstream() << fasta.asString();
+        tf.ofstream().close();
+
+        auto results = std::make_shared<SearchResults>(
+            search_shards(tf.name(), shards, config, shard_pool)
+        );
+        size_t num_sequences = results->shard_results.at(0).size();
+        request_results = RequestResults { std::move(results), 0, num_sequences };
     }
 
-    // Need mutex while appending to vector
-    std::vector<SeqSearchResult> search_results;
-    std::mutex result_mutex;
-
-    // writing to temporary file in order to reuse query code. This is not optimal and
-    // may turn out to be an issue in production. However, adapting FastaParser to
-    // work on strings seems non-trivial. An alternative would be to use
-    // read_fasta_from_string.
-    utils::TempFile tf(config.tmp_dir);
-    tf.ofstream() << fasta.asString();
-    tf.ofstream().close();
-
-    // dummy pool doing everything in the caller thread
-    ThreadPool dummy_pool(0);
-    QueryExecutor engine(config, anno_graph, std::move(aligner_config), dummy_pool);
-
-    // Query sequences and callback by appending result to vector with mutex for thread safety
-    engine.query_fasta(tf.name(),
-        [&](const SeqSearchResult &result) {
-            std::lock_guard<std::mutex> lock(result_mutex);
-            search_results.emplace_back(std::move(result));
-        }
-    );
-
-    // Ensure JSON results are sorted by their ID
-    std::sort(search_results.begin(), search_results.end(),
-              [](const SeqSearchResult &lhs, const SeqSearchResult &rhs) {
-                  return lhs.get_sequence().id < rhs.get_sequence().id;
-              });
-
-    // Create full JSON object
-    Json::Value search_response(Json::arrayValue);
-    for (const auto &seq_result : search_results) {
-        search_response.append(seq_result.to_json(config.verbose_output, anno_graph));
-    }
+    if (binary)
+        return search_results_to_binary(request_results, config);
 
     // Return JSON string
     Json::StreamWriterBuilder builder;
-    return Json::writeString(builder, search_response);
+    return Json::writeString(builder, search_results_to_json(request_results, config));
 }
 
 // TODO: implement alignment_result.to_json as in process_search_request
 std::string process_align_request(const std::string &received_message,
-                                  const graph::DeBruijnGraph &graph,
-                                  const Config &config_orig) {
+                                  const std::vector<const graph::DeBruijnGraph *> &shards,
+                                  const Config &config_orig,
+                                  ThreadPool &shard_pool) {
     Json::Value json = parse_json_string(received_message);
 
     const auto &fasta = json["FASTA"];
 
-    Json::Value root = Json::Value(Json::arrayValue);
-
     Config config(config_orig);
 
     config.alignment_num_alternative_paths = json.get(
@@ -175,57 +683,73 @@ std::string process_align_request(const std::string &received_message,
         "max_num_nodes_per_seq_char",
         config.alignment_max_nodes_per_seq_char).asDouble();
 
-    align::DBGAligner aligner(graph, initialize_aligner_config(config, graph));
-    const align::DBGAlignerConfig &aligner_config = aligner.get_config();
-
-    // TODO: make parallel?
-    seq_io::read_fasta_from_string(fasta.asString(),
-                                   [&](seq_io::kseq_t *read_stream) {
-        Json::Value align_entry;
-        align_entry[SeqSearchResult::SEQ_DESCRIPTION_JSON_FIELD] = read_stream->name.s;
-
-        // not supporting reverse complement yet
-        Json::Value alignments = Json::Value(Json::arrayValue);
-
-        for (const auto &path : aligner.align(read_stream->seq.s)) {
-            Json::Value a;
-            a[SeqSearchResult::SCORE_JSON_FIELD] = path.get_score();
-            a[SeqSearchResult::MAX_SCORE_JSON_FIELD] = aligner_config.match_score(read_stream->seq.s)
-                + aligner_config.left_end_bonus + aligner_config.right_end_bonus;
-            aligner.get_config().match_score(read_stream->seq.s);
-            a[SeqSearchResult::SEQUENCE_JSON_FIELD] = std::string(path.get_sequence());
-            a[SeqSearchResult::CIGAR_JSON_FIELD] = path.get_cigar().to_string();
-            a[SeqSearchResult::ORIENTATION_JSON_FIELD] = path.get_orientation();
-
-            alignments.append(a);
-        }
+    auto shard_alignments = query_shards(shards.size(), [&](size_t s) {
+        const graph::DeBruijnGraph &graph = *shards[s];
+
+        Json::Value root = Json::Value(Json::arrayValue);
+
+        align::DBGAligner aligner(graph, initialize_aligner_config(config, graph));
+        const align::DBGAlignerConfig &aligner_config = aligner.get_config();
+
+        // TODO: make parallel?
+        seq_io::read_fasta_from_string(fasta.asString(),
+                                       [&](seq_io::kseq_t *read_stream) {
+            Json::Value align_entry;
+            align_entry[SeqSearchResult::SEQ_DESCRIPTION_JSON_FIELD] = read_stream->name.s;
+
+            // not supporting reverse complement yet
+            Json::Value alignments = Json::Value(Json::arrayValue);
+
+            for (const auto &path : aligner.align(read_stream->seq.s)) {
+                Json::Value a;
+                a[SeqSearchResult::SCORE_JSON_FIELD] = path.get_score();
+                a[SeqSearchResult::MAX_SCORE_JSON_FIELD] = aligner_config.match_score(read_stream->seq.s)
+                    + aligner_config.left_end_bonus + aligner_config.right_end_bonus;
+                aligner.get_config().match_score(read_stream->seq.s);
+                a[SeqSearchResult::SEQUENCE_JSON_FIELD] = std::string(path.get_sequence());
+                a[SeqSearchResult::CIGAR_JSON_FIELD] = path.get_cigar().to_string();
+                a[SeqSearchResult::ORIENTATION_JSON_FIELD] = path.get_orientation();
+
+                alignments.append(a);
+            }
+
+            align_entry[SeqSearchResult::ALIGNMENT_JSON_FIELD] = alignments;
+
+            root.append(align_entry);
+        });
 
-        align_entry[SeqSearchResult::ALIGNMENT_JSON_FIELD] = alignments;
+        return root;
+    }, shard_pool);
 
-        root.append(align_entry);
-    });
+    // Keep the best alignments to all shards
+    Json::Value root = merge_shard_results(std::move(shard_alignments),
+                                           SeqSearchResult::ALIGNMENT_JSON_FIELD,
+                                           SeqSearchResult::SCORE_JSON_FIELD,
+                                           config.alignment_num_alternative_paths);
 
     Json::StreamWriterBuilder builder;
     return Json::writeString(builder, root);
 }
 
-std::string process_column_label_request(const graph::AnnotatedDBG &anno_graph) {
-    auto labels = anno_graph.get_annotator().get_label_encoder().get_labels();
-
+std::string process_column_label_request(const std::vector<const graph::AnnotatedDBG *> &shards) {
     Json::Value root = Json::Value(Json::arrayValue);
 
-    for (const std::string &label : labels) {
-        Json::Value entry = label;
-        root.append(entry);
+    for (const graph::AnnotatedDBG *anno_graph : shards) {
+        auto labels = anno_graph->get_annotator().get_label_encoder().get_labels();
+
+        for (const std::string &label : labels) {
+            Json::Value entry = label;
+            root.append(entry);
+        }
     }
 
     Json::StreamWriterBuilder builder;
     return Json::writeString(builder, root);
 }
 
-std::string process_stats_request(const graph::AnnotatedDBG &anno_graph,
-                                  const std::string &graph_filename,
-                                  const std::string &annotation_filename) {
+Json::Value get_stats(const graph::AnnotatedDBG &anno_graph,
+                      const std::string &graph_filename,
+                      const std::string &annotation_filename) {
     Json::Value root;
 
     Json::Value graph_stats;
@@ -245,12 +769,36 @@ std::string process_stats_request(const graph::AnnotatedDBG &anno_graph,
 
     root["annotation"] = annotation_stats;
 
+    return root;
+}
+
+// For a single index, report its stats. Otherwise, report the stats of each shard.
+std::string process_stats_request(const Shards &shards) {
+    Json::Value root;
+    if (shards.size() == 1) {
+        root = get_stats(*shards[0]->anno_graph, shards[0]->graph_filename,
+                         shards[0]->annotation_filename);
+    } else {
+        Json::Value &shard_stats = (root["shards"] = Json::arrayValue);
+        for (const auto &shard : shards) {
+            shard_stats.append(get_stats(*shard->anno_graph, shard->graph_filename,
+                                         shard->annotation_filename));
+        }
+    }
+
     Json::StreamWriterBuilder builder;
     return Json::writeString(builder, root);
 }
 
+// number of requests waiting for their batch per server thread (the number
+// of batches queried at once is still limited by the number of threads)
+const size_t kBatchedRequestsPerThread = 10;
+
 std::thread start_server(HttpServer &server_startup, Config &config) {
     server_startup.config.thread_pool_size = std::max(1u, get_num_threads());
+    // the requests waiting in batches block their threads, so serve more at once
+    if (config.batch_delay_ms)
+        server_startup.config.thread_pool_size *= kBatchedRequestsPerThread;
 
     if (config.host_address != "") {
         server_startup.config.address = config.host_address;
@@ -262,78 +810,236 @@ std::thread start_server(HttpServer &server_startup, Config &config) {
     return std::thread([&server_startup]() { server_startup.start(); });
 }
 
-template<typename T>
-bool check_data_ready(std::shared_future<T> &data, shared_ptr<HttpServer::Response> response) {
-    if (data.wait_for(0s) != std::future_status::ready) {
-        logger->info("[Server] Got a request during initialization. Asked to come back later");
-        response->write(SimpleWeb::StatusCode::server_error_service_unavailable,
-                        "Server is currently initializing, please come back later.");
-        return false;
+// Load the index. Unless |critical|, throws if the files are invalid instead
+// of terminating the process.
+std::shared_ptr<const ServedIndex> load_index(const std::string &graph_filename,
+                                              const std::string &annotation_filename,
+                                              const Config &config_orig,
+                                              bool critical = true) {
+    Config config(config_orig);
+    config.infbase = graph_filename;
+    config.infbase_annotators = { annotation_filename };
+
+    // spread the index over all NUMA nodes, so that the random accesses
+    // from the server threads are balanced across the sockets
+    common::NumaInterleaveScope numa_interleave(config.numa_interleave);
+
+    logger->info("[Server] Loading graph {}{}...", graph_filename,
+                 utils::with_mmap() ? " (memory mapped)" : "");
+    std::shared_ptr<DeBruijnGraph> graph;
+    if (critical) {
+        graph = load_critical_dbg(graph_filename);
+    } else if (!(graph = load_dbg(graph_filename))) {
+        throw std::runtime_error("Cannot load graph from file " + graph_filename);
     }
+    logger->info("[Server] Graph loaded. Current mem usage: {} MiB", get_curr_RSS() >> 20);
+
+    static std::atomic<uint64_t> num_loaded(0);
+
+    auto index = std::make_shared<ServedIndex>();
+    index->version = ++num_loaded;
+    index->anno_graph = critical ? initialize_annotated_dbg(graph, config)
+                                 : load_annotated_dbg(graph, config);
+    index->graph_filename = graph_filename;
+    index->annotation_filename = annotation_filename;
+    logger->info("[Server] Annotated graph loaded too. Current mem usage: {} MiB", get_curr_RSS() >> 20);
+    return index;
+}
 
-    return true;
+// Get the shards currently served or an empty vector if some are still being
+// loaded. The caller holds its own references, so the shards swapped out by
+// a reload are released only after all requests using them are finished.
+Shards acquire_shards(const Shards &shards, shared_ptr<HttpServer::Response> response) {
+    Shards current(shards.size());
+    for (size_t s = 0; s < shards.size(); ++s) {
+        current[s] = std::atomic_load(&shards[s]);
+        if (!current[s]) {
+            logger->info("[Server] Got a request during initialization. Asked to come back later");
+            response->write(SimpleWeb::StatusCode::server_error_service_unavailable,
+                            "Server is currently initializing, please come back later.");
+            return {};
+        }
+    }
+    return current;
+}
+
+std::vector<const AnnotatedDBG *> get_anno_graphs(const Shards &shards) {
+    std::vector<const AnnotatedDBG *> anno_graphs;
+    for (const auto &shard : shards) {
+        anno_graphs.push_back(shard->anno_graph.get());
+    }
+    return anno_graphs;
+}
+
+// Check the files of the index requested for a reload before loading them,
+// so that invalid requests are rejected right away. The annotation format must
+// also be checked here, as its parser terminates the process on unknown input.
+void check_index_files(const std::string &graph_filename,
+                       const std::string &annotation_filename) {
+    for (const std::string &filename : { graph_filename, annotation_filename }) {
+        if (!std::filesystem::exists(filename))
+            throw std::invalid_argument("File " + filename + " does not exist");
+    }
+
+    if (parse_graph_type(graph_filename) == Config::GraphType::INVALID)
+        throw std::invalid_argument("Unknown graph format in " + graph_filename);
+
+    if (!utils::ends_with(annotation_filename, ".annodbg"))
+        throw std::invalid_argument("Unknown annotation format in " + annotation_filename);
 }
 
 int run_server(Config *config) {
     assert(config);
 
-    assert(config->infbase_annotators.size() == 1);
-
-    ThreadPool graph_loader(1, 1);
+    assert(config->infbase_annotators.size());
+    assert(config->infbase_annotators.size() == config->infbase_graphs.size());
 
-    logger->info("[Server] Loading graph...");
+    // each shard of the index is given by a pair of graph and annotation
+    const size_t num_shards = config->infbase_annotators.size();
+    if (num_shards > 1)
+        logger->info("[Server] Serving an index split into {} shards", num_shards);
 
-    auto anno_graph = graph_loader.enqueue([&]() {
-        auto graph = load_critical_dbg(config->infbase);
-        logger->info("[Server] Graph loaded. Current mem usage: {} MiB", get_curr_RSS() >> 20);
+    // load the shards in parallel
+    ThreadPool graph_loader(std::min(num_shards, (size_t)std::max(1u, get_num_threads())),
+                            num_shards);
 
-        auto anno_graph = initialize_annotated_dbg(graph, *config);
-        logger->info("[Server] Annotated graph loaded too. Current mem usage: {} MiB", get_curr_RSS() >> 20);
-        return anno_graph;
-    });
+    // query the shards in parallel
+    ThreadPool shard_pool(num_shards > 1 ? get_num_threads() : 0);
 
     // defaults for the server
     config->num_top_labels = 10000;
 
+    // batch concurrent search requests
+    std::unique_ptr<SearchBatcher> batcher;
+    if (config->batch_delay_ms) {
+        logger->info("[Server] Batching search requests for up to {} ms or {} bases",
+                     config->batch_delay_ms, config->batch_max_bases);
+        batcher = std::make_unique<SearchBatcher>(config->batch_delay_ms,
+                                                  config->batch_max_bases, *config);
+    }
+
+    Shards shards(num_shards);
+
+    for (size_t s = 0; s < num_shards; ++s) {
+        graph_loader.enqueue([&,s]() {
+            std::atomic_store(&shards[s], load_index(config->infbase_graphs[s],
+                                                     config->infbase_annotators[s],
+                                                     *config));
+        });
+    }
+
+    // distribute the threads serving the queries over the NUMA nodes
+    auto pin_server_thread = [&]() {
+        if (config->numa_interleave)
+            common::pin_thread_to_next_numa_node();
+    };
+
     // the actual server
     HttpServer server;
     server.resource["^/search"]["POST"] = [&](shared_ptr<HttpServer::Response> response,
                                               shared_ptr<HttpServer::Request> request) {
-        if (check_data_ready(anno_graph, response)) {
+        pin_server_thread();
+        if (auto current = acquire_shards(shards, response); current.size()) {
+            const bool binary = is_binary_requested(request);
             process_request(response, request, [&](const std::string &content) {
-                return process_search_request(content, *anno_graph.get(), *config);
-            });
+                return process_search_request(content, current, *config, shard_pool,
+                                              batcher.get(), binary);
+            }, binary ? kBinaryContentType : kJsonContentType);
         }
     };
 
     server.resource["^/align"]["POST"] = [&](shared_ptr<HttpServer::Response> response,
                                              shared_ptr<HttpServer::Request> request) {
-        if (check_data_ready(anno_graph, response)) {
+        pin_server_thread();
+        if (auto current = acquire_shards(shards, response); current.size()) {
             process_request(response, request, [&](const std::string &content) {
-                return process_align_request(content, anno_graph.get()->get_graph(), *config);
+                std::vector<const DeBruijnGraph *> graphs;
+                for (const auto &shard : current) {
+                    graphs.push_back(&shard->anno_graph->get_graph());
+                }
+                return process_align_request(content, graphs, *config, shard_pool);
             });
         }
     };
 
     server.resource["^/column_labels"]["GET"] = [&](shared_ptr<HttpServer::Response> response,
                                                     shared_ptr<HttpServer::Request> request) {
-        if (check_data_ready(anno_graph, response)) {
+        if (auto current = acquire_shards(shards, response); current.size()) {
             process_request(response, request, [&](const std::string &) {
-                return process_column_label_request(*anno_graph.get());
+                return process_column_label_request(get_anno_graphs(current));
+            }, kJsonContentType, {
+                { kIndexVersionHeader, std::to_string(get_index_version(current)) }
             });
         }
     };
 
     server.resource["^/stats"]["GET"] = [&](shared_ptr<HttpServer::Response> response,
                                             shared_ptr<HttpServer::Request> request) {
-        if (check_data_ready(anno_graph, response)) {
+        if (auto current = acquire_shards(shards, response); current.size()) {
             process_request(response, request, [&](const std::string &) {
-                return process_stats_request(*anno_graph.get(), config->infbase,
-                                             config->infbase_annotators.front());
+                return process_stats_request(current);
             });
         }
     };
 
+    // Load a new index (or a shard of it, given by its position) in the background
+    // and swap it in once loaded. The requests in flight keep using the old index,
+    // which is released after they finish. Without the files passed, reloads
+    // the same files (e.g., replaced by a new version).
+    std::atomic<bool> reloading(false);
+    if (config->allow_reload) {
+        server.resource["^/reload"]["POST"] = [&](shared_ptr<HttpServer::Response> response,
+                                                  shared_ptr<HttpServer::Request> request) {
+            auto current = acquire_shards(shards, response);
+            if (current.empty())
+                return;
+
+            if (reloading.exchange(true)) {
+                response->write(SimpleWeb::StatusCode::client_error_conflict,
+                                "Another index is currently being loaded.");
+                return;
+            }
+
+            process_request(response, request, [&](const std::string &content) {
+                try {
+                    Json::Value json = content.empty() ? Json::Value() : parse_json_string(content);
+                    uint64_t s = json.get("shard", 0).asUInt64();
+                    if (s >= num_shards) {
+                        throw std::invalid_argument("Shard " + std::to_string(s)
+                                                        + " is not served");
+                    }
+                    std::string graph_filename
+                            = json.get("graph", current[s]->graph_filename).asString();
+                    std::string annotation_filename
+                            = json.get("annotation", current[s]->annotation_filename).asString();
+                    check_index_files(graph_filename, annotation_filename);
+
+                    graph_loader.enqueue([&, s, graph_filename, annotation_filename]() {
+                        try {
+                            std::atomic_store(&shards[s], load_index(graph_filename,
+                                                                     annotation_filename,
+                                                                     *config, false));
+                            logger->info("[Server] Swapped in the new index");
+                        } catch (const std::exception &e) {
+                            logger->error("[Server] Failed to load the new index: {}", e.what());
+                        }
+                        reloading = false;
+                    });
+
+                    Json::Value root;
+                    root["shard"] = static_cast<Json::UInt64>(s);
+                    root["graph"] = graph_filename;
+                    root["annotation"] = annotation_filename;
+                    return Json::writeString(Json::StreamWriterBuilder(), root);
+
+                } catch (...) {
+                    reloading = false;
+                    throw;
+                }
+            });
+        };
+    }
+
     server.default_resource["GET"] = [](shared_ptr<HttpServer::Response> response,
                                         shared_ptr<HttpServer::Request> request) {
         logger->info("Not found " + request->path);
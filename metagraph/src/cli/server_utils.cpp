@@ -61,12 +61,19 @@ bool is_compression_requested(const std::shared_ptr<HttpServer::Request> &reques
             && encoding_header->second.find("deflate") != std::string::npos;
 }
 
+bool is_binary_requested(const std::shared_ptr<HttpServer::Request> &request) {
+    auto accept_header = request->header.find("Accept");
+    return accept_header != request->header.end()
+            && accept_header->second.find(kBinaryContentType) != std::string::npos;
+}
+
 void write_response(SimpleWeb::StatusCode status,
                     const std::string &msg,
                     std::shared_ptr<HttpServer::Response> response,
-                    bool compress) {
-    auto header = SimpleWeb::CaseInsensitiveMultimap(
-            { { "Content-Type", "application/json" } });
+                    bool compress,
+                    const std::string &content_type,
+                    SimpleWeb::CaseInsensitiveMultimap header) {
+    header.insert(std::make_pair("Content-Type", content_type));
 
     std::string msg_send = msg;
     if (compress) {
@@ -99,7 +106,9 @@ std::string json_str_with_error_msg(const std::string &msg) {
 
 void process_request(std::shared_ptr<HttpServer::Response> &response,
                      const std::shared_ptr<HttpServer::Request> &request,
-                     const std::function<std::string(const std::string &)> &process) {
+                     const std::function<std::string(const std::string &)> &process,
+                     const std::string &content_type,
+                     const SimpleWeb::CaseInsensitiveMultimap &header) {
     // Retrieve string:
     std::string content = request->content.string();
     logger->info("[Server] {} request from {}", request->path,
@@ -108,7 +117,7 @@ void process_request(std::shared_ptr<HttpServer::Response> &response,
     try {
         std::string ret = process(content);
         write_response(SimpleWeb::StatusCode::success_ok, ret, response,
-                       is_compression_requested(request));
+                       is_compression_requested(request), content_type, header);
     } catch (const std::exception &e) {
         logger->info("[Server] Error on request\n{}", e.what());
         response->write(SimpleWeb::StatusCode::client_error_bad_request,
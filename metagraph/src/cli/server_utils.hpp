@@ -9,9 +9,19 @@ namespace cli {
 
 using HttpServer = SimpleWeb::Server<SimpleWeb::HTTP>;
 
+constexpr char kJsonContentType[] = "application/json";
+// compact binary encoding of the responses, requested with the Accept header
+constexpr char kBinaryContentType[] = "application/x-metagraph-binary";
+// version of the index served, changed by every reload
+constexpr char kIndexVersionHeader[] = "X-Index-Version";
+
+bool is_binary_requested(const std::shared_ptr<HttpServer::Request> &request);
+
 void process_request(std::shared_ptr<HttpServer::Response> &response,
                      const std::shared_ptr<HttpServer::Request> &request,
-                     const std::function<std::string(const std::string &)> &process);
+                     const std::function<std::string(const std::string &)> &process,
+                     const std::string &content_type = kJsonContentType,
+                     const SimpleWeb::CaseInsensitiveMultimap &header = {});
 
 Json::Value parse_json_string(const std::string &msg);
 
@@ -263,6 +263,7 @@ void print_annotation_stats(const std::string &fname, const Config &config) {
 
     CHECK_IF_DIFFED_AND_PRINT_STATS(typename annot::RowDiffCoordAnnotator::binary_matrix_type, "ColumnMajor");
     CHECK_IF_DIFFED_AND_PRINT_STATS(typename annot::RowDiffBRWTCoordAnnotator::binary_matrix_type, "Multi-BRWT");
+    CHECK_IF_DIFFED_AND_PRINT_STATS(typename annot::RowDiffBRWTCoordVByteAnnotator::binary_matrix_type, "Multi-BRWT");
 
     const auto &coords_fname = utils::remove_suffix(fname, annot::ColumnCompressed<>::kExtension)
                                                         + annot::ColumnCompressed<>::kCoordExtension;
@@ -4,12 +4,15 @@
 
 #include "common/logger.hpp"
 #include "common/unix_tools.hpp"
+#include "common/serialization.hpp"
 #include "common/threads/threading.hpp"
 #include "annotation/representation/row_compressed/annotate_row_compressed.hpp"
 #include "annotation/representation/column_compressed/annotate_column_compressed.hpp"
 #include "annotation/representation/annotation_matrix/static_annotators_def.hpp"
+#include "annotation/binary_matrix/column_sparse/column_overlap.hpp"
 #include "annotation/binary_matrix/multi_brwt/clustering.hpp"
 #include "annotation/annotation_converters.hpp"
+#include "annotation/row_diff_builder.hpp"
 #include "config/config.hpp"
 #include "load/load_annotation.hpp"
 
@@ -26,6 +29,7 @@ typedef MultiLabelAnnotation<std::string> Annotator;
 
 typedef matrix::TupleCSCMatrix<matrix::ColumnMajor> TupleCSC;
 typedef matrix::TupleCSCMatrix<matrix::BRWT> TupleBRWT;
+typedef matrix::TupleCSCMatrix<matrix::BRWT, matrix::TupleVByteVector> TupleBRWTVByte;
 
 static const Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
                                        Eigen::DontAlignCols, " ", "\n");
@@ -34,7 +38,8 @@ static const Eigen::IOFormat CSVFormat(Eigen::StreamPrecision,
 template <class T>
 matrix::LinkageMatrix cluster_columns(const std::vector<std::string> &files,
                                       Config::AnnotationType anno_type,
-                                      uint64_t num_rows_subsampled) {
+                                      uint64_t num_rows_subsampled,
+                                      size_t lsh_bands) {
     std::vector<uint64_t> row_indexes;
     std::vector<std::unique_ptr<T>> subcolumn_ptrs;
     std::vector<uint64_t> column_ids;
@@ -118,6 +123,12 @@ matrix::LinkageMatrix cluster_columns(const std::vector<std::string> &files,
         subcolumns.at(column_ids[i]) = std::move(*subcolumn_ptrs[i]);
     }
 
+    if (lsh_bands) {
+        logger->trace("Approximate clustering with {} LSH bands", lsh_bands);
+        return matrix::agglomerative_lsh_linkage(std::move(subcolumns),
+                                                 get_num_threads(), lsh_bands);
+    }
+
     return matrix::agglomerative_greedy_linkage(std::move(subcolumns), get_num_threads());
 }
 
@@ -158,10 +169,12 @@ matrix::LinkageMatrix compute_linkage(const std::vector<std::string> &files,
     if (config.greedy_brwt) {
         if (config.subsample_rows) {
             return cluster_columns<sdsl::bit_vector>(files, anno_type,
-                                                     config.num_rows_subsampled);
+                                                     config.num_rows_subsampled,
+                                                     config.lsh_bands);
         } else {
             return cluster_columns<matrix::SparseColumn>(files, anno_type,
-                                                         config.num_rows_subsampled);
+                                                         config.num_rows_subsampled,
+                                                         config.lsh_bands);
         }
     } else {
         return trivial_linkage(files, anno_type);
@@ -277,11 +290,44 @@ convert_to_IntMultiBRWT(const std::vector<std::string> &files,
                 brwt_annotator->get_label_encoder());
 }
 
+// compress the coordinates and serialize them to a brwt_coord_vbyte or
+// row_diff_brwt_coord_vbyte annotation, depending on the target type
+void pack_and_serialize_coords(TupleBRWT&& brwt_coord,
+                               const LabelEncoder<std::string> &label_encoder,
+                               const Config &config) {
+    Timer timer;
+    logger->trace("Compressing coordinates...");
+    auto packed = std::make_unique<TupleBRWTVByte>(
+            pack_coords(std::move(brwt_coord), get_num_threads()));
+    logger->trace("Coordinates compressed in {} sec", timer.elapsed());
+
+    if (config.anno_type == Config::BRWTCoordVByte) {
+        MultiBRWTCoordVByteAnnotator annotation(std::move(packed), label_encoder);
+        annotation.serialize(config.outfbase);
+    } else {
+        assert(config.anno_type == Config::RowDiffBRWTCoordVByte);
+        auto [anchors_file, fork_succ_file] = get_anchors_and_fork_fnames(config.infbase);
+
+        auto diff_matrix = std::make_unique<matrix::TupleRowDiff<TupleBRWTVByte>>(nullptr,
+                    std::move(*packed));
+
+        diff_matrix->load_anchor(anchors_file);
+        diff_matrix->load_fork_succ(fork_succ_file);
+        logger->trace("RowDiff support bitmaps loaded");
+
+        RowDiffBRWTCoordVByteAnnotator annotation(std::move(diff_matrix), label_encoder);
+        annotation.serialize(config.outfbase);
+    }
+    logger->trace("Serialized to {}", config.outfbase);
+}
+
 int transform_annotation(Config *config) {
     assert(config);
 
     const auto &files = config->fnames;
 
+    set_row_diff_io_queue(config->io_queue_depth, config->io_buffers_gb * 1e9);
+
     if (config->anno_type == Config::RowDiff && !files.size()) {
         // Only prepare for the row-diff transform:
         //      Compute number of labels per row (if stage 0),
@@ -535,6 +581,12 @@ int transform_annotation(Config *config) {
             exit(1);
         }
 
+        const auto &base_labels = base_columns.get_label_encoder().get_labels();
+        std::vector<const bitmap *> base_cols;
+        for (const auto &column : base_columns.get_matrix().data()) {
+            base_cols.push_back(column.get());
+        }
+
         logger->trace("Loading input annotations and computing the inner product...");
 
         for (const auto &file : files) {
@@ -545,22 +597,80 @@ int transform_annotation(Config *config) {
                 exit(1);
             }
 
-            for (const std::string &base_label : base_columns.get_label_encoder().get_labels()) {
-                std::vector<std::pair<uint64_t, size_t>> col;
-                base_columns.get_column(base_label).call_ones([&col](uint64_t i) {
-                    col.emplace_back(i, 1);
-                });
-                // TODO: make parallel (call sum_rows on batches)
-                auto row_sum = annotator->get_matrix().sum_rows(col, config->min_count);
+            if (annotator->num_objects() != base_columns.num_objects()) {
+                logger->error("Annotations have different numbers of rows ({} != {})",
+                              annotator->num_objects(), base_columns.num_objects());
+                exit(1);
+            }
+
+            matrix::OverlapMatrix overlaps;
+
+            if (const auto *columns = dynamic_cast<const ColumnCompressed<> *>(annotator.get())) {
+                // intersect all pairs of columns directly
+                std::vector<const bitmap *> cols;
+                for (const auto &column : columns->get_matrix().data()) {
+                    cols.push_back(column.get());
+                }
+                overlaps = matrix::compute_column_overlaps(base_cols, cols, get_num_threads());
 
+            } else {
+                // query the matrix with the set bits of every base column
+                overlaps = matrix::OverlapMatrix::Zero(base_cols.size(),
+                                                       annotator->num_labels());
+
+                #pragma omp parallel for num_threads(get_num_threads()) schedule(dynamic)
+                for (size_t i = 0; i < base_cols.size(); ++i) {
+                    std::vector<std::pair<uint64_t, size_t>> col;
+                    col.reserve(base_cols[i]->num_set_bits());
+                    base_cols[i]->call_ones([&col](uint64_t r) {
+                        col.emplace_back(r, 1);
+                    });
+                    for (auto [j, sum] : annotator->get_matrix().sum_rows(col)) {
+                        overlaps(i, j) = sum;
+                    }
+                }
+            }
+
+            for (size_t i = 0; i < base_labels.size(); ++i) {
                 std::cout << fmt::format("({}<{}>, {}<*>):", config->intersected_columns,
-                                         base_label, file);
-                for (auto [j, sum] : row_sum) {
-                    const std::string &label = annotator->get_label_encoder().decode(j);
-                    std::cout << fmt::format("\t<{}>:{}", label, sum);
+                                         base_labels[i], file);
+                for (size_t j = 0; j < annotator->num_labels(); ++j) {
+                    if (overlaps(i, j) && overlaps(i, j) >= config->min_count) {
+                        const std::string &label = annotator->get_label_encoder().decode(j);
+                        std::cout << fmt::format("\t<{}>:{}", label, overlaps(i, j));
+                    }
                 }
                 std::cout << "\n";
             }
+
+            // write the whole matrix, in text and binary form
+            std::string outfbase = config->outfbase;
+            if (files.size() > 1)
+                outfbase += "." + std::filesystem::path(file).filename().string();
+
+            std::ofstream out_tsv = utils::open_new_ofstream(outfbase + ".overlap.tsv");
+            for (const auto &label : annotator->get_label_encoder().get_labels()) {
+                out_tsv << "\t" << label;
+            }
+            out_tsv << "\n";
+            for (size_t i = 0; i < base_labels.size(); ++i) {
+                out_tsv << base_labels[i];
+                for (size_t j = 0; j < annotator->num_labels(); ++j) {
+                    out_tsv << "\t" << overlaps(i, j);
+                }
+                out_tsv << "\n";
+            }
+
+            sdsl::int_vector<> values(overlaps.size(), 0, 64);
+            std::copy(overlaps.data(), overlaps.data() + overlaps.size(), values.begin());
+            sdsl::util::bit_compress(values);
+
+            std::ofstream out_bin = utils::open_new_ofstream(outfbase + ".overlap.bin");
+            serialize_number(out_bin, overlaps.rows());
+            serialize_number(out_bin, overlaps.cols());
+            values.serialize(out_bin);
+
+            logger->trace("Overlap matrix written to {}.overlap.{{tsv,bin}}", outfbase);
         }
 
         return 0;
@@ -651,6 +761,8 @@ int transform_annotation(Config *config) {
                 && config->anno_type != Config::IntBRWT
                 && config->anno_type != Config::BRWTCoord
                 && config->anno_type != Config::RowDiffBRWTCoord
+                && config->anno_type != Config::BRWTCoordVByte
+                && config->anno_type != Config::RowDiffBRWTCoordVByte
                 && config->anno_type != Config::RowDiffDisk
                 && config->anno_type != Config::IntRowDiffDisk
                 && config->anno_type != Config::RowDiffDiskCoord
@@ -727,6 +839,16 @@ int transform_annotation(Config *config) {
                 logger->trace("Serialized to {}", config->outfbase);
                 break;
             }
+            case Config::BRWTCoordVByte:
+            case Config::RowDiffBRWTCoordVByte: {
+                auto brwt_coord = load_coords(std::move(*convert_to_MultiBRWT(files, *config)), files);
+                logger->trace("Annotation converted in {} sec", timer.elapsed());
+
+                auto label_encoder = brwt_coord.get_label_encoder();
+                pack_and_serialize_coords(std::move(*brwt_coord.release_matrix()),
+                                          label_encoder, *config);
+                break;
+            }
             case Config::RowDiffDiskCoord: {
                 convert_to_row_diff<RowDiffDiskCoordAnnotator>(
                         files, config->infbase, config->outfbase,
@@ -894,6 +1016,44 @@ int transform_annotation(Config *config) {
                 logger->trace("Serialized to {}", config->outfbase);
             }
         }
+    } else if (input_anno_type == Config::BRWTCoord
+                || input_anno_type == Config::RowDiffBRWTCoord) {
+        const auto target_type = input_anno_type == Config::BRWTCoord
+                                    ? Config::BRWTCoordVByte
+                                    : Config::RowDiffBRWTCoordVByte;
+        if (config->anno_type != target_type) {
+            logger->error("Only conversion to '{}' supported for {}",
+                          Config::annotype_to_string(target_type),
+                          Config::annotype_to_string(input_anno_type));
+            exit(1);
+        }
+
+        logger->trace("Loading annotation from disk...");
+
+        if (input_anno_type == Config::BRWTCoord) {
+            MultiBRWTCoordAnnotator annotation;
+            if (!annotation.load(files.at(0))) {
+                logger->error("Cannot load annotations from file '{}'", files.at(0));
+                exit(1);
+            }
+            logger->trace("Annotation loaded in {} sec", timer.elapsed());
+
+            auto label_encoder = annotation.get_label_encoder();
+            pack_and_serialize_coords(std::move(*annotation.release_matrix()),
+                                      label_encoder, *config);
+        } else {
+            RowDiffBRWTCoordAnnotator annotation;
+            if (!annotation.load(files.at(0))) {
+                logger->error("Cannot load annotations from file '{}'", files.at(0));
+                exit(1);
+            }
+            logger->trace("Annotation loaded in {} sec", timer.elapsed());
+
+            // the row-diff bitmaps are loaded again from the graph
+            auto label_encoder = annotation.get_label_encoder();
+            pack_and_serialize_coords(std::move(annotation.release_matrix()->diffs()),
+                                      label_encoder, *config);
+        }
     } else {
         logger->error(
                 "Conversion to other representations is not implemented for {} "
@@ -974,6 +1134,12 @@ int relax_multi_brwt(Config *config) {
         case Config::RowDiffBRWTCoord:
             annotator = std::make_unique<RowDiffBRWTCoordAnnotator>();
             break;
+        case Config::BRWTCoordVByte:
+            annotator = std::make_unique<MultiBRWTCoordVByteAnnotator>();
+            break;
+        case Config::RowDiffBRWTCoordVByte:
+            annotator = std::make_unique<RowDiffBRWTCoordVByteAnnotator>();
+            break;
         default:
             logger->error("Relaxation for {} is not supported", Config::annotype_to_string(anno_type));
             exit(1);
@@ -995,6 +1161,8 @@ int relax_multi_brwt(Config *config) {
         mat = &int_rd_brwt->get_matrix().diffs();
     } else if (const auto *rd_brwt_coord = dynamic_cast<RowDiffBRWTCoordAnnotator *>(annotator.get())) {
         mat = &rd_brwt_coord->get_matrix().diffs();
+    } else if (const auto *rd_brwt_vbyte = dynamic_cast<RowDiffBRWTCoordVByteAnnotator *>(annotator.get())) {
+        mat = &rd_brwt_vbyte->get_matrix().diffs();
     }
 
     if (const auto *rb_brwt = dynamic_cast<const matrix::Rainbow<matrix::BRWT> *>(mat)) {
@@ -8,6 +8,7 @@
 #include <filesystem>
 
 #include <sdsl/uint128_t.hpp>
+#include <x86/avx2.h>
 
 #include "common/logger.hpp"
 #include "common/utils/file_utils.hpp"
@@ -196,6 +197,47 @@ void close_and_check(std::ofstream &sink, const std::string &fname) {
     }
 }
 
+template <typename T>
+std::vector<EliasFanoBlock<T>> read_blocks(const std::string &file) {
+    std::ifstream source(file, std::ios::binary);
+    if (!source) {
+        logger->error("Unable to open {}", file);
+        std::exit(EXIT_FAILURE);
+    }
+
+    std::vector<EliasFanoBlock<T>> blocks;
+    uint64_t num_preceding = 0;
+    while (true) {
+        // the header is written by EliasFanoEncoder::init
+        EliasFanoBlock<T> block;
+        block.file_pos = source.tellg();
+        block.num_preceding = num_preceding;
+        if (!source.read(reinterpret_cast<char *>(&block.size), sizeof(size_t)))
+            break;
+
+        uint8_t num_lower_bits;
+        size_t num_upper_bytes;
+        source.read(reinterpret_cast<char *>(&block.first), sizeof(T));
+        source.read(reinterpret_cast<char *>(&num_lower_bits), 1);
+        source.read(reinterpret_cast<char *>(&num_upper_bytes), sizeof(size_t));
+        if (!source) {
+            logger->error("Error while reading from {}", file);
+            std::exit(EXIT_FAILURE);
+        }
+        // skip the upper and the lower bits
+        source.seekg(num_upper_bytes + (num_lower_bits * block.size + 7) / 8,
+                     std::ios::cur);
+
+        num_preceding += block.size;
+        blocks.push_back(block);
+    }
+    return blocks;
+}
+
+template std::vector<EliasFanoBlock<uint64_t>> read_blocks(const std::string &);
+template std::vector<EliasFanoBlock<sdsl::uint128_t>> read_blocks(const std::string &);
+template std::vector<EliasFanoBlock<sdsl::uint256_t>> read_blocks(const std::string &);
+
 // ------------ EliasFanoEncoder --------------------------------------------------------
 /**
  * Elias-Fano encoder that streams the encoded result into a file.
@@ -427,90 +469,182 @@ size_t EliasFanoDecoder<T>::decompress_next_block() {
     if (size_ == static_cast<size_t>(-1))
         return 0;
 
-    size_t block_begin = position_;
-    size_t block_end = std::min(size_, position_ + sizeof(buffer_) / sizeof(T));
+    while (buffer_end_ < READ_BUF_SIZE) {
+        if (position_ == size_ && !init()) // read the next chunk of compressed data
+            break;
 
-    while (true) {
-        if (position_ == block_end) {
-            // rollback #position_ and read the upper bits
-            buffer_end_ -= (block_end - block_begin);
-            position_ = block_begin;
-            while (position_ < block_end) {
-                // Skip to the first non-zero block.
-                while (upper_[upper_pos_] == 0U) {
-                    upper_pos_++;
-                }
-                size_t trailing_zeros = sdsl::bits::lo(upper_[upper_pos_]);
-                upper_[upper_pos_] &= (upper_[upper_pos_] - 1UL); // reset the lowest 1 bit
-                T upper = 64 * upper_pos_ + trailing_zeros - position_;
-                buffer_[buffer_end_] |= (upper << num_lower_bits_);
-                buffer_[buffer_end_] += offset_;
-                buffer_end_++;
-                position_++;
-            }
-            if (buffer_end_ == sizeof(buffer_) / sizeof(T)) {
-                break;
-            }
-            assert(position_ == size_);
-            if (!init()) { // read the next chunk of compressed data
-                break;
+        const size_t count = std::min(size_ - position_, READ_BUF_SIZE - buffer_end_);
+        decode_lower(buffer_ + buffer_end_, count);
+        decode_upper(buffer_ + buffer_end_, count);
+        position_ += count;
+        buffer_end_ += count;
+    }
+
+    return buffer_end_;
+}
+
+/**
+ * Unpacks |count| values of |num_bits| bits starting at bit |pos| of |data|.
+ * All values must be readable with an unaligned load of sizeof(T) bytes.
+ */
+template <typename T>
+inline void unpack_bits(const char *data, size_t pos, uint8_t num_bits, T *out, size_t count) {
+    const T mask = (T(1) << num_bits) - 1UL;
+    for (size_t i = 0; i < count; ++i, pos += num_bits) {
+        out[i] = (load_unaligned<T>(data + pos / 8) >> (pos % 8)) & mask;
+    }
+}
+
+/**
+ * Unpacks values of at most 56 bits, each read with a single 64-bit load. Processes
+ * four values at a time with AVX2 if available.
+ */
+template <typename T>
+inline void unpack_bits_64(const char *data, size_t pos, uint8_t num_bits, T *out, size_t count) {
+    assert(num_bits <= 56);
+    size_t i = 0;
+#ifdef __AVX2__
+    const simde__m256i mask = simde_mm256_set1_epi64x((1ULL << num_bits) - 1);
+    const simde__m256i seven = simde_mm256_set1_epi64x(7);
+    const simde__m256i step = simde_mm256_set1_epi64x(4 * num_bits);
+    simde__m256i bit_pos = simde_mm256_setr_epi64x(pos, pos + num_bits,
+                                                   pos + 2 * num_bits,
+                                                   pos + 3 * num_bits);
+    for ( ; i + 4 <= count; i += 4) {
+        simde__m256i v = simde_mm256_i64gather_epi64(
+                reinterpret_cast<const long long *>(data),
+                simde_mm256_srli_epi64(bit_pos, 3), 1);
+        v = simde_mm256_and_si256(
+                simde_mm256_srlv_epi64(v, simde_mm256_and_si256(bit_pos, seven)), mask);
+        if constexpr (std::is_same_v<T, uint64_t>) {
+            simde_mm256_storeu_si256(reinterpret_cast<simde__m256i *>(out + i), v);
+        } else {
+            alignas(32) uint64_t values[4];
+            simde_mm256_store_si256(reinterpret_cast<simde__m256i *>(values), v);
+            for (size_t j = 0; j < 4; ++j) {
+                out[i + j] = values[j];
             }
-            assert(position_ == 0U);
-            block_begin = 0;
-            block_end = std::min(size_, sizeof(buffer_) / sizeof(T) - buffer_end_);
+        }
+        bit_pos = simde_mm256_add_epi64(bit_pos, step);
+    }
+    pos += i * num_bits;
+#endif
+    const uint64_t mask64 = (1ULL << num_bits) - 1;
+    for ( ; i < count; ++i, pos += num_bits) {
+        out[i] = (load_unaligned<uint64_t>(data + pos / 8) >> (pos % 8)) & mask64;
+    }
+}
+
+template <typename T>
+void EliasFanoDecoder<T>::decode_lower(T *out, size_t count) {
+    assert(position_ + count <= size_);
+    assert(num_lower_bits_ < 8 * sizeof(T));
+
+    if (!num_lower_bits_) {
+        std::fill(out, out + count, T(0));
+        return;
+    }
+
+    size_t i = 0;
+    while (i < count) {
+        const size_t pos_bits = (position_ + i) * num_lower_bits_;
+        if (pos_bits / 8 - cur_pos_bytes_ + sizeof(T) > sizeof(lower_)) {
+            read_lower();
+            continue;
+        }
+        // the number of elements that can be loaded from the current window
+        const size_t window_end_bits = (cur_pos_bytes_ + sizeof(lower_) - sizeof(T) + 1) * 8;
+        const size_t end = std::min(count, (window_end_bits + num_lower_bits_ - 1)
+                                                / num_lower_bits_ - position_);
+        assert(end > i);
+
+        if (num_lower_bits_ <= 56) {
+            unpack_bits_64(lower_, pos_bits - cur_pos_bytes_ * 8, num_lower_bits_,
+                           out + i, end - i);
         } else {
-            assert(position_ < size_);
-            assert(num_lower_bits_ < 8 * sizeof(T));
-            const size_t pos_bits = position_ * num_lower_bits_;
-            if (pos_bits / 8 - cur_pos_bytes_ + sizeof(T) > sizeof(lower_)) {
-                const size_t leftover = sizeof(T) - 1;
-                memcpy(lower_, lower_ + sizeof(lower_) - leftover, leftover);
-                const uint32_t to_read = std::min(sizeof(lower_) - leftover, num_lower_bytes_);
-
-                // If reading fails, retry MAX_NUM_RETRIES times
-                size_t num_retries = 0;
-                const size_t MAX_NUM_RETRIES = 100;
-                const auto source_pos = source_.tellg();
-
-                while (num_retries <= MAX_NUM_RETRIES) {
-                    if (source_.read(lower_ + leftover, to_read))
-                        break;
-
-                    // reading failed -> retry
-                    while (++num_retries <= MAX_NUM_RETRIES) {
-                        logger->warn("Failed reading lower bits from {}. Retry #{}...", source_name_, num_retries);
-                        using namespace std::chrono_literals;
-                        std::this_thread::sleep_for(1s);
-
-                        source_ = std::ifstream(source_name_, std::ios::binary);
-                        if (!source_) {
-                            logger->error("Unable to open {}", source_name_);
-                            continue;
-                        }
-                        source_.seekg(source_pos);
-                        if (!source_) {
-                            logger->error("Unable to seek in {}", source_name_);
-                            continue;
-                        }
-                        break;
-                    }
-                }
-                if (num_retries > MAX_NUM_RETRIES) {
-                    logger->error("Failed reading lower bits from {} after {} retries",
-                                  source_name_, MAX_NUM_RETRIES);
-                    std::exit(EXIT_FAILURE);
-                }
-                num_lower_bytes_ -= to_read;
-                cur_pos_bytes_ += sizeof(lower_) - leftover;
+            unpack_bits(lower_, pos_bits - cur_pos_bytes_ * 8, num_lower_bits_,
+                        out + i, end - i);
+        }
+        i = end;
+    }
+}
+
+template <typename T>
+void EliasFanoDecoder<T>::decode_upper(T *out, size_t count) {
+    // each element is a 1 in the upper bits preceded by as many zeros as the
+    // difference of its upper part from the upper part of the previous element
+    uint64_t word = upper_[upper_pos_];
+    for (size_t i = 0; i < count; ++i) {
+        // Skip to the first non-zero block.
+        while (word == 0U) {
+            word = upper_[++upper_pos_];
+        }
+        T upper = 64 * upper_pos_ + sdsl::bits::lo(word) - (position_ + i);
+        word &= word - 1; // reset the lowest 1 bit
+        out[i] |= (upper << num_lower_bits_);
+        out[i] += offset_;
+    }
+    upper_[upper_pos_] = word;
+}
+
+template <typename T>
+void EliasFanoDecoder<T>::read_lower() {
+    const size_t leftover = sizeof(T) - 1;
+    memcpy(lower_, lower_ + sizeof(lower_) - leftover, leftover);
+    const uint32_t to_read = std::min(sizeof(lower_) - leftover, num_lower_bytes_);
+
+    // If reading fails, retry MAX_NUM_RETRIES times
+    size_t num_retries = 0;
+    const size_t MAX_NUM_RETRIES = 100;
+    const auto source_pos = source_.tellg();
+
+    while (num_retries <= MAX_NUM_RETRIES) {
+        if (source_.read(lower_ + leftover, to_read))
+            break;
+
+        // reading failed -> retry
+        while (++num_retries <= MAX_NUM_RETRIES) {
+            logger->warn("Failed reading lower bits from {}. Retry #{}...", source_name_, num_retries);
+            using namespace std::chrono_literals;
+            std::this_thread::sleep_for(1s);
+
+            source_ = std::ifstream(source_name_, std::ios::binary);
+            if (!source_) {
+                logger->error("Unable to open {}", source_name_);
+                continue;
+            }
+            source_.seekg(source_pos);
+            if (!source_) {
+                logger->error("Unable to seek in {}", source_name_);
+                continue;
             }
-            const size_t pos = pos_bits - cur_pos_bytes_ * 8;
-            buffer_[buffer_end_++] = (load_unaligned<T>(lower_ + (pos / 8)) >> (pos % 8))
-                                        & lower_bits_mask_;
-            position_++;
+            break;
         }
     }
+    if (num_retries > MAX_NUM_RETRIES) {
+        logger->error("Failed reading lower bits from {} after {} retries",
+                      source_name_, MAX_NUM_RETRIES);
+        std::exit(EXIT_FAILURE);
+    }
+    num_lower_bytes_ -= to_read;
+    cur_pos_bytes_ += sizeof(lower_) - leftover;
+}
 
-    return buffer_end_;
+template <typename T>
+void EliasFanoDecoder<T>::seek(uint64_t file_pos) {
+    assert(!remove_source_);
+    if (!source_.is_open())
+        source_.open(source_name_, std::ios::binary);
+
+    source_.clear();
+    source_.seekg(file_pos);
+    if (!source_) {
+        logger->error("Unable to seek in {}", source_name_);
+        std::exit(EXIT_FAILURE);
+    }
+    buffer_pos_ = 0;
+    buffer_end_ = 0;
+    init();
 }
 
 // TODO: make this public and avoid reconstruction
@@ -596,6 +730,21 @@ EliasFanoDecoder<std::pair<T, C>>::EliasFanoDecoder(const std::string &source,
     }
 }
 
+template <typename T, typename C>
+void EliasFanoDecoder<std::pair<T, C>>::seek(uint64_t file_pos, uint64_t num_preceding) {
+    source_first_.seek(file_pos);
+
+    if (!source_second_.is_open())
+        source_second_.open(source_second_name_, std::ios::binary);
+
+    source_second_.clear();
+    source_second_.seekg(num_preceding * sizeof(C));
+    if (!source_second_) {
+        logger->error("Unable to seek in {}", source_second_name_);
+        std::exit(EXIT_FAILURE);
+    }
+}
+
 // ------------------------------ EliasFanoEncoderBuffered ----------------------------
 template <typename T>
 EliasFanoEncoderBuffered<T>::EliasFanoEncoderBuffered(const std::string &file_name,
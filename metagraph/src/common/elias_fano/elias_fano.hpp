@@ -30,6 +30,24 @@ void remove_chunks(const std::vector<std::string> &files);
 // get size in bytes
 uint64_t chunk_size(const std::string &file);
 
+/**
+ * A block of elements encoded in an Elias-Fano file. Each call of
+ * EliasFanoEncoderBuffered::encode_chunk appends a new block to the file.
+ */
+template <typename T>
+struct EliasFanoBlock {
+    uint64_t file_pos; // offset of the block in the file
+    uint64_t num_preceding; // number of elements stored in the preceding blocks
+    uint64_t size; // number of elements in the block
+    T first; // the smallest element in the block
+};
+
+/**
+ * Reads the headers of the blocks in an Elias-Fano file, skipping the encoded data.
+ */
+template <typename T>
+std::vector<EliasFanoBlock<T>> read_blocks(const std::string &file);
+
 
 /**
  * Decodes a list of compressed sorted integers stored in a file using #EliasFanoEncoder.
@@ -43,6 +61,12 @@ class EliasFanoDecoder {
     /** Creates a decoder that retrieves data from the given file */
     EliasFanoDecoder(const std::string &source_name, bool remove_source = true);
 
+    /**
+     * Moves the decoder to the block starting at |file_pos| (see #read_blocks).
+     * The source must not be removed by the decoder.
+     */
+    void seek(uint64_t file_pos);
+
     /** Returns the next compressed element or empty if all elements were read */
     inline std::optional<T> next() {
         if (buffer_pos_ == buffer_end_) {
@@ -60,6 +84,15 @@ class EliasFanoDecoder {
     /** Decompressed the next block into buffer and returns the number of elements in it */
     size_t decompress_next_block();
 
+    /** Writes the lower bits of the next |count| elements to |out| */
+    void decode_lower(T *out, size_t count);
+
+    /** Adds the upper bits and the offset to the next |count| elements in |out| */
+    void decode_upper(T *out, size_t count);
+
+    /** Moves the window #lower_ to the next bytes of the lower bits */
+    void read_lower();
+
     /** Index of current element */
     size_t position_ = 0;
 
@@ -131,6 +164,12 @@ class EliasFanoDecoder<std::pair<T, C>> {
   public:
     EliasFanoDecoder(const std::string &source, bool remove_source = true);
 
+    /**
+     * Moves the decoder to the block starting at |file_pos|, which is preceded
+     * by |num_preceding| elements (see #read_blocks).
+     */
+    void seek(uint64_t file_pos, uint64_t num_preceding);
+
     inline std::optional<std::pair<T, C>> next() {
         std::optional<T> first = source_first_.next();
         C second;
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <optional>
 #include <queue>
 #include <string>
 #include <vector>
@@ -147,6 +148,248 @@ class MergeDecoder {
     MergeHeap<T> heap_;
 };
 
+/**
+ * Tournament tree of losers for merging k sorted streams.
+ *
+ * Each internal node stores the source that lost the match played at that node,
+ * while the overall winner is kept separately. Replacing the winner with the next
+ * element of its source replays only the matches on the path from its leaf to the
+ * root, i.e. it takes exactly ceil(log2(k)) comparisons, compared to O(k) element
+ * moves in #MergeHeap, which makes it preferable for a large number of sources.
+ * @tparam T the type of the merged elements
+ */
+template <typename T, class Compare = std::less<T>>
+class LoserTree {
+  public:
+    /** Builds the tree from the first elements of all sources (empty if exhausted) */
+    explicit LoserTree(std::vector<std::optional<T>>&& heads)
+          : size_(heads.size()),
+            values_(size_),
+            exhausted_(size_),
+            losers_(size_) {
+        for (uint32_t i = 0; i < size_; ++i) {
+            exhausted_[i] = !heads[i].has_value();
+            if (heads[i].has_value())
+                values_[i] = std::move(heads[i].value());
+        }
+        if (size_)
+            winner_ = build(1);
+    }
+
+    inline bool empty() const { return !size_ || exhausted_[winner_]; }
+
+    inline const T& top() const {
+        assert(!empty());
+        return values_[winner_];
+    }
+
+    /** Index of the source the current top element was read from */
+    inline uint32_t top_source() const { return winner_; }
+
+    /** Replaces the top element with the next element from the same source */
+    inline void replace_top(std::optional<T>&& value) {
+        assert(!empty());
+        exhausted_[winner_] = !value.has_value();
+        if (value.has_value())
+            values_[winner_] = std::move(value.value());
+
+        uint32_t winner = winner_;
+        for (uint32_t node = (size_ + winner) / 2; node > 0; node /= 2) {
+            if (beats(losers_[node], winner))
+                std::swap(losers_[node], winner);
+        }
+        winner_ = winner;
+    }
+
+  private:
+    uint32_t size_;
+    std::vector<T> values_;
+    std::vector<char> exhausted_;
+    // losers_[node] for internal nodes 1..size_-1, the leaves are size_..2*size_-1
+    std::vector<uint32_t> losers_;
+    uint32_t winner_ = 0;
+    Compare compare_ = Compare();
+
+    // true if source a goes before b, exhausted sources are the largest
+    inline bool beats(uint32_t a, uint32_t b) const {
+        if (exhausted_[a] || exhausted_[b])
+            return !exhausted_[a] && (exhausted_[b] || a < b);
+
+        return compare_(values_[a], values_[b])
+                || (!compare_(values_[b], values_[a]) && a < b);
+    }
+
+    // plays the matches in the subtree rooted at |node| and returns its winner
+    uint32_t build(uint32_t node) {
+        if (node >= size_)
+            return node - size_;
+
+        uint32_t left = build(2 * node);
+        uint32_t right = build(2 * node + 1);
+        if (beats(left, right)) {
+            losers_[node] = right;
+            return left;
+        } else {
+            losers_[node] = left;
+            return right;
+        }
+    }
+};
+
+/**
+ * Decoder that merges several sorted sources into a single sorted stream using a
+ * #LoserTree. Has the same interface as #MergeDecoder.
+ * @tparam T the type of data being stored
+ * @tparam Source a source of sorted elements with std::optional<T> next()
+ */
+template <typename T, class Source = EliasFanoDecoder<T>>
+class LoserTreeDecoder {
+  public:
+    typedef T value_type;
+
+    LoserTreeDecoder(const std::vector<std::string> &source_names, bool remove_sources)
+          : LoserTreeDecoder(open(source_names, remove_sources)) {}
+
+    explicit LoserTreeDecoder(std::vector<Source>&& sources)
+          : sources_(std::move(sources)), tree_(get_heads(sources_)) {}
+
+    inline bool empty() const { return tree_.empty(); }
+
+    inline const T& top() const {
+#ifndef NDEBUG
+        if (tree_.empty())
+            throw std::runtime_error("Popping an empty LoserTreeDecoder");
+#endif
+        return tree_.top();
+    }
+
+    inline T pop() {
+#ifndef NDEBUG
+        if (tree_.empty())
+            throw std::runtime_error("Popping an empty LoserTreeDecoder");
+#endif
+        T result = tree_.top();
+        tree_.replace_top(sources_[tree_.top_source()].next());
+        return result;
+    }
+
+  private:
+    std::vector<Source> sources_;
+    LoserTree<T> tree_;
+
+    static std::vector<Source> open(const std::vector<std::string> &source_names,
+                                    bool remove_sources) {
+        std::vector<Source> sources;
+        sources.reserve(source_names.size());
+        for (const std::string &name : source_names) {
+            sources.emplace_back(name, remove_sources);
+        }
+        return sources;
+    }
+
+    static std::vector<std::optional<T>> get_heads(std::vector<Source> &sources) {
+        std::vector<std::optional<T>> heads;
+        heads.reserve(sources.size());
+        for (Source &source : sources) {
+            heads.push_back(source.next());
+        }
+        return heads;
+    }
+};
+
+/**
+ * Decoder of the elements of an Elias-Fano file with keys (the first members of
+ * pairs) in the range [begin, end). Empty bounds are unlimited. The blocks of the
+ * file preceding the range are skipped without decoding them. The source file is
+ * never removed.
+ */
+template <typename T>
+class RangeDecoder {
+  public:
+    typedef utils::get_first_type_t<T> key_type;
+
+    RangeDecoder(const std::string &source,
+                 const std::vector<EliasFanoBlock<key_type>> &blocks,
+                 const std::optional<key_type> &begin,
+                 const std::optional<key_type> &end)
+          : decoder_(source, false), end_(end) {
+        if (!begin.has_value())
+            return;
+
+        // the last block starting before |begin| may contain elements >= begin
+        auto it = std::lower_bound(blocks.begin(), blocks.end(), begin.value(),
+                                   [](const auto &block, const key_type &key) {
+                                       return block.first < key;
+                                   });
+        if (it != blocks.begin() && (--it) != blocks.begin()) {
+            if constexpr (utils::is_pair_v<T>) {
+                decoder_.seek(it->file_pos, it->num_preceding);
+            } else {
+                decoder_.seek(it->file_pos);
+            }
+        }
+
+        do {
+            first_ = decoder_.next();
+        } while (first_.has_value() && utils::get_first(first_.value()) < begin.value());
+    }
+
+    inline std::optional<T> next() {
+        std::optional<T> result;
+        if (first_.has_value()) {
+            result.swap(first_);
+        } else if (!done_) {
+            result = decoder_.next();
+        }
+        if (result.has_value() && end_.has_value()
+                && !(utils::get_first(result.value()) < end_.value())) {
+            done_ = true;
+            result.reset();
+        }
+        return result;
+    }
+
+  private:
+    EliasFanoDecoder<T> decoder_;
+    std::optional<key_type> end_;
+    // the first element in range, read in the constructor
+    std::optional<T> first_;
+    bool done_ = false;
+};
+
+/**
+ * Pops all elements from a merging decoder and passes them to |on_new_item|
+ * without duplicates. Counts of pairs with equal first members are summed
+ * (saturated at the maximum value of the count type).
+ */
+template <class Decoder>
+void merge_unique(Decoder &decoder,
+                  const std::function<void(const typename Decoder::value_type &)> &on_new_item) {
+    using T = typename Decoder::value_type;
+    if (decoder.empty())
+        return;
+
+    T current = decoder.pop();
+    while (!decoder.empty()) {
+        const T next = decoder.pop();
+        if constexpr (utils::is_pair_v<T>) {
+            using C = typename T::second_type;
+            if (current.first != next.first) {
+                on_new_item(current);
+                current = next;
+            } else if (current.second < std::numeric_limits<C>::max() - next.second) {
+                current.second += next.second;
+            } else {
+                current.second = std::numeric_limits<C>::max();
+            }
+        } else if (current != next) {
+            on_new_item(current);
+            current = next;
+        }
+    }
+    on_new_item(current);
+}
+
 // transforms objects from Decoder::T to T
 template <class Decoder, typename T>
 class Transformed {
@@ -277,5 +520,93 @@ void merge_files(const std::vector<std::string> &sources,
     on_new_item(current);
 }
 
+/**
+ * Merges Elias-Fano sorted compressed files in parallel. The key range is split into
+ * |num_threads| partitions of about equal size, and each partition is merged with a
+ * #LoserTreeDecoder into a separate Elias-Fano file. The split points are sampled
+ * from the first elements of the blocks of the source files, so the partitions are
+ * only as balanced as the block granularity allows.
+ * Duplicates are removed and the counts of pairs with equal keys are summed, as in
+ * #merge_files.
+ * @return the names of the merged segments, in the order of their keys. The segments
+ * can be joined into a single file with #concat.
+ */
+template <typename T>
+std::vector<std::string> merge_files_parallel(const std::vector<std::string> &sources,
+                                              const std::string &out_prefix,
+                                              size_t num_threads,
+                                              bool remove_sources = true,
+                                              size_t buffer_size = 100'000) {
+    using K = utils::get_first_type_t<T>;
+
+    std::vector<std::vector<EliasFanoBlock<K>>> blocks(sources.size());
+    std::vector<std::pair<K, uint64_t>> samples;
+    uint64_t total_size = 0;
+    for (size_t i = 0; i < sources.size(); ++i) {
+        blocks[i] = read_blocks<K>(sources[i]);
+        for (const auto &block : blocks[i]) {
+            samples.emplace_back(block.first, block.size);
+            total_size += block.size;
+        }
+    }
+
+    // each partition opens all sources (and their .count files for pairs)
+    const size_t max_files_open = 512;
+    const size_t files_per_partition
+            = std::max(sources.size() * (utils::is_pair_v<T> ? 2 : 1), size_t(1));
+    num_threads = std::min(num_threads, max_files_open / files_per_partition);
+    num_threads = std::max(std::min(num_threads, samples.size()), size_t(1));
+
+    // pick the split points at the weighted quantiles of the block samples
+    std::sort(samples.begin(), samples.end(), utils::LessFirst());
+    std::vector<K> splits;
+    uint64_t cumulative = 0;
+    for (size_t i = 0, p = 1; i < samples.size() && p < num_threads; ++i) {
+        if (cumulative >= total_size * p / num_threads) {
+            if (i && (splits.empty() || splits.back() < samples[i].first))
+                splits.push_back(samples[i].first);
+
+            while (p < num_threads && cumulative >= total_size * p / num_threads) {
+                p++;
+            }
+        }
+        cumulative += samples[i].second;
+    }
+
+    std::vector<std::string> segments(splits.size() + 1);
+    for (size_t p = 0; p < segments.size(); ++p) {
+        segments[p] = out_prefix + "_segment_" + std::to_string(p);
+    }
+
+    common::logger->trace("Merging {} chunks with {} elements into {} segments",
+                          sources.size(), total_size, segments.size());
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (size_t p = 0; p < segments.size(); ++p) {
+        std::optional<K> begin;
+        std::optional<K> end;
+        if (p > 0)
+            begin = splits[p - 1];
+        if (p < splits.size())
+            end = splits[p];
+
+        std::vector<RangeDecoder<T>> decoders;
+        decoders.reserve(sources.size());
+        for (size_t i = 0; i < sources.size(); ++i) {
+            decoders.emplace_back(sources[i], blocks[i], begin, end);
+        }
+        LoserTreeDecoder<T, RangeDecoder<T>> decoder(std::move(decoders));
+
+        EliasFanoEncoderBuffered<T> encoder(segments[p], buffer_size);
+        merge_unique(decoder, [&](const T &v) { encoder.add(v); });
+        encoder.finish();
+    }
+
+    if (remove_sources)
+        remove_chunks(sources);
+
+    return segments;
+}
+
 } // namespace elias_fano
 } // namespace mtg
@@ -141,7 +141,7 @@ void SortedSetDiskBase<T>::dump_to_file() {
 
     if (total_chunk_size_bytes_ > disk_cap_bytes_) {
         std::string all_merged_file = merged_all_name(chunk_file_prefix_, merged_all_count_);
-        merge_all(all_merged_file, get_file_names());
+        merge_all(all_merged_file, get_file_names(), num_blocks_);
 
         total_chunk_size_bytes_ = elias_fano::chunk_size(all_merged_file);
         if (total_chunk_size_bytes_ > disk_cap_bytes_ * 0.8) {
@@ -238,16 +238,16 @@ void SortedSetDiskBase<T>::merge_l1(const std::string &chunk_file_prefix,
 
 template <typename T>
 void SortedSetDiskBase<T>::merge_all(const std::string &out_file,
-                                     const std::vector<std::string> &to_merge) {
+                                     const std::vector<std::string> &to_merge,
+                                     size_t num_threads) {
     logger->trace(
             "Max allocated disk capacity exceeded. Starting merging all {} chunks "
             "into {}",
             to_merge.size(), out_file);
-    elias_fano::EliasFanoEncoderBuffered<T> encoder(out_file, ENCODER_BUFFER_SIZE);
-    std::function<void(const T &v)> on_new_item
-            = [&encoder](const T &v) { encoder.add(v); };
-    elias_fano::merge_files(to_merge, on_new_item);
-    encoder.finish();
+    // merge disjoint key ranges in parallel and join the merged segments
+    std::vector<std::string> segments = elias_fano::merge_files_parallel<T>(
+            to_merge, out_file, num_threads, true, ENCODER_BUFFER_SIZE);
+    elias_fano::concat(segments, out_file);
     logger->trace("Merging all {} chunks into {} of size {:.0f} MB done",
                   to_merge.size(), out_file, elias_fano::chunk_size(out_file) / 1e6);
 }
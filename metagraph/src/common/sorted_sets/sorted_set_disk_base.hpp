@@ -211,7 +211,8 @@ class SortedSetDiskBase {
                                     size_t num_blocks);
 
     static void merge_all(const std::string &out_file,
-                          const std::vector<std::string> &to_merge);
+                          const std::vector<std::string> &to_merge,
+                          size_t num_threads);
 
     std::vector<std::string> get_file_names();
 };
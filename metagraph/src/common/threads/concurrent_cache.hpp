@@ -0,0 +1,138 @@
+#ifndef __CONCURRENT_CACHE_HPP__
+#define __CONCURRENT_CACHE_HPP__
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+
+namespace mtg {
+namespace common {
+
+/**
+ * A fixed-size direct-mapped cache which can be shared by many threads.
+ *
+ * Each key is mapped to a single slot storing the key, the value, and a version
+ * counter guarding them (seqlock). No operation ever takes a lock or waits:
+ *  - a lookup of a slot which is being written at the moment is a miss,
+ *  - an insertion into a slot which is being written by another thread is
+ *    dropped.
+ * A newly inserted key evicts the key previously stored in its slot.
+ */
+template <typename Key, typename Value, class Hash = std::hash<Key>>
+class ConcurrentCache {
+    // keys and values are copied to the slots word by word
+    static_assert(std::is_trivially_copy_constructible_v<Key>
+                    && std::is_trivially_destructible_v<Key>);
+    static_assert(std::is_trivially_copy_constructible_v<Value>
+                    && std::is_trivially_destructible_v<Value>);
+
+  public:
+    // The capacity is rounded up to the next power of two
+    explicit ConcurrentCache(size_t capacity = 1) {
+        size_t num_slots = 1;
+        while (num_slots < capacity) {
+            num_slots *= 2;
+        }
+        mask_ = num_slots - 1;
+        slots_.reset(new Slot[num_slots]);
+    }
+
+    std::optional<Value> TryGet(const Key &key) const {
+        const Slot &slot = get_slot(key);
+
+        uint64_t version = slot.version.load(std::memory_order_acquire);
+        // the slot is empty or being written
+        if (!version || (version & 1)) {
+            num_misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        uint64_t words[kNumWords];
+        for (size_t i = 0; i < kNumWords; ++i) {
+            words[i] = slot.words[i].load(std::memory_order_relaxed);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        Word key_words[kKeyWords] = {};
+        std::memcpy(key_words, &key, sizeof(Key));
+
+        if (slot.version.load(std::memory_order_relaxed) != version
+                || std::memcmp(words, key_words, sizeof(key_words))) {
+            num_misses_.fetch_add(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        num_hits_.fetch_add(1, std::memory_order_relaxed);
+
+        Value value;
+        std::memcpy(&value, words + kKeyWords, sizeof(Value));
+        return value;
+    }
+
+    void Put(const Key &key, const Value &value) {
+        Slot &slot = get_slot(key);
+
+        uint64_t version = slot.version.load(std::memory_order_relaxed);
+        // skip if another thread is writing to this slot
+        if ((version & 1) || !slot.version.compare_exchange_strong(
+                                    version, version + 1,
+                                    std::memory_order_relaxed)) {
+            return;
+        }
+
+        std::atomic_thread_fence(std::memory_order_release);
+
+        Word words[kNumWords] = {};
+        std::memcpy(words, &key, sizeof(Key));
+        std::memcpy(words + kKeyWords, &value, sizeof(Value));
+
+        for (size_t i = 0; i < kNumWords; ++i) {
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        }
+
+        slot.version.store(version + 2, std::memory_order_release);
+    }
+
+    size_t capacity() const { return mask_ + 1; }
+
+    uint64_t num_hits() const { return num_hits_.load(std::memory_order_relaxed); }
+    uint64_t num_misses() const { return num_misses_.load(std::memory_order_relaxed); }
+
+  private:
+    typedef uint64_t Word;
+
+    static constexpr size_t kKeyWords = (sizeof(Key) + sizeof(Word) - 1) / sizeof(Word);
+    static constexpr size_t kValueWords = (sizeof(Value) + sizeof(Word) - 1) / sizeof(Word);
+    static constexpr size_t kNumWords = kKeyWords + kValueWords;
+
+    struct Slot {
+        // even if the slot is stable, odd if it's being written, zero if empty
+        std::atomic<uint64_t> version { 0 };
+        std::atomic<Word> words[kNumWords] = {};
+    };
+
+    Slot& get_slot(const Key &key) const {
+        // Fibonacci hashing spreads consecutive keys across the slots
+        uint64_t hash = static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull;
+        return slots_[(hash >> 32) & mask_];
+    }
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+
+    // keep the counters on separate cache lines
+    alignas(64) mutable std::atomic<uint64_t> num_hits_ { 0 };
+    alignas(64) mutable std::atomic<uint64_t> num_misses_ { 0 };
+};
+
+} // namespace common
+} // namespace mtg
+
+#endif // __CONCURRENT_CACHE_HPP__
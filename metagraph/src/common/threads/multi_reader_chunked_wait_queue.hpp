@@ -0,0 +1,282 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "chunked_wait_queue.hpp"
+
+namespace mtg {
+namespace common {
+
+/**
+ * A MultiReaderChunkedWaitQueue transfers data from a single writer thread to a fixed
+ * number of reader threads. Unlike #ChunkedWaitQueue, which has a single iterator,
+ * the elements are handed out to the readers in chunks, which are read in place from
+ * the internal circular buffer, without copying.
+ *
+ * The queue supports two modes:
+ *  1. BROADCAST: every reader consumes the full stream through its own cursor. A chunk
+ *  is recycled only after all readers have moved past it, so the slowest reader
+ *  throttles the writer.
+ *  2. PARTITION: each chunk is consumed by exactly one reader, i.e. the readers
+ *  process disjoint chunks of the stream in parallel. The index of a chunk in the
+ *  stream is available through Reader::chunk_index().
+ *
+ * Readers are created with #reader(), exactly num_readers of them must be created
+ * (otherwise the writer may block forever in BROADCAST mode). A reader that is
+ * destroyed before reaching the end of the stream releases all its pending chunks.
+ * The readers must be destroyed before the queue.
+ *
+ * The writer will block if all chunks of the buffer are in use. The readers will
+ * block if there is no chunk available. When the queue is shut down, the readers
+ * unblock after consuming the remaining chunks.
+ */
+template <typename T, typename Alloc = std::allocator<T>>
+class MultiReaderChunkedWaitQueue {
+  public:
+    enum Mode { BROADCAST, PARTITION };
+
+    typedef std::vector<T, Alloc> Chunk;
+    typedef T value_type;
+
+    class Reader;
+
+    MultiReaderChunkedWaitQueue(const MultiReaderChunkedWaitQueue &) = delete;
+    MultiReaderChunkedWaitQueue &operator=(const MultiReaderChunkedWaitQueue &) = delete;
+
+    /**
+     * Constructs a queue with the given size parameters.
+     * @param num_readers the number of readers consuming the queue
+     * @param buffer_size the total number of elements buffered in the queue
+     * @param mode BROADCAST to pass every element to all readers, PARTITION to pass
+     * each chunk to only one reader
+     */
+    MultiReaderChunkedWaitQueue(size_t num_readers, size_t buffer_size, Mode mode = BROADCAST)
+          : mode_(mode),
+            num_readers_(num_readers),
+            active_readers_(num_readers),
+            // each reader holds one chunk while the writer fills another one
+            chunk_size_(std::max(size_t(1),
+                                 std::min(ChunkedWaitQueue<T, Alloc>::WRITE_BUF_SIZE,
+                                          buffer_size / (num_readers + 2)))),
+            chunks_(std::max(num_readers + 2, buffer_size / chunk_size_)),
+            pending_reads_(chunks_.size(), 0) {
+        assert(num_readers);
+        for (Chunk &chunk : chunks_) {
+            chunk.reserve(chunk_size_);
+        }
+    }
+
+    /** Shuts down the queue. All readers must be destroyed before the queue. */
+    ~MultiReaderChunkedWaitQueue() {
+        shutdown();
+        assert(active_readers_ + num_created_readers_ == num_readers_);
+    }
+
+    /** Returns the number of elements in a chunk */
+    size_t chunk_size() const { return chunk_size_; }
+
+    Mode mode() const { return mode_; }
+
+    /**
+     * Creates a new reader. Must be called exactly num_readers times.
+     * In BROADCAST mode, all readers start from the first element, no matter how
+     * late they are created.
+     */
+    Reader reader() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        assert(num_created_readers_ < num_readers_);
+        num_created_readers_++;
+        return Reader(this);
+    }
+
+    /**
+     * Enqueues x by *moving* it into the queue, blocks when full.
+     */
+    void push(value_type&& x) {
+        if (!write_chunk_)
+            acquire_write_chunk();
+
+        write_chunk_->push_back(std::move(x));
+        if (write_chunk_->size() == chunk_size_)
+            publish();
+    }
+
+    /**
+     * Pushes x into the queue, blocks when full.
+     */
+    void push(const value_type &x) {
+        if (!write_chunk_)
+            acquire_write_chunk();
+
+        write_chunk_->push_back(x);
+        if (write_chunk_->size() == chunk_size_)
+            publish();
+    }
+
+    /**
+     * Closes the queue and notifies the blocked readers.
+     */
+    void shutdown() {
+        if (write_chunk_ && write_chunk_->size())
+            publish();
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        is_shutdown_ = true;
+        chunk_ready_.notify_all();
+    }
+
+  private:
+    const Mode mode_;
+    const size_t num_readers_;
+    size_t num_created_readers_ = 0;
+    // readers that are still consuming chunks
+    size_t active_readers_;
+
+    const size_t chunk_size_;
+    std::vector<Chunk> chunks_;
+    // the number of reads left before the chunk can be recycled
+    std::vector<size_t> pending_reads_;
+
+    // the chunk currently filled by the writer
+    Chunk *write_chunk_ = NULL;
+    // total number of chunks made available to the readers
+    uint64_t num_published_ = 0;
+    // the next chunk to be claimed by a reader in PARTITION mode
+    uint64_t next_claim_ = 0;
+
+    bool is_shutdown_ = false;
+
+    std::mutex mutex_;
+    // signals that a new chunk was published or that the queue was shut down
+    std::condition_variable chunk_ready_;
+    // signals that a chunk was released by all its readers
+    std::condition_variable chunk_released_;
+
+    static constexpr uint64_t NONE = -1;
+
+    Chunk& get_chunk(uint64_t index) { return chunks_[index % chunks_.size()]; }
+
+    void acquire_write_chunk() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        assert(!is_shutdown_ && "Pushing to a queue that was shut down");
+        const size_t slot = num_published_ % chunks_.size();
+        chunk_released_.wait(lock, [&]() { return !pending_reads_[slot]; });
+        write_chunk_ = &chunks_[slot];
+        write_chunk_->clear();
+    }
+
+    void publish() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        pending_reads_[num_published_ % chunks_.size()]
+                = mode_ == BROADCAST ? active_readers_ : std::min(active_readers_, size_t(1));
+        num_published_++;
+        write_chunk_ = NULL;
+        chunk_ready_.notify_all();
+    }
+
+    // the caller must hold the mutex
+    void release(uint64_t index) {
+        const size_t slot = index % chunks_.size();
+        assert(pending_reads_[slot]);
+        if (!--pending_reads_[slot])
+            chunk_released_.notify_one();
+    }
+
+    const Chunk* next_chunk(Reader *reader) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (reader->current_ != NONE) {
+            release(reader->current_);
+            reader->current_ = NONE;
+        }
+
+        uint64_t &next = mode_ == BROADCAST ? reader->next_ : next_claim_;
+        chunk_ready_.wait(lock, [&]() { return is_shutdown_ || next < num_published_; });
+        if (next == num_published_) {
+            assert(is_shutdown_);
+            return NULL;
+        }
+        reader->current_ = next++;
+        return &get_chunk(reader->current_);
+    }
+
+    void detach(Reader *reader) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (reader->current_ != NONE) {
+            release(reader->current_);
+            reader->current_ = NONE;
+        }
+        if (mode_ == BROADCAST) {
+            // release the chunks published but not read yet
+            for (uint64_t i = reader->next_; i < num_published_; ++i) {
+                release(i);
+            }
+            reader->next_ = num_published_;
+        } else if (active_readers_ == 1) {
+            // the last reader leaves, nobody will claim the remaining chunks
+            for ( ; next_claim_ < num_published_; ++next_claim_) {
+                release(next_claim_);
+            }
+        }
+        active_readers_--;
+    }
+};
+
+/**
+ * A cursor of a MultiReaderChunkedWaitQueue. Each reader should be used by a single
+ * thread.
+ */
+template <typename T, typename Alloc>
+class MultiReaderChunkedWaitQueue<T, Alloc>::Reader {
+    friend MultiReaderChunkedWaitQueue;
+
+  public:
+    Reader(const Reader &) = delete;
+    Reader &operator=(const Reader &) = delete;
+
+    Reader(Reader&& other)
+          : queue_(other.queue_), next_(other.next_), current_(other.current_) {
+        other.queue_ = NULL;
+    }
+
+    ~Reader() {
+        if (queue_)
+            queue_->detach(this);
+    }
+
+    /**
+     * Releases the chunk returned by the previous call and returns the next chunk,
+     * blocking until one is available. Returns NULL if the queue was shut down and
+     * there are no chunks left for this reader.
+     */
+    const Chunk* next_chunk() { return queue_->next_chunk(this); }
+
+    /** Index of the chunk in the stream returned by the last call to #next_chunk() */
+    uint64_t chunk_index() const { return current_; }
+
+    /** Calls |callback| for each element read by this reader */
+    template <class Callback>
+    void call_elements(const Callback &callback) {
+        while (const Chunk *chunk = next_chunk()) {
+            for (const T &value : *chunk) {
+                callback(value);
+            }
+        }
+    }
+
+  private:
+    explicit Reader(MultiReaderChunkedWaitQueue *queue) : queue_(queue) {}
+
+    MultiReaderChunkedWaitQueue *queue_;
+    // the next chunk to read in BROADCAST mode
+    uint64_t next_ = 0;
+    // the chunk held by this reader
+    uint64_t current_ = NONE;
+};
+
+} // namespace common
+} // namespace mtg
@@ -0,0 +1,151 @@
+#include "numa.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+#include "common/logger.hpp"
+
+
+namespace mtg {
+namespace common {
+
+#ifdef __linux__
+
+// Parse a list in the sysfs format, e.g., "0-11,24-35"
+static std::vector<size_t> parse_sysfs_list(const std::string &list) {
+    std::vector<size_t> result;
+
+    size_t pos = 0;
+    while (pos < list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos)
+            end = list.size();
+
+        std::string range = list.substr(pos, end - pos);
+        pos = end + 1;
+
+        if (range.empty() || !std::isdigit(range[0]))
+            continue;
+
+        size_t dash = range.find('-');
+        size_t first = std::stoull(range.substr(0, dash));
+        size_t last = dash == std::string::npos ? first : std::stoull(range.substr(dash + 1));
+        for (size_t i = first; i <= last; ++i) {
+            result.push_back(i);
+        }
+    }
+
+    return result;
+}
+
+static std::vector<size_t> read_sysfs_list(const std::string &path) {
+    std::ifstream in(path);
+    std::string list;
+    if (!std::getline(in, list))
+        return {};
+
+    return parse_sysfs_list(list);
+}
+
+// ids of the NUMA nodes online
+static const std::vector<size_t>& get_numa_node_ids() {
+    static const std::vector<size_t> node_ids
+        = read_sysfs_list("/sys/devices/system/node/online");
+    return node_ids;
+}
+
+size_t get_num_numa_nodes() {
+    return std::max(get_numa_node_ids().size(), size_t(1));
+}
+
+std::vector<size_t> get_numa_node_cpus(size_t node) {
+    const auto &node_ids = get_numa_node_ids();
+    if (node >= node_ids.size())
+        return {};
+
+    return read_sysfs_list("/sys/devices/system/node/node"
+                                + std::to_string(node_ids[node]) + "/cpulist");
+}
+
+bool pin_thread_to_numa_node(size_t node) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    bool any = false;
+    for (size_t cpu : get_numa_node_cpus(node)) {
+        if (cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &cpu_set);
+            any = true;
+        }
+    }
+
+    // pid 0 refers to the calling thread
+    return any && !sched_setaffinity(0, sizeof(cpu_set), &cpu_set);
+}
+
+NumaInterleaveScope::NumaInterleaveScope(bool enable) {
+    const auto &node_ids = get_numa_node_ids();
+    if (!enable || node_ids.size() < 2)
+        return;
+
+    // bitmask of nodes, 1024 nodes at most
+    constexpr size_t kWordBits = 8 * sizeof(unsigned long);
+    unsigned long mask[1024 / kWordBits] = {};
+    for (size_t id : node_ids) {
+        if (id < 1024)
+            mask[id / kWordBits] |= 1UL << (id % kWordBits);
+    }
+
+    // as in libnuma, pass the number of bits + 1 (the kernel ignores the last one)
+    if (syscall(SYS_set_mempolicy, MPOL_INTERLEAVE, mask, 1024 + 1)) {
+        logger->warn("Failed to interleave memory across {} NUMA nodes", node_ids.size());
+        return;
+    }
+
+    logger->trace("Interleaving memory across {} NUMA nodes", node_ids.size());
+    active_ = true;
+}
+
+NumaInterleaveScope::~NumaInterleaveScope() {
+    if (active_)
+        syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+}
+
+#else
+
+size_t get_num_numa_nodes() { return 1; }
+
+std::vector<size_t> get_numa_node_cpus(size_t) { return {}; }
+
+bool pin_thread_to_numa_node(size_t) { return false; }
+
+NumaInterleaveScope::NumaInterleaveScope(bool) {}
+
+NumaInterleaveScope::~NumaInterleaveScope() {}
+
+#endif // __linux__
+
+void pin_thread_to_next_numa_node() {
+    static std::atomic<size_t> next_node { 0 };
+    thread_local bool pinned = false;
+
+    if (pinned)
+        return;
+
+    pinned = true;
+
+    if (get_num_numa_nodes() > 1)
+        pin_thread_to_numa_node(next_node++ % get_num_numa_nodes());
+}
+
+} // namespace common
+} // namespace mtg
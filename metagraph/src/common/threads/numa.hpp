@@ -0,0 +1,59 @@
+#ifndef __NUMA_HPP__
+#define __NUMA_HPP__
+
+#include <cstddef>
+#include <vector>
+
+
+namespace mtg {
+namespace common {
+
+/**
+ * Helpers for placing memory and threads on multi-socket (NUMA) machines.
+ * The NUMA topology is read from /sys/devices/system/node and the policies
+ * are set with the raw Linux system calls, so no libnuma is required.
+ * On other platforms, the machine is treated as a single NUMA node and all
+ * the calls have no effect.
+ */
+
+// Number of NUMA nodes online, 1 for non-NUMA machines
+size_t get_num_numa_nodes();
+
+// CPUs of the NUMA node |node|
+std::vector<size_t> get_numa_node_cpus(size_t node);
+
+// Pin the calling thread to the CPUs of the NUMA node |node|.
+// Return false if the thread could not be pinned.
+bool pin_thread_to_numa_node(size_t node);
+
+// Pin the calling thread to a NUMA node, distributing the threads calling
+// this function across all nodes in a round-robin fashion. A thread is
+// pinned only on its first call, the subsequent calls have no effect.
+void pin_thread_to_next_numa_node();
+
+
+/**
+ * While in scope, the pages allocated by the calling thread are interleaved
+ * across all NUMA nodes, so that the random accesses to large data structures
+ * loaded by this thread (e.g., BOSS tables or annotation matrices) are evenly
+ * spread over the memory controllers of all sockets.
+ * The default allocation policy is restored on destruction.
+ */
+class NumaInterleaveScope {
+  public:
+    explicit NumaInterleaveScope(bool enable = true);
+    ~NumaInterleaveScope();
+
+    NumaInterleaveScope(const NumaInterleaveScope &) = delete;
+    NumaInterleaveScope& operator=(const NumaInterleaveScope &) = delete;
+
+    bool is_active() const { return active_; }
+
+  private:
+    bool active_ = false;
+};
+
+} // namespace common
+} // namespace mtg
+
+#endif // __NUMA_HPP__
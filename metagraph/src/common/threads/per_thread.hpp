@@ -0,0 +1,102 @@
+#ifndef __PER_THREAD_HPP__
+#define __PER_THREAD_HPP__
+
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace mtg {
+namespace common {
+
+/**
+ * Storage with a separate instance of T for each thread calling #local().
+ * Graph traversals call their callbacks on threads of both OpenMP teams and
+ * thread pools, so the instances are indexed by the ids of the calling threads
+ * rather than by OpenMP thread numbers. The last instance accessed by each
+ * thread is cached, so switching between several objects only costs a lookup.
+ */
+template <typename T>
+class PerThread {
+  public:
+    PerThread() : id_(next_id_++) {}
+
+    T& local() {
+        thread_local std::pair<uint64_t, T*> cached { 0, nullptr };
+        if (cached.first != id_) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            // the references to the elements stay valid on insertion
+            cached = { id_, &instances_[std::this_thread::get_id()] };
+        }
+        return *cached.second;
+    }
+
+    // must not be called concurrently with #local()
+    template <class Callback>
+    void for_each(const Callback &callback) {
+        for (auto &[thread_id, instance] : instances_) {
+            callback(instance);
+        }
+    }
+
+  private:
+    static inline std::atomic<uint64_t> next_id_ { 1 };
+
+    const uint64_t id_;
+    std::unordered_map<std::thread::id, T> instances_;
+    std::mutex mutex_;
+};
+
+/**
+ * Accumulates values (e.g., sequences) in per-thread buffers and passes them
+ * in batches of about |buffer_size| bytes to |write_batch|, which is called
+ * under a lock. The remaining buffers are flushed on destruction.
+ */
+template <typename T>
+class BufferedSequenceWriter {
+  public:
+    BufferedSequenceWriter(const std::function<void(std::vector<T>&&)> &write_batch,
+                           uint64_t buffer_size = 1'000'000)
+          : write_batch_(write_batch), buffer_size_(buffer_size) {}
+
+    ~BufferedSequenceWriter() {
+        buffers_.for_each([&](Buffer &buffer) {
+            if (buffer.data.size())
+                write_batch_(std::move(buffer.data));
+        });
+    }
+
+    void write(T&& value, uint64_t num_bytes) {
+        Buffer &buffer = buffers_.local();
+        buffer.data.push_back(std::move(value));
+        buffer.num_bytes += num_bytes;
+
+        if (buffer.num_bytes >= buffer_size_) {
+            std::lock_guard<std::mutex> lock(write_mutex_);
+            write_batch_(std::move(buffer.data));
+            buffer.data.clear();
+            buffer.num_bytes = 0;
+        }
+    }
+
+  private:
+    struct Buffer {
+        std::vector<T> data;
+        uint64_t num_bytes = 0;
+    };
+
+    std::function<void(std::vector<T>&&)> write_batch_;
+    const uint64_t buffer_size_;
+    PerThread<Buffer> buffers_;
+    std::mutex write_mutex_;
+};
+
+} // namespace common
+} // namespace mtg
+
+#endif // __PER_THREAD_HPP__
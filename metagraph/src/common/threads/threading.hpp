@@ -1,6 +1,7 @@
 #ifndef __THREADING_HPP__
 #define __THREADING_HPP__
 
+#include <algorithm>
 #include <vector>
 #include <queue>
 #include <thread>
@@ -89,6 +90,35 @@ class ThreadPool {
 };
 
 
+/**
+ * A queue of I/O tasks (e.g., reading or writing blocks of data), which are
+ * executed asynchronously on a dedicated thread in the order of submission.
+ * Up to |depth| tasks can wait in the queue, so the caller may run |depth|
+ * blocks ahead of the writes (write-behind) or prefetch |depth| blocks ahead
+ * of the computation (read-ahead). Submitting a task blocks while the queue is
+ * full, which bounds the memory taken by the blocks owned by pending tasks.
+ */
+class AsyncIOQueue {
+  public:
+    explicit AsyncIOQueue(size_t depth = 1)
+          : depth_(std::max(depth, size_t(1))), pool_(1, depth_) {}
+
+    size_t depth() const { return depth_; }
+
+    template <class F, typename... Args>
+    auto submit(F&& f, Args&&... args) {
+        return pool_.enqueue(std::forward<F>(f), std::forward<Args>(args)...);
+    }
+
+    // wait until all submitted tasks are executed
+    void wait() { pool_.join(); }
+
+  private:
+    size_t depth_;
+    ThreadPool pool_;
+};
+
+
 class AsyncActivity {
   public:
     template <class F, typename... Args>
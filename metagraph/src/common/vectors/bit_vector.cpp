@@ -7,6 +7,7 @@
 #include "bit_vector_sdsl.hpp"
 #include "bit_vector_dyn.hpp"
 #include "bit_vector_sd.hpp"
+#include "bit_vector_cl.hpp"
 #include "vector_algorithm.hpp"
 
 
@@ -60,6 +61,7 @@ template bit_vector_rrr<31> bit_vector::convert_to<bit_vector_rrr<31>>();
 template bit_vector_rrr<63> bit_vector::convert_to<bit_vector_rrr<63>>();
 template bit_vector_rrr<127> bit_vector::convert_to<bit_vector_rrr<127>>();
 template bit_vector_rrr<255> bit_vector::convert_to<bit_vector_rrr<255>>();
+template bit_vector_cl bit_vector::convert_to<bit_vector_cl>();
 template sdsl::bit_vector bit_vector::convert_to<sdsl::bit_vector>();
 template<> bit_vector_small bit_vector::convert_to() {
     return bit_vector_small(std::move(*this));
@@ -115,6 +117,7 @@ template bit_vector_rrr<31> bit_vector::copy_to<bit_vector_rrr<31>>() const;
 template bit_vector_rrr<63> bit_vector::copy_to<bit_vector_rrr<63>>() const;
 template bit_vector_rrr<127> bit_vector::copy_to<bit_vector_rrr<127>>() const;
 template bit_vector_rrr<255> bit_vector::copy_to<bit_vector_rrr<255>>() const;
+template bit_vector_cl bit_vector::copy_to<bit_vector_cl>() const;
 template sdsl::bit_vector bit_vector::copy_to<sdsl::bit_vector>() const;
 template<> bit_vector_small bit_vector::copy_to() const {
     return bit_vector_small(*this);
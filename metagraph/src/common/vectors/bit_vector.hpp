@@ -1,6 +1,7 @@
 #ifndef __BIT_VECTOR_HPP__
 #define __BIT_VECTOR_HPP__
 
+#include <cassert>
 #include <cstdint>
 
 #include <sdsl/int_vector.hpp>
@@ -38,6 +39,30 @@ class bit_vector : public bitmap {
     virtual uint64_t next1(uint64_t id) const = 0;
     virtual uint64_t prev1(uint64_t id) const = 0;
 
+    /**
+     * Batch queries for the indexes ids[0], ..., ids[size - 1], the same as
+     * calling the single queries in a loop. The batch is resolved with a single
+     * virtual call, after which the concrete implementations dispatch the
+     * single queries statically. If the indexes are sorted, the queries falling
+     * into the same word are answered from that word.
+     * The output arrays must not overlap with |ids|.
+     */
+    virtual void get_many(const uint64_t *ids, size_t size, bool *bits) const {
+        get_many_impl(*this, ids, size, bits);
+    }
+    virtual void rank1_many(const uint64_t *ids, size_t size, uint64_t *ranks) const {
+        rank1_many_impl(*this, ids, size, ranks);
+    }
+    virtual void conditional_rank1_many(const uint64_t *ids, size_t size,
+                                        uint64_t *ranks) const {
+        conditional_rank1_many_impl(*this, ids, size, ranks);
+    }
+    // |ids| are the ranks of the set bits, starting from 1
+    virtual void select1_many(const uint64_t *ids, size_t size,
+                              uint64_t *positions) const {
+        select1_many_impl(*this, ids, size, positions);
+    }
+
     virtual bool operator[](uint64_t id) const override = 0;
     virtual uint64_t get_int(uint64_t id, uint32_t width) const override = 0;
 
@@ -78,6 +103,23 @@ class bit_vector : public bitmap {
     virtual sdsl::bit_vector to_vector() const = 0;
 
   protected:
+    // Implementations of the batch queries. For final classes |Vector|,
+    // the single queries called from them are not virtual.
+    template <class Vector>
+    static inline void get_many_impl(const Vector &vector,
+                                     const uint64_t *ids, size_t size, bool *bits);
+    template <class Vector>
+    static inline void rank1_many_impl(const Vector &vector,
+                                       const uint64_t *ids, size_t size, uint64_t *ranks);
+    template <class Vector>
+    static inline void conditional_rank1_many_impl(const Vector &vector,
+                                                   const uint64_t *ids, size_t size,
+                                                   uint64_t *ranks);
+    template <class Vector>
+    static inline void select1_many_impl(const Vector &vector,
+                                         const uint64_t *ids, size_t size,
+                                         uint64_t *positions);
+
     // routines using density-based adaptive iteration with select and access
     void call_ones_adaptive(uint64_t begin, uint64_t end,
                             const VoidCall<uint64_t> &callback,
@@ -91,4 +133,97 @@ class bit_vector : public bitmap {
 
 std::ostream& operator<<(std::ostream &os, const bit_vector &bv);
 
+
+// The positions ids[i], ids[i + 1], ..., ids[j - 1] in the word starting at ids[i]
+// are queried at once if there are at least this many of them. We assume that
+// get_int is roughly that many times slower than operator[].
+const size_t kMinBatchQueriesPerWord = 5;
+
+// Call |callback(i, j, word)| for the maximal runs of indexes ids[i], ..., ids[j - 1]
+// falling into the word starting at ids[i], if they are at least
+// kMinBatchQueriesPerWord, and |callback(i, i + 1, 0)| for the other indexes
+// (with the word not loaded).
+template <class Vector, class Callback>
+inline void call_batch_words(const Vector &vector, const uint64_t *ids, size_t size,
+                             const Callback &callback) {
+    for (size_t i = 0; i < size; ) {
+        assert(ids[i] < vector.size());
+
+        const uint64_t offset = ids[i];
+
+        if (i + kMinBatchQueriesPerWord - 1 < size
+                && ids[i + kMinBatchQueriesPerWord - 1] >= offset
+                && ids[i + kMinBatchQueriesPerWord - 1] < offset + 64
+                && offset + 64 <= vector.size()) {
+            size_t j = i + 1;
+            while (j < size && ids[j] >= offset && ids[j] < offset + 64) {
+                ++j;
+            }
+            callback(i, j, vector.get_int(offset, 64));
+            i = j;
+        } else {
+            callback(i, i + 1, 0);
+            ++i;
+        }
+    }
+}
+
+template <class Vector>
+void bit_vector::get_many_impl(const Vector &vector,
+                               const uint64_t *ids, size_t size, bool *bits) {
+    call_batch_words(vector, ids, size, [&](size_t i, size_t j, uint64_t word) {
+        if (j == i + 1) {
+            bits[i] = vector[ids[i]];
+            return;
+        }
+        const uint64_t offset = ids[i];
+        for (; i < j; ++i) {
+            bits[i] = (word >> (ids[i] - offset)) & 1;
+        }
+    });
+}
+
+template <class Vector>
+void bit_vector::rank1_many_impl(const Vector &vector,
+                                 const uint64_t *ids, size_t size, uint64_t *ranks) {
+    for (size_t i = 0; i < size; ++i) {
+        ranks[i] = vector.rank1(ids[i]);
+    }
+}
+
+template <class Vector>
+void bit_vector::conditional_rank1_many_impl(const Vector &vector,
+                                             const uint64_t *ids, size_t size,
+                                             uint64_t *ranks) {
+    call_batch_words(vector, ids, size, [&](size_t i, size_t j, uint64_t word) {
+        if (j == i + 1) {
+            ranks[i] = vector.conditional_rank1(ids[i]);
+            return;
+        }
+        const uint64_t offset = ids[i];
+        // the rank is only computed if at least one bit is set
+        uint64_t rank = -1ULL;
+        for (; i < j; ++i) {
+            const uint64_t shift = ids[i] - offset;
+            if (!((word >> shift) & 1)) {
+                ranks[i] = 0;
+                continue;
+            }
+            if (rank == -1ULL)
+                rank = offset ? vector.rank1(offset - 1) : 0;
+
+            ranks[i] = rank + sdsl::bits::cnt(word & sdsl::bits::lo_set[shift + 1]);
+        }
+    });
+}
+
+template <class Vector>
+void bit_vector::select1_many_impl(const Vector &vector,
+                                   const uint64_t *ids, size_t size,
+                                   uint64_t *positions) {
+    for (size_t i = 0; i < size; ++i) {
+        positions[i] = vector.select1(ids[i]);
+    }
+}
+
 #endif // __BIT_VECTOR_HPP__
@@ -5,6 +5,7 @@
 
 #include "bit_vector_sdsl.hpp"
 #include "bit_vector_sd.hpp"
+#include "bit_vector_cl.hpp"
 
 
 class bit_vector_adaptive : public bit_vector {
@@ -26,6 +27,24 @@ class bit_vector_adaptive : public bit_vector {
     virtual uint64_t next1(uint64_t id) const override final { return vector_->next1(id); }
     virtual uint64_t prev1(uint64_t id) const override final { return vector_->prev1(id); }
 
+    // forward the entire batch to avoid a virtual call per query
+    virtual void get_many(const uint64_t *ids, size_t size,
+                          bool *bits) const override final {
+        vector_->get_many(ids, size, bits);
+    }
+    virtual void rank1_many(const uint64_t *ids, size_t size,
+                            uint64_t *ranks) const override final {
+        vector_->rank1_many(ids, size, ranks);
+    }
+    virtual void conditional_rank1_many(const uint64_t *ids, size_t size,
+                                        uint64_t *ranks) const override final {
+        vector_->conditional_rank1_many(ids, size, ranks);
+    }
+    virtual void select1_many(const uint64_t *ids, size_t size,
+                              uint64_t *positions) const override final {
+        vector_->select1_many(ids, size, positions);
+    }
+
     virtual bool operator[](uint64_t id) const override final { return (*vector_)[id]; }
     virtual uint64_t get_int(uint64_t id, uint32_t width) const override final {
         return vector_->get_int(id, width);
@@ -52,7 +71,8 @@ class bit_vector_adaptive : public bit_vector {
         RRR_VECTOR = 0,
         SD_VECTOR,
         STAT_VECTOR,
-        IL4096_VECTOR
+        IL4096_VECTOR,
+        CL_VECTOR
     };
 
     typedef VectorCode (*DefineRepresentation)(uint64_t /* size */,
@@ -97,6 +117,9 @@ bit_vector_adaptive::representation_tag() const {
     } else if (dynamic_cast<const bit_vector_il<4096>*>(vector_.get())) {
         return VectorCode::IL4096_VECTOR;
 
+    } else if (dynamic_cast<const bit_vector_cl*>(vector_.get())) {
+        return VectorCode::CL_VECTOR;
+
     } else {
         throw std::runtime_error("Unsupported type");
     }
@@ -116,6 +139,9 @@ bool bit_vector_adaptive::load(std::istream &in) {
         case VectorCode::IL4096_VECTOR:
             vector_.reset(new bit_vector_il<4096>());
             break;
+        case VectorCode::CL_VECTOR:
+            vector_.reset(new bit_vector_cl());
+            break;
         default:
             return false;
     }
@@ -183,6 +209,9 @@ bit_vector_adaptive_stat<optimal_representation>
         case IL4096_VECTOR:
             vector_.reset(new bit_vector_il<4096>(size, value));
             break;
+        case CL_VECTOR:
+            vector_.reset(new bit_vector_cl(size, value));
+            break;
     }
 }
 
@@ -202,6 +231,9 @@ bit_vector_adaptive_stat<optimal_representation>
         case IL4096_VECTOR:
             vector_.reset(new bit_vector_il<4096>(vector.copy_to<bit_vector_il<4096>>()));
             break;
+        case CL_VECTOR:
+            vector_.reset(new bit_vector_cl(vector.copy_to<bit_vector_cl>()));
+            break;
     }
 }
 
@@ -223,6 +255,9 @@ bit_vector_adaptive_stat<optimal_representation>
         case IL4096_VECTOR:
             vector_.reset(new bit_vector_il<4096>(vector));
             break;
+        case CL_VECTOR:
+            vector_.reset(new bit_vector_cl(vector));
+            break;
     }
 }
 
@@ -242,6 +277,9 @@ bit_vector_adaptive_stat<optimal_representation>
         case IL4096_VECTOR:
             vector_.reset(new bit_vector_il<4096>(vector.convert_to<bit_vector_il<4096>>()));
             break;
+        case CL_VECTOR:
+            vector_.reset(new bit_vector_cl(vector.convert_to<bit_vector_cl>()));
+            break;
     }
 }
 
@@ -263,6 +301,9 @@ bit_vector_adaptive_stat<optimal_representation>
         case IL4096_VECTOR:
             vector_.reset(new bit_vector_il<4096>(std::move(vector)));
             break;
+        case CL_VECTOR:
+            vector_.reset(new bit_vector_cl(vector));
+            break;
     }
 }
 
@@ -294,6 +335,12 @@ bit_vector_adaptive_stat<optimal_representation>
             vector_.reset(new bit_vector_il<4096>(std::move(vector)));
             break;
         }
+        case CL_VECTOR: {
+            sdsl::bit_vector vector(size, false);
+            call_ones([&](uint64_t i) { vector[i] = true; });
+            vector_.reset(new bit_vector_cl(vector));
+            break;
+        }
     }
 }
 
@@ -366,15 +413,16 @@ typedef bit_vector_adaptive_stat<smart_representation> bit_vector_smart;
  * combines:
  *    - bit_vector_sd
  *    - bit_vector_rrr<63>
- *    - bit_vector_il<4096>
+ *    - bit_vector_cl
  */
 inline bit_vector_adaptive::VectorCode
 smallrank_representation(uint64_t size, uint64_t num_set_bits) {
     assert(num_set_bits <= size);
 
-    // use bit_vector_il<4096> if density is between (0.3, 0.7)
+    // use bit_vector_cl if density is between (0.3, 0.7), where the
+    // compressed vectors don't save much space but are much slower
     if (std::min(num_set_bits, size - num_set_bits) > size * 0.3)
-        return bit_vector_adaptive::VectorCode::IL4096_VECTOR;
+        return bit_vector_adaptive::VectorCode::CL_VECTOR;
 
     return bit_vector_sd::predict_size(size, num_set_bits)
             < bit_vector_rrr<>::predict_size(size, num_set_bits)
@@ -398,6 +446,8 @@ bit_vector_adaptive_stat<optimal_representation>
             return bit_vector_stat::predict_size(size, num_set_bits);
         case IL4096_VECTOR:
             return bit_vector_il<4096>::predict_size(size, num_set_bits);
+        case CL_VECTOR:
+            return bit_vector_cl::predict_size(size, num_set_bits);
         default:
             assert(false);
             return 0;
@@ -0,0 +1,423 @@
+#ifndef __BIT_VECTOR_CL_HPP__
+#define __BIT_VECTOR_CL_HPP__
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
+#include <sdsl/int_vector.hpp>
+
+#include "common/serialization.hpp"
+#include "bit_vector.hpp"
+
+
+/**
+ * Uncompressed bit vector with rank and select support laid out for cache
+ * efficiency. The bits are stored in 64-byte cache lines, each starting with
+ * the number of set bits in all previous lines, followed by 7 words (448 bits)
+ * of data. Thus, rank and access queries touch a single cache line.
+ * For select, the lines containing every kSelectSampleRate-th set (unset) bit
+ * are sampled. The line containing the queried bit is found by a short search
+ * over the line counters between two samples and the bit within a word is
+ * found with pdep (BMI2).
+ * The space overhead is ~16% of the size of the plain bit vector.
+ */
+class bit_vector_cl final : public bit_vector {
+  public:
+    explicit bit_vector_cl(uint64_t size = 0, bool value = false)
+      : bit_vector_cl(sdsl::bit_vector(size, value)) {}
+    inline explicit bit_vector_cl(const sdsl::bit_vector &vector);
+    bit_vector_cl(std::initializer_list<bool> init)
+      : bit_vector_cl(sdsl::bit_vector(init)) {}
+
+    std::unique_ptr<bit_vector> copy() const override {
+        return std::make_unique<bit_vector_cl>(*this);
+    }
+
+    inline uint64_t rank1(uint64_t id) const override;
+    inline uint64_t select0(uint64_t id) const override;
+    inline uint64_t select1(uint64_t id) const override;
+    inline std::pair<bool, uint64_t> inverse_select(uint64_t id) const override;
+    inline uint64_t conditional_rank1(uint64_t id) const override;
+
+    inline uint64_t next1(uint64_t id) const override;
+    inline uint64_t prev1(uint64_t id) const override;
+
+    void get_many(const uint64_t *ids, size_t size, bool *bits) const override {
+        get_many_impl(*this, ids, size, bits);
+    }
+    void rank1_many(const uint64_t *ids, size_t size, uint64_t *ranks) const override {
+        rank1_many_impl(*this, ids, size, ranks);
+    }
+    void conditional_rank1_many(const uint64_t *ids, size_t size,
+                                uint64_t *ranks) const override {
+        conditional_rank1_many_impl(*this, ids, size, ranks);
+    }
+    void select1_many(const uint64_t *ids, size_t size,
+                      uint64_t *positions) const override {
+        select1_many_impl(*this, ids, size, positions);
+    }
+
+    inline bool operator[](uint64_t id) const override;
+    inline uint64_t get_int(uint64_t id, uint32_t width) const override;
+
+    inline bool load(std::istream &in) override;
+    inline void serialize(std::ostream &out) const override;
+
+    uint64_t size() const override { return size_; }
+    uint64_t num_set_bits() const override { return num_set_bits_; }
+
+    inline void call_ones_in_range(uint64_t begin, uint64_t end,
+                                   const VoidCall<uint64_t> &callback) const override;
+
+    inline void add_to(sdsl::bit_vector *other) const override;
+
+    inline sdsl::bit_vector to_vector() const override;
+
+    /**
+     * Predict space taken by the vector with given its parameters in bits.
+     */
+    static inline uint64_t predict_size(uint64_t size, uint64_t num_set_bits);
+
+  private:
+    static constexpr uint64_t kWordsPerLine = 7;
+    static constexpr uint64_t kBitsPerLine = kWordsPerLine * 64;
+    static constexpr uint64_t kSelectSampleRate = 4096;
+    // search the lines between two select samples linearly if there are
+    // at most this many of them
+    static constexpr uint64_t kMaxLinearSearch = 8;
+
+    struct alignas(64) Line {
+        // number of set bits in all previous lines
+        uint64_t rank;
+        uint64_t words[kWordsPerLine];
+    };
+    static_assert(sizeof(Line) == 64);
+
+    // the |w|-th word of the plain bit vector
+    uint64_t word(uint64_t w) const {
+        return lines_[w / kWordsPerLine].words[w % kWordsPerLine];
+    }
+
+    // number of unset bits in the lines preceding the |l|-th line
+    uint64_t rank0_line(uint64_t l) const {
+        return std::min(l * kBitsPerLine, size_) - lines_[l].rank;
+    }
+
+    // number of set bits in the first |k| words of the line
+    static uint64_t rank_words(const Line &line, uint64_t k) {
+        uint64_t rank = line.rank;
+        for (uint64_t j = 0; j < k; ++j) {
+            rank += sdsl::bits::cnt(line.words[j]);
+        }
+        return rank;
+    }
+
+    // the position of the |i|-th set bit in |word|, starting from 1
+    static uint64_t select_in_word(uint64_t word, uint64_t i) {
+        assert(i && i <= sdsl::bits::cnt(word));
+#ifdef __BMI2__
+        return __builtin_ctzll(_pdep_u64(1ULL << (i - 1), word));
+#else
+        return sdsl::bits::sel(word, i);
+#endif
+    }
+
+    // the last line |l| in [lo, hi] for which |is_before(l)| holds
+    template <class Predicate>
+    static uint64_t find_line(uint64_t lo, uint64_t hi, const Predicate &is_before) {
+        while (hi - lo > kMaxLinearSearch) {
+            uint64_t mid = lo + (hi - lo) / 2;
+            if (is_before(mid)) {
+                lo = mid;
+            } else {
+                hi = mid - 1;
+            }
+        }
+        while (lo < hi && is_before(lo + 1)) {
+            ++lo;
+        }
+        return lo;
+    }
+
+    inline void init_select();
+
+    // the last line is a sentinel storing the total number of set bits
+    std::vector<Line> lines_;
+    uint64_t size_ = 0;
+    uint64_t num_set_bits_ = 0;
+    // lines containing the (k * kSelectSampleRate + 1)-th set (unset) bits
+    std::vector<uint64_t> select1_samples_;
+    std::vector<uint64_t> select0_samples_;
+};
+
+
+bit_vector_cl::bit_vector_cl(const sdsl::bit_vector &vector) : size_(vector.size()) {
+    const uint64_t num_words = (size_ + 63) / 64;
+    lines_.resize((num_words + kWordsPerLine - 1) / kWordsPerLine + 1);
+
+    const uint64_t *data = vector.data();
+    for (uint64_t w = 0; w < num_words; ++w) {
+        Line &line = lines_[w / kWordsPerLine];
+        if (w % kWordsPerLine == 0)
+            line.rank = num_set_bits_;
+
+        uint64_t word = data[w];
+        // clear the bits past the end
+        if (w + 1 == num_words && (size_ & 63))
+            word &= sdsl::bits::lo_set[size_ & 63];
+
+        line.words[w % kWordsPerLine] = word;
+        num_set_bits_ += sdsl::bits::cnt(word);
+    }
+    lines_.back().rank = num_set_bits_;
+
+    init_select();
+}
+
+void bit_vector_cl::init_select() {
+    select1_samples_.clear();
+    select0_samples_.clear();
+
+    for (uint64_t l = 0; l + 1 < lines_.size(); ++l) {
+        while (select1_samples_.size() * kSelectSampleRate < lines_[l + 1].rank) {
+            select1_samples_.push_back(l);
+        }
+        while (select0_samples_.size() * kSelectSampleRate < rank0_line(l + 1)) {
+            select0_samples_.push_back(l);
+        }
+    }
+}
+
+uint64_t bit_vector_cl::rank1(uint64_t id) const {
+    if (id >= size_)
+        return num_set_bits_;
+
+    const uint64_t w = id >> 6;
+    const Line &line = lines_[w / kWordsPerLine];
+    const uint64_t k = w % kWordsPerLine;
+    return rank_words(line, k)
+            + sdsl::bits::cnt(line.words[k] & sdsl::bits::lo_set[(id & 63) + 1]);
+}
+
+uint64_t bit_vector_cl::conditional_rank1(uint64_t id) const {
+    assert(id < size_);
+
+    const uint64_t w = id >> 6;
+    const Line &line = lines_[w / kWordsPerLine];
+    const uint64_t k = w % kWordsPerLine;
+    if (!((line.words[k] >> (id & 63)) & 1))
+        return 0;
+
+    return rank_words(line, k)
+            + sdsl::bits::cnt(line.words[k] & sdsl::bits::lo_set[(id & 63) + 1]);
+}
+
+std::pair<bool, uint64_t> bit_vector_cl::inverse_select(uint64_t id) const {
+    assert(id < size_);
+
+    const uint64_t w = id >> 6;
+    const Line &line = lines_[w / kWordsPerLine];
+    const uint64_t k = w % kWordsPerLine;
+    return std::make_pair(
+        static_cast<bool>((line.words[k] >> (id & 63)) & 1),
+        rank_words(line, k)
+            + sdsl::bits::cnt(line.words[k] & sdsl::bits::lo_set[(id & 63) + 1])
+    );
+}
+
+uint64_t bit_vector_cl::select1(uint64_t id) const {
+    assert(id > 0 && size() > 0 && id <= num_set_bits());
+
+    const uint64_t s = (id - 1) / kSelectSampleRate;
+    const uint64_t l = find_line(
+        select1_samples_[s],
+        s + 1 < select1_samples_.size() ? select1_samples_[s + 1] : lines_.size() - 2,
+        [&](uint64_t l) { return lines_[l].rank < id; }
+    );
+
+    const Line &line = lines_[l];
+    id -= line.rank;
+    for (uint64_t k = 0; ; ++k) {
+        assert(k < kWordsPerLine);
+        uint64_t count = sdsl::bits::cnt(line.words[k]);
+        if (id <= count)
+            return l * kBitsPerLine + k * 64 + select_in_word(line.words[k], id);
+
+        id -= count;
+    }
+}
+
+uint64_t bit_vector_cl::select0(uint64_t id) const {
+    assert(id > 0 && size() > 0 && id <= size() - num_set_bits());
+
+    const uint64_t s = (id - 1) / kSelectSampleRate;
+    const uint64_t l = find_line(
+        select0_samples_[s],
+        s + 1 < select0_samples_.size() ? select0_samples_[s + 1] : lines_.size() - 2,
+        [&](uint64_t l) { return rank0_line(l) < id; }
+    );
+
+    const Line &line = lines_[l];
+    id -= rank0_line(l);
+    for (uint64_t k = 0; ; ++k) {
+        assert(k < kWordsPerLine);
+        // the padding bits past the end are never reached
+        uint64_t count = 64 - sdsl::bits::cnt(line.words[k]);
+        if (id <= count)
+            return l * kBitsPerLine + k * 64 + select_in_word(~line.words[k], id);
+
+        id -= count;
+    }
+}
+
+uint64_t bit_vector_cl::next1(uint64_t id) const {
+    assert(id < size_);
+
+    uint64_t w = id >> 6;
+    const uint64_t l = w / kWordsPerLine;
+    const Line &line = lines_[l];
+
+    // check the rest of the line
+    uint64_t word = line.words[w % kWordsPerLine] & ~sdsl::bits::lo_set[id & 63];
+    while (true) {
+        if (word) {
+            uint64_t pos = (w << 6) + __builtin_ctzll(word);
+            return pos < size_ ? pos : size_;
+        }
+        if (++w % kWordsPerLine == 0)
+            break;
+
+        word = line.words[w % kWordsPerLine];
+    }
+
+    uint64_t rk = lines_[l + 1].rank;
+    return rk < num_set_bits_ ? select1(rk + 1) : size_;
+}
+
+uint64_t bit_vector_cl::prev1(uint64_t id) const {
+    assert(id < size_);
+
+    uint64_t w = id >> 6;
+    const Line &line = lines_[w / kWordsPerLine];
+
+    // check the beginning of the line
+    uint64_t word = line.words[w % kWordsPerLine] & sdsl::bits::lo_set[(id & 63) + 1];
+    while (true) {
+        if (word)
+            return (w << 6) + 63 - __builtin_clzll(word);
+
+        if (w % kWordsPerLine == 0)
+            break;
+
+        word = line.words[--w % kWordsPerLine];
+    }
+
+    return line.rank ? select1(line.rank) : size_;
+}
+
+bool bit_vector_cl::operator[](uint64_t id) const {
+    assert(id < size_);
+    return (word(id >> 6) >> (id & 63)) & 1;
+}
+
+uint64_t bit_vector_cl::get_int(uint64_t id, uint32_t width) const {
+    assert(width && width <= 64);
+    assert(id + width <= size_);
+
+    const uint64_t w = id >> 6;
+    const uint64_t offset = id & 63;
+    uint64_t value = word(w) >> offset;
+    if (offset + width > 64)
+        value |= word(w + 1) << (64 - offset);
+
+    return value & sdsl::bits::lo_set[width];
+}
+
+bool bit_vector_cl::load(std::istream &in) {
+    if (!in.good())
+        return false;
+
+    try {
+        size_ = load_number(in);
+        num_set_bits_ = load_number(in);
+        lines_.resize(load_number(in));
+        in.read(reinterpret_cast<char *>(lines_.data()), lines_.size() * sizeof(Line));
+        select1_samples_ = load_number_vector_raw<uint64_t>(in);
+        select0_samples_ = load_number_vector_raw<uint64_t>(in);
+        return in.good()
+                && lines_.size() == (size_ + kBitsPerLine - 1) / kBitsPerLine + 1;
+
+    } catch (const std::bad_alloc &exception) {
+        std::cerr << "ERROR: Not enough memory to load bit_vector_cl" << std::endl;
+        return false;
+    } catch (...) {
+        return false;
+    }
+}
+
+void bit_vector_cl::serialize(std::ostream &out) const {
+    serialize_number(out, size_);
+    serialize_number(out, num_set_bits_);
+    serialize_number(out, lines_.size());
+    out.write(reinterpret_cast<const char *>(lines_.data()), lines_.size() * sizeof(Line));
+    serialize_number_vector_raw(out, select1_samples_);
+    serialize_number_vector_raw(out, select0_samples_);
+
+    if (!out.good())
+        throw std::ofstream::failure("Error when dumping bit_vector");
+}
+
+void bit_vector_cl::call_ones_in_range(uint64_t begin, uint64_t end,
+                                       const VoidCall<uint64_t> &callback) const {
+    assert(begin <= end);
+    assert(end <= size_);
+
+    if (begin == end)
+        return;
+
+    const uint64_t w_begin = begin >> 6;
+    const uint64_t w_end = (end + 63) >> 6;
+    for (uint64_t w = w_begin; w < w_end; ++w) {
+        uint64_t word = this->word(w);
+        if (w == w_begin)
+            word &= ~sdsl::bits::lo_set[begin & 63];
+        if (w + 1 == w_end && (end & 63))
+            word &= sdsl::bits::lo_set[end & 63];
+
+        while (word) {
+            callback((w << 6) + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+}
+
+void bit_vector_cl::add_to(sdsl::bit_vector *other) const {
+    assert(other);
+    assert(other->size() == size_);
+
+    uint64_t *data = other->data();
+    for (uint64_t w = 0; w < (size_ + 63) / 64; ++w) {
+        data[w] |= word(w);
+    }
+}
+
+sdsl::bit_vector bit_vector_cl::to_vector() const {
+    sdsl::bit_vector result(size_, false);
+    add_to(&result);
+    return result;
+}
+
+uint64_t bit_vector_cl::predict_size(uint64_t size, uint64_t num_set_bits) {
+    const uint64_t num_lines = (size + kBitsPerLine - 1) / kBitsPerLine + 1;
+    const uint64_t num_samples
+        = (num_set_bits + kSelectSampleRate - 1) / kSelectSampleRate
+            + (size - num_set_bits + kSelectSampleRate - 1) / kSelectSampleRate;
+    return 64 * 5 + num_lines * sizeof(Line) * 8 + num_samples * 64;
+}
+
+#endif // __BIT_VECTOR_CL_HPP__
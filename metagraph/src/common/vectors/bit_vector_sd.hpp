@@ -10,7 +10,7 @@
 #include "bit_vector.hpp"
 
 
-class bit_vector_sd : public bit_vector {
+class bit_vector_sd final : public bit_vector {
     static constexpr size_t MAX_ITER_BIT_VECTOR_SD = 10;
 
   public:
@@ -38,6 +38,21 @@ class bit_vector_sd : public bit_vector {
     inline uint64_t next1(uint64_t id) const override;
     inline uint64_t prev1(uint64_t id) const override;
 
+    void get_many(const uint64_t *ids, size_t size, bool *bits) const override {
+        get_many_impl(*this, ids, size, bits);
+    }
+    void rank1_many(const uint64_t *ids, size_t size, uint64_t *ranks) const override {
+        rank1_many_impl(*this, ids, size, ranks);
+    }
+    void conditional_rank1_many(const uint64_t *ids, size_t size,
+                                uint64_t *ranks) const override {
+        conditional_rank1_many_impl(*this, ids, size, ranks);
+    }
+    void select1_many(const uint64_t *ids, size_t size,
+                      uint64_t *positions) const override {
+        select1_many_impl(*this, ids, size, positions);
+    }
+
     inline bool operator[](uint64_t id) const override;
     inline uint64_t get_int(uint64_t id, uint32_t width) const override;
 
@@ -15,7 +15,7 @@
 
 
 template <class bv_type, class rank_1_type, class select_1_type, class select_0_type>
-class bit_vector_sdsl : public bit_vector {
+class bit_vector_sdsl final : public bit_vector {
     friend bit_vector;
 
     template <typename>
@@ -57,6 +57,21 @@ class bit_vector_sdsl : public bit_vector {
     inline uint64_t next1(uint64_t id) const override;
     inline uint64_t prev1(uint64_t id) const override;
 
+    void get_many(const uint64_t *ids, size_t size, bool *bits) const override {
+        get_many_impl(*this, ids, size, bits);
+    }
+    void rank1_many(const uint64_t *ids, size_t size, uint64_t *ranks) const override {
+        rank1_many_impl(*this, ids, size, ranks);
+    }
+    void conditional_rank1_many(const uint64_t *ids, size_t size,
+                                uint64_t *ranks) const override {
+        conditional_rank1_many_impl(*this, ids, size, ranks);
+    }
+    void select1_many(const uint64_t *ids, size_t size,
+                      uint64_t *positions) const override {
+        select1_many_impl(*this, ids, size, positions);
+    }
+
     inline bool operator[](uint64_t id) const override;
     inline uint64_t get_int(uint64_t id, uint32_t width) const override;
 
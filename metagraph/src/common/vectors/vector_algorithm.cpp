@@ -193,6 +193,8 @@ bool is_sparser(const bit_vector &bv,
                 return density < threshold_rrr;
             case bit_vector_adaptive::IL4096_VECTOR:
                 return density < threshold_stat;
+            case bit_vector_adaptive::CL_VECTOR:
+                return density < threshold_stat;
         }
     }
 
@@ -211,6 +213,9 @@ bool is_sparser(const bit_vector &bv,
     if (dynamic_cast<const bit_vector_il<4096> *>(&bv))
         return density < threshold_stat;
 
+    if (dynamic_cast<const bit_vector_cl *>(&bv))
+        return density < threshold_stat;
+
     return density < threshold_other;
 }
 
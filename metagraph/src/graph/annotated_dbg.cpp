@@ -358,12 +358,13 @@ Vector<std::pair<Column, size_t>> filter(const Vector<size_t> &col_counts,
     }
 
     if (code_counts.size() > num_top_labels) {
-        // sort by the number of matched k-mers
-        std::sort(code_counts.begin(), code_counts.end(),
-                  [](const auto &x, const auto &y) {
-                      return std::make_pair(y.second, x.first)
-                            < std::make_pair(x.second, y.first);
-                  });
+        // select the top labels by the number of matched k-mers
+        std::partial_sort(code_counts.begin(), code_counts.begin() + num_top_labels,
+                          code_counts.end(),
+                          [](const auto &x, const auto &y) {
+                              return std::make_pair(y.second, x.first)
+                                    < std::make_pair(x.second, y.first);
+                          });
         // keep only the first |num_top_labels| top labels
         code_counts.resize(num_top_labels);
     }
@@ -654,12 +655,13 @@ std::vector<StringCountPair> top_labels(Container&& code_counts,
     std::ignore = min_count;
 
     if (code_counts.size() > num_top_labels) {
-        // sort labels by counts to get the top |num_top_labels|
-        std::sort(code_counts.begin(), code_counts.end(),
-                  [](const auto &x, const auto &y) {
-                      return std::make_pair(y.second, x.first)
-                            < std::make_pair(x.second, y.first);
-                  });
+        // select the top |num_top_labels| labels by counts
+        std::partial_sort(code_counts.begin(), code_counts.begin() + num_top_labels,
+                          code_counts.end(),
+                          [](const auto &x, const auto &y) {
+                              return std::make_pair(y.second, x.first)
+                                    < std::make_pair(x.second, y.first);
+                          });
         // leave only the first |num_top_labels| top labels
         code_counts.resize(num_top_labels);
     }
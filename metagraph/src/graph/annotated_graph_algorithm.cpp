@@ -1,5 +1,8 @@
 #include "annotated_graph_algorithm.hpp"
 
+#include <algorithm>
+
+#include "annotation/binary_matrix/base/binary_matrix.hpp"
 #include "common/logger.hpp"
 #include "common/vectors/vector_algorithm.hpp"
 #include "common/vectors/bitmap.hpp"
@@ -18,6 +21,9 @@ typedef std::function<size_t()> LabelCountCallback;
 
 constexpr std::memory_order MO_RELAXED = std::memory_order_relaxed;
 
+// number of rows queried at once from row-major annotations
+const uint64_t kRowBatchSize = 100'000;
+
 uint64_t atomic_fetch(const sdsl::int_vector<> &vector,
                       uint64_t i,
                       std::mutex &backup_mutex,
@@ -81,6 +87,22 @@ construct_diff_label_count_vector(const AnnotatedDBG &anno_graph,
                                   size_t num_labels,
                                   size_t num_threads);
 
+// Call the nodes annotated with the labels |label_codes| (restricted to those
+// set in |mask|, if passed) in parallel. The callback receives the index of the
+// label in |label_codes| and may be called concurrently.
+void call_label_nodes(const AnnotatedDBG &anno_graph,
+                      const std::vector<uint64_t> &label_codes,
+                      const sdsl::bit_vector *mask,
+                      const std::function<void(size_t, node_index)> &callback,
+                      size_t num_threads);
+
+// Call the nodes of |masked_graph| paired with their reverse complements in
+// |graph| (if present). Each k-mer is called in one of its orientations only.
+void call_reverse_complements(const MaskedDeBruijnGraph &masked_graph,
+                              const DeBruijnGraph &graph,
+                              const std::function<void(node_index, node_index)> &callback,
+                              size_t num_threads);
+
 // Regions of a graph mask which should be kept (i.e., masked in)
 typedef std::vector<std::pair<size_t, size_t>> Intervals;
 
@@ -133,65 +155,98 @@ mask_nodes_by_label(const AnnotatedDBG &anno_graph,
     assert(counts.size() == init_mask.size() * 2);
 
     bool check_other = config.label_mask_other_unitig_fraction != 1.0;
-    sdsl::bit_vector union_mask;
+
+    bool add_complement = config.add_complement
+                            || graph_ptr->get_mode() == DeBruijnGraph::CANONICAL;
 
     sdsl::bit_vector other_mask(init_mask.size() * check_other, false);
     auto masked_graph = make_initial_masked_graph(graph_ptr, counts, std::move(init_mask),
                                                   config.add_complement, num_threads);
 
-    if (check_other || labels_in_round2.size() || labels_out_round2.size())
-        union_mask = dynamic_cast<const bitmap_vector&>(masked_graph->get_mask()).data();
-
     // check all other labels and post labels
     if (check_other || labels_in_round2.size() || labels_out_round2.size()) {
+        logger->trace("Checking shared and other labels");
+
+        // 1: in-label (round 2), 2: out-label (round 2), 4: other label
+        const auto &label_encoder = anno_graph.get_annotator().get_label_encoder();
+        std::vector<uint64_t> label_codes;
+        std::vector<uint8_t> label_flags;
+        for (uint64_t j = 0; j < num_labels; ++j) {
+            const Label &label = label_encoder.decode(j);
+            uint8_t flags = labels_in_round2.count(label) | (labels_out_round2.count(label) << 1);
+            if (!flags && check_other && !labels_in.count(label) && !labels_out.count(label))
+                flags = 4;
+
+            if (flags) {
+                label_codes.push_back(j);
+                label_flags.push_back(flags);
+            }
+        }
+
+        const sdsl::bit_vector &mask
+            = dynamic_cast<const bitmap_vector&>(masked_graph->get_mask()).data();
+
+        // The reverse complements added to the mask are not annotated, so
+        // with them the counts are collected separately and then copied.
+        sdsl::int_vector<> round2_counts;
+        if (add_complement)
+            round2_counts = aligned_int_vector(counts.size(), 0, counts.width(), 16);
+
+        sdsl::int_vector<> &label_counts = add_complement ? round2_counts : count_vector.first;
+
         std::mutex vector_backup_mutex;
         std::atomic_thread_fence(std::memory_order_release);
 
-        auto mask_or = [&](sdsl::bit_vector &a,
-                           const sdsl::bit_vector &b,
-                           const std::vector<node_index> &id_map) {
-            call_ones(b, [&](size_t i) {
-                if (id_map[i])
-                    set_bit(a.data(), id_map[i], parallel, MO_RELAXED);
-            });
-        };
-
-        auto count_merge = [&](sdsl::bit_vector &a,
-                               const sdsl::bit_vector &b,
-                               const std::vector<node_index> &id_map,
-                               size_t offset = 0) {
-            call_ones(b, [&](size_t i) {
-                if (id_map[i]) {
-                    set_bit(a.data(), id_map[i], parallel, MO_RELAXED);
-                    atomic_fetch_and_add(count_vector.first, id_map[i] * 2 + offset, 1,
-                                         vector_backup_mutex, MO_RELAXED);
-                }
-            });
-        };
-
-        logger->trace("Checking shared and other labels");
-        masked_graph->call_sequences([&](const std::string &contig, const std::vector<node_index> &path) {
-            for (const auto &[label, sig] : anno_graph.get_top_label_signatures(contig, num_labels)) {
-                bool found_in = labels_in.count(label);
-                bool found_out = labels_out.count(label);
-                bool found_in_round2 = labels_in_round2.count(label);
-                bool found_out_round2 = labels_out_round2.count(label);
-                if (!found_in && !found_out
-                        && !found_in_round2 && !found_out_round2 && check_other) {
-                    mask_or(other_mask, sig, path);
-                }
+        call_label_nodes(anno_graph, label_codes, &mask, [&](size_t k, node_index node) {
+            if (label_flags[k] & 1)
+                atomic_fetch_and_add(label_counts, node * 2, 1,
+                                     vector_backup_mutex, MO_RELAXED);
 
-                if (found_in_round2)
-                    count_merge(union_mask, sig, path);
+            if (label_flags[k] & 2)
+                atomic_fetch_and_add(label_counts, node * 2 + 1, 1,
+                                     vector_backup_mutex, MO_RELAXED);
 
-                if (found_out_round2)
-                    count_merge(union_mask, sig, path, 1);
-            }
+            if (label_flags[k] & 4)
+                set_bit(other_mask.data(), node, parallel, MO_RELAXED);
         }, num_threads);
 
         std::atomic_thread_fence(std::memory_order_acquire);
 
-        masked_graph->set_mask(new bitmap_vector(std::move(union_mask)));
+        if (add_complement) {
+            logger->trace("Adding counts of reverse complements");
+            std::atomic_thread_fence(std::memory_order_release);
+
+            #pragma omp parallel for num_threads(num_threads) schedule(static)
+            for (uint64_t i = 0; i < round2_counts.size(); ++i) {
+                if (uint64_t count = round2_counts[i])
+                    atomic_fetch_and_add(count_vector.first, i, count,
+                                         vector_backup_mutex, MO_RELAXED);
+            }
+
+            call_reverse_complements(*masked_graph, *graph_ptr,
+                                     [&](node_index node, node_index rc_node) {
+                if (rc_node == node)
+                    return;
+
+                // in and out counts
+                for (uint64_t j : { 0, 1 }) {
+                    atomic_fetch_and_add(count_vector.first, rc_node * 2 + j,
+                                         round2_counts[node * 2 + j],
+                                         vector_backup_mutex, MO_RELAXED);
+                    atomic_fetch_and_add(count_vector.first, node * 2 + j,
+                                         round2_counts[rc_node * 2 + j],
+                                         vector_backup_mutex, MO_RELAXED);
+                }
+
+                if (check_other && (fetch_bit(other_mask.data(), node, parallel, MO_RELAXED)
+                                    || fetch_bit(other_mask.data(), rc_node, parallel, MO_RELAXED))) {
+                    set_bit(other_mask.data(), node, parallel, MO_RELAXED);
+                    set_bit(other_mask.data(), rc_node, parallel, MO_RELAXED);
+                }
+            }, num_threads);
+
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
     }
 
     // Filter unitigs from masked graph based on filtration criteria
@@ -205,21 +260,23 @@ mask_nodes_by_label(const AnnotatedDBG &anno_graph,
             && config.label_mask_other_unitig_fraction == 1.0) {
         logger->trace("Filtering by node");
         size_t total_nodes = masked_graph->num_nodes();
-        const auto &in_mask = dynamic_cast<const bitmap_vector&>(masked_graph->get_mask()).data();
-        sdsl::bit_vector mask = in_mask;
+        sdsl::bit_vector mask
+            = dynamic_cast<const bitmap_vector&>(masked_graph->get_mask()).data();
 
-        // TODO: make this part multithreaded
+        // check the nodes word by word, each word is updated by one thread only
         size_t kept_nodes = 0;
-        call_ones(in_mask, [&](node_index node) {
-            uint64_t in_count = count_vector.first[node * 2];
-            uint64_t out_count = count_vector.first[node * 2 + 1];
-
-            if (in_count >= min_label_in_count && out_count <= max_label_out_count) {
-                ++kept_nodes;
-            } else {
-                mask[node] = false;
+        #pragma omp parallel for num_threads(num_threads) schedule(static) reduction(+:kept_nodes)
+        for (uint64_t w = 0; w < (mask.size() + 63) / 64; ++w) {
+            uint64_t word = mask.data()[w];
+            for (uint64_t bits = word; bits; bits &= bits - 1) {
+                node_index node = w * 64 + __builtin_ctzll(bits);
+                if (count_vector.first[node * 2] < min_label_in_count
+                        || count_vector.first[node * 2 + 1] > max_label_out_count)
+                    word &= ~(1llu << (node % 64));
             }
-        });
+            mask.data()[w] = word;
+            kept_nodes += sdsl::bits::cnt(word);
+        }
 
         masked_graph->set_mask(new bitmap_vector(std::move(mask)));
 
@@ -314,23 +371,15 @@ make_initial_masked_graph(std::shared_ptr<const DeBruijnGraph> graph_ptr,
         logger->trace("Adding reverse complements");
         std::mutex vector_backup_mutex;
         std::atomic_thread_fence(std::memory_order_release);
-        masked_graph->call_sequences([&](const std::string &seq, const std::vector<node_index> &path) {
-            std::string rc_seq = seq;
-            std::vector<DeBruijnGraph::node_index> rc_path = path;
-            reverse_complement_seq_path(*graph_ptr, rc_seq, rc_path);
-
-            auto it = rc_path.rbegin();
-            for (size_t i = 0; i < path.size(); ++i, ++it) {
-                if (*it) {
-                    uint64_t in_count = atomic_fetch(counts, path[i] * 2, vector_backup_mutex, MO_RELAXED);
-                    uint64_t out_count = atomic_fetch(counts, path[i] * 2 + 1, vector_backup_mutex, MO_RELAXED);
-                    atomic_fetch_and_add(counts, *it * 2, in_count, vector_backup_mutex, MO_RELAXED);
-                    atomic_fetch_and_add(counts, *it * 2 + 1, out_count, vector_backup_mutex, MO_RELAXED);
-
-                    set_bit(mask.data(), *it, in_count, MO_RELAXED);
-                }
-            }
-        }, num_threads, true);
+        call_reverse_complements(*masked_graph, *graph_ptr,
+                                 [&](node_index node, node_index rc_node) {
+            uint64_t in_count = atomic_fetch(counts, node * 2, vector_backup_mutex, MO_RELAXED);
+            uint64_t out_count = atomic_fetch(counts, node * 2 + 1, vector_backup_mutex, MO_RELAXED);
+            atomic_fetch_and_add(counts, rc_node * 2, in_count, vector_backup_mutex, MO_RELAXED);
+            atomic_fetch_and_add(counts, rc_node * 2 + 1, out_count, vector_backup_mutex, MO_RELAXED);
+
+            set_bit(mask.data(), rc_node, in_count, MO_RELAXED);
+        }, num_threads);
 
         std::atomic_thread_fence(std::memory_order_acquire);
 
@@ -348,14 +397,18 @@ construct_diff_label_count_vector(const AnnotatedDBG &anno_graph,
                                   const tsl::hopscotch_set<Label> &labels_out,
                                   size_t num_labels,
                                   size_t num_threads) {
-    size_t width = sdsl::bits::hi(num_labels) + 1;
+    // round the width up to a byte-aligned one, so that the counters
+    // are always incremented atomically, without locking
+    uint8_t width = 8;
+    while (width < sdsl::bits::hi(num_labels) + 1) {
+        width *= 2;
+    }
     sdsl::bit_vector indicator(anno_graph.get_graph().max_index() + 1, false);
 
     // the in and out counts are stored interleaved
     sdsl::int_vector<> counts = aligned_int_vector(indicator.size() * 2, 0, width, 16);
 
     const auto &label_encoder = anno_graph.get_annotator().get_label_encoder();
-    const auto &binmat = anno_graph.get_annotator().get_matrix();
 
     tsl::hopscotch_map<uint64_t, uint8_t> code_to_indicator;
     for (const std::string &label_in : labels_in) {
@@ -366,30 +419,26 @@ construct_diff_label_count_vector(const AnnotatedDBG &anno_graph,
     }
 
     std::vector<uint64_t> label_codes;
+    std::vector<uint8_t> label_indicators;
     label_codes.reserve(code_to_indicator.size());
+    label_indicators.reserve(code_to_indicator.size());
     for (const auto &[code, indicator] : code_to_indicator) {
         label_codes.push_back(code);
+        label_indicators.push_back(indicator);
     }
 
     std::mutex vector_backup_mutex;
     std::atomic_thread_fence(std::memory_order_release);
     bool parallel = num_threads > 1;
 
-    binmat.call_columns(label_codes,
-        [&](auto col_idx, const bitmap &rows) {
-            uint8_t col_indicator = code_to_indicator[label_codes[col_idx]];
-            rows.call_ones([&](auto r) {
-                node_index i = AnnotatedDBG::anno_to_graph_index(r);
-                set_bit(indicator.data(), i, parallel, MO_RELAXED);
-                if (col_indicator & 1)
-                    atomic_fetch_and_add(counts, i * 2, 1, vector_backup_mutex, MO_RELAXED);
-
-                if (col_indicator & 2)
-                    atomic_fetch_and_add(counts, i * 2 + 1, 1, vector_backup_mutex, MO_RELAXED);
-            });
-        },
-        num_threads
-    );
+    call_label_nodes(anno_graph, label_codes, nullptr, [&](size_t k, node_index i) {
+        set_bit(indicator.data(), i, parallel, MO_RELAXED);
+        if (label_indicators[k] & 1)
+            atomic_fetch_and_add(counts, i * 2, 1, vector_backup_mutex, MO_RELAXED);
+
+        if (label_indicators[k] & 2)
+            atomic_fetch_and_add(counts, i * 2 + 1, 1, vector_backup_mutex, MO_RELAXED);
+    }, num_threads);
 
     std::atomic_thread_fence(std::memory_order_acquire);
 
@@ -397,6 +446,70 @@ construct_diff_label_count_vector(const AnnotatedDBG &anno_graph,
 }
 
 
+void call_label_nodes(const AnnotatedDBG &anno_graph,
+                      const std::vector<uint64_t> &label_codes,
+                      const sdsl::bit_vector *mask,
+                      const std::function<void(size_t, node_index)> &callback,
+                      size_t num_threads) {
+    const auto &binmat = anno_graph.get_annotator().get_matrix();
+
+    if (!dynamic_cast<const annot::matrix::RowMajor *>(&binmat)) {
+        binmat.call_columns(label_codes, [&](size_t k, const bitmap &rows) {
+            rows.call_ones([&](uint64_t r) {
+                node_index node = AnnotatedDBG::anno_to_graph_index(r);
+                if (!mask || (*mask)[node])
+                    callback(k, node);
+            });
+        }, num_threads);
+        return;
+    }
+
+    // For row-major annotations, extracting columns means scanning all rows
+    // for each one of them, so query the (masked) rows in batches instead.
+    std::vector<size_t> label_index(binmat.num_columns(), label_codes.size());
+    for (size_t k = 0; k < label_codes.size(); ++k) {
+        label_index[label_codes[k]] = k;
+    }
+
+    const uint64_t num_rows = binmat.num_rows();
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (uint64_t begin = 0; begin < num_rows; begin += kRowBatchSize) {
+        const uint64_t end = std::min(begin + kRowBatchSize, num_rows);
+        std::vector<annot::matrix::BinaryMatrix::Row> rows;
+        rows.reserve(end - begin);
+        for (uint64_t r = begin; r < end; ++r) {
+            if (!mask || (*mask)[AnnotatedDBG::anno_to_graph_index(r)])
+                rows.push_back(r);
+        }
+
+        auto row_labels = binmat.get_rows(rows);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            for (auto j : row_labels[i]) {
+                if (label_index[j] < label_codes.size())
+                    callback(label_index[j], AnnotatedDBG::anno_to_graph_index(rows[i]));
+            }
+        }
+    }
+}
+
+void call_reverse_complements(const MaskedDeBruijnGraph &masked_graph,
+                              const DeBruijnGraph &graph,
+                              const std::function<void(node_index, node_index)> &callback,
+                              size_t num_threads) {
+    masked_graph.call_sequences([&](const std::string &seq, const std::vector<node_index> &path) {
+        std::string rc_seq = seq;
+        std::vector<node_index> rc_path = path;
+        reverse_complement_seq_path(graph, rc_seq, rc_path);
+
+        auto it = rc_path.rbegin();
+        for (size_t i = 0; i < path.size(); ++i, ++it) {
+            if (*it)
+                callback(path[i], *it);
+        }
+    }, num_threads, true);
+}
+
 void update_masked_graph_by_unitig(MaskedDeBruijnGraph &masked_graph,
                                    const GetKeptIntervals &get_kept_intervals,
                                    size_t num_threads) {
@@ -2,7 +2,10 @@
 
 #include <cmath>
 
+#include <omp.h>
+
 #include "common/logger.hpp"
+#include "graph/representation/masked_graph.hpp"
 
 
 namespace mtg {
@@ -10,6 +13,8 @@ namespace graph {
 
 using mtg::common::logger;
 
+static const uint64_t kBlockSize = 1 << 14;
+
 
 bool is_unreliable_unitig(const std::vector<SequenceGraph::node_index> &path,
                           const NodeWeights &node_weights,
@@ -36,19 +41,77 @@ int cleaning_pick_kmer_threshold(const uint64_t *kmer_covg, size_t arrlen,
                                  double *alpha_est_ptr, double *beta_est_ptr,
                                  double *false_pos_ptr, double *false_neg_ptr);
 
+// Return a check whether an index in [1, max_index] is a node of |graph|,
+// which can be called concurrently, or an empty function if the nodes can
+// only be enumerated with call_nodes.
+std::function<bool(SequenceGraph::node_index)> get_node_check(const DeBruijnGraph &graph) {
+    if (const auto *masked = dynamic_cast<const MaskedDeBruijnGraph *>(&graph)) {
+        if (masked->only_valid_nodes_in_mask())
+            return [masked](auto i) { return masked->in_subgraph(i); };
+
+        if (auto in_base_graph = get_node_check(masked->get_graph()))
+            return [masked, in_base_graph](auto i) {
+                return masked->in_subgraph(i) && in_base_graph(i);
+            };
+
+        return {};
+    }
+
+    // other wrappers may skip indexes (e.g., palindromes in CanonicalDBG)
+    if (dynamic_cast<const DBGWrapper<DeBruijnGraph> *>(&graph))
+        return {};
+
+    // all indexes are nodes, as assumed by SequenceGraph::call_nodes
+    if (graph.num_nodes() == graph.max_index())
+        return [](auto) { return true; };
+
+    return {};
+}
+
 // returns -1 if the automatic estimation fails
 uint64_t estimate_min_kmer_abundance(const DeBruijnGraph &graph,
                                      const NodeWeights &node_weights,
-                                     uint64_t num_singleton_kmers) {
-    std::vector<uint64_t> hist;
-    graph.call_nodes([&](auto i) {
+                                     uint64_t num_singleton_kmers,
+                                     size_t num_threads) {
+    num_threads = std::max(num_threads, (size_t)1);
+
+    std::vector<std::vector<uint64_t>> thread_hists(num_threads);
+
+    auto count_kmer = [&node_weights](std::vector<uint64_t> &hist, uint64_t i) {
         uint64_t kmer_count = node_weights[i];
         assert(kmer_count && "All k-mers in graph must have non-zero counts");
-        while (kmer_count >= hist.size()) {
-            hist.push_back(0);
-        }
+        if (kmer_count >= hist.size())
+            hist.resize(kmer_count + 1, 0);
+
         hist[kmer_count]++;
-    });
+    };
+
+    if (auto is_node = get_node_check(graph)) {
+        // enumerate the nodes in blocks and merge the per-thread histograms
+        const uint64_t max_index = graph.max_index();
+
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (uint64_t begin = 1; begin <= max_index; begin += kBlockSize) {
+            auto &hist = thread_hists[omp_get_thread_num()];
+            const uint64_t end = std::min(begin + kBlockSize, max_index + 1);
+            for (uint64_t i = begin; i < end; ++i) {
+                if (is_node(i))
+                    count_kmer(hist, i);
+            }
+        }
+    } else {
+        graph.call_nodes([&](auto i) { count_kmer(thread_hists[0], i); });
+    }
+
+    std::vector<uint64_t> hist;
+    for (const auto &thread_hist : thread_hists) {
+        if (thread_hist.size() > hist.size())
+            hist.resize(thread_hist.size(), 0);
+
+        for (size_t i = 0; i < thread_hist.size(); ++i) {
+            hist[i] += thread_hist[i];
+        }
+    }
 
     hist.resize(std::max((uint64_t)hist.size(), (uint64_t)10), 0);
 
@@ -12,9 +12,13 @@ bool is_unreliable_unitig(const std::vector<SequenceGraph::node_index> &path,
                           const NodeWeights &node_weights,
                           uint64_t min_median_abundance);
 
+// Fit a model to the histogram of k-mer counts and estimate the minimum
+// abundance of genuine (non-erroneous) k-mers. The histogram is computed
+// in parallel on |num_threads| threads.
 uint64_t estimate_min_kmer_abundance(const DeBruijnGraph &graph,
                                      const NodeWeights &node_weights,
-                                     uint64_t num_singleton_kmers = 0);
+                                     uint64_t num_singleton_kmers = 0,
+                                     size_t num_threads = 1);
 
 } // namespace graph
 } // namespace mtg
@@ -1,9 +1,7 @@
 #ifndef __NODE_FIRST_CACHE_HPP__
 #define __NODE_FIRST_CACHE_HPP__
 
-#include <cache.hpp>
-#include <lru_cache_policy.hpp>
-
+#include "common/threads/concurrent_cache.hpp"
 #include "graph/representation/succinct/dbg_succinct.hpp"
 
 
@@ -12,11 +10,13 @@ namespace graph {
 
 // This cache stores intermediate results from BOSS bwd calls to speed up calls
 // to call_incoming_kmers in DBGSuccinct.
-// This stores 80 bytes per cached 8-byte node index.
+// This stores 32 bytes per cached 8-byte node index.
+// The cache is thread-safe and can be shared by all threads.
 class NodeFirstCache : public SequenceGraph::GraphExtension {
   public:
     using node_index = typename SequenceGraph::node_index;
     using IncomingEdgeCallback = DeBruijnGraph::IncomingEdgeCallback;
+    using edge_index = boss::BOSS::edge_index;
 
     NodeFirstCache() : dbg_succ_(nullptr), first_cache_(1) {}
     NodeFirstCache(const DBGSuccinct &graph, size_t cache_size = 100'000)
@@ -32,16 +32,16 @@ class NodeFirstCache : public SequenceGraph::GraphExtension {
 
     bool is_compatible(const SequenceGraph &graph, bool verbose = true) const;
 
+    const common::ConcurrentCache<edge_index, std::pair<edge_index, edge_index>>&
+    get_cache() const { return first_cache_; }
+
   private:
     const DBGSuccinct *dbg_succ_;
 
-    using edge_index = boss::BOSS::edge_index;
-
     // Maps a BOSS edge e to the pair (bwd(e), bwd^(k-1)(e)), where k is the node
     // size in a BOSS graph.
     // Thus, first_cache_[e] == boss.get_minus_k_value(e, boss.get_k() - 1).first
-    mutable caches::fixed_sized_cache<edge_index, std::pair<edge_index, edge_index>,
-                                      caches::LRUCachePolicy<node_index>> first_cache_;
+    mutable common::ConcurrentCache<edge_index, std::pair<edge_index, edge_index>> first_cache_;
 
     // Fetch or compute (bwd(edge), bwd^(k-1)(edge)), then cache the value.
     // If child_hint != 0, then check first_cache_ if child_hint_'s corresponding
@@ -1,8 +1,10 @@
 #ifndef __DBG_CONSTRUCT_HPP__
 #define __DBG_CONSTRUCT_HPP__
 
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
 
 namespace mtg {
@@ -18,6 +20,12 @@ class IGraphChunkConstructor {
     virtual void add_sequences(std::vector<std::string>&& sequences) = 0;
     virtual void add_sequences(std::vector<std::pair<std::string, uint64_t>>&& sequences) = 0;
 
+    // Add k-mers given as nucleotide codes, |k| codes per k-mer
+    // (see seq_io::read_kmer_batches).
+    virtual void add_kmers(size_t k,
+                           std::vector<uint8_t>&& codes,
+                           std::vector<uint64_t>&& counts) = 0;
+
     virtual GraphChunk build_chunk() = 0;
 };
 
@@ -31,6 +39,12 @@ class IGraphConstructor {
     virtual void add_sequences(std::vector<std::string>&& sequences) = 0;
     virtual void add_sequences(std::vector<std::pair<std::string, uint64_t>>&& sequences) = 0;
 
+    // Add k-mers given as nucleotide codes, |k| codes per k-mer
+    // (see seq_io::read_kmer_batches).
+    virtual void add_kmers(size_t k,
+                           std::vector<uint8_t>&& codes,
+                           std::vector<uint64_t>&& counts) = 0;
+
     virtual void build_graph(Graph *graph) = 0;
 };
 
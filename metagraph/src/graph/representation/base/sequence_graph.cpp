@@ -304,14 +304,214 @@ void call_sequences_from(const DeBruijnGraph &graph,
     }
 }
 
+/**
+ * Parallel traversal of the graph. Each node is visited exactly once, which
+ * is ensured by marking the nodes in |visited| atomically.
+ *
+ * In the unitig mode, the start nodes of all unitigs are marked first, so the
+ * traversals started from them never overlap and the unitigs called are the
+ * same as in the serial traversal.
+ * In the primary mode (|kmers_in_single_form| is true), each pair of
+ * reverse-complement k-mers is represented by the smaller node index, which
+ * is marked in |fetched| by the thread that calls the k-mer first.
+ */
+void call_sequences_parallel(const DeBruijnGraph &graph,
+                             const DeBruijnGraph::CallPath &callback,
+                             size_t num_threads,
+                             bool call_unitigs,
+                             uint64_t min_tip_size,
+                             bool kmers_in_single_form) {
+    constexpr bool async = true;
+
+    sdsl::bit_vector visited(graph.max_index() + 1, true);
+    graph.call_nodes([&](auto node) { visited[node] = false; });
+
+    ProgressBar progress_bar(visited.size() - sdsl::util::cnt_one_bits(visited),
+                             "Traverse graph",
+                             std::cerr, !common::get_verbose());
+
+    // In the unitig mode, mark the nodes continuing unitigs, that is, nodes
+    // with a single incoming edge from a node with a single outgoing edge.
+    // Otherwise, mark the forks.
+    sdsl::bit_vector marked(visited.size(), false);
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (uint64_t begin = 0; begin < visited.size(); begin += kBlockSize) {
+        call_zeros(visited,
+            begin,
+            std::min(begin + kBlockSize, visited.size()),
+            [&](auto i) {
+                if (!call_unitigs) {
+                    marked[i] = graph.has_multiple_outgoing(i);
+
+                } else if (graph.has_single_incoming(i)) {
+                    graph.adjacent_incoming_nodes(i, [&](auto prev) {
+                        marked[i] = graph.has_single_outgoing(prev);
+                    });
+                }
+            }
+        );
+    }
+
+    sdsl::bit_vector fetched;
+    if (kmers_in_single_form)
+        fetched = sdsl::bit_vector(visited.size(), false);
+
+    auto call_path = [&](std::string&& sequence, std::vector<node_index>&& path) {
+        if (!kmers_in_single_form) {
+            callback(std::move(sequence), std::move(path));
+            return;
+        }
+
+        // get dual path (mapping of the reverse complement sequence)
+        std::string rev_comp_seq = sequence;
+        reverse_complement(rev_comp_seq.begin(), rev_comp_seq.end());
+
+        auto dual_path = map_to_nodes_sequentially(graph, rev_comp_seq);
+        std::reverse(dual_path.begin(), dual_path.end());
+        size_t begin = 0;
+
+        for (size_t i = 0; i < path.size(); ++i) {
+            node_index rep = dual_path[i] ? std::min(path[i], dual_path[i]) : path[i];
+            if (!fetch_and_set_bit(fetched.data(), rep, async))
+                continue;
+
+            // The k-mer or its reverse-complement has already been called
+            // -> Skip this k-mer and call the traversed path segment.
+            if (begin < i)
+                callback(sequence.substr(begin, i + graph.get_k() - 1 - begin),
+                         { path.begin() + begin, path.begin() + i });
+
+            begin = i + 1;
+        }
+
+        // Call the path traversed
+        if (!begin) {
+            callback(std::move(sequence), std::move(path));
+
+        } else if (begin < path.size()) {
+            callback(sequence.substr(begin),
+                     { path.begin() + begin, path.end() });
+        }
+    };
+
+    // traverse a simple path starting at |node| and visit its nodes
+    auto call_path_from = [&](node_index node) {
+        if (fetch_and_set_bit(visited.data(), node, async))
+            return;
+
+        node_index start = node;
+        std::vector<node_index> path = { node };
+        std::string sequence = graph.get_node_sequence(node);
+
+        while (true) {
+            ++progress_bar;
+
+            node_index next_node = DeBruijnGraph::npos;
+            char next_c = '\0';
+
+            if (!call_unitigs) {
+                // pick the first outgoing node not visited yet
+                graph.call_outgoing_kmers(node, [&](node_index next, char c) {
+                    if (!next_node && !fetch_and_set_bit(visited.data(), next, async)) {
+                        next_node = next;
+                        next_c = c;
+                    }
+                });
+
+            } else if (graph.has_single_outgoing(node)) {
+                graph.call_outgoing_kmers(node, [&](node_index next, char c) {
+                    next_node = next;
+                    next_c = c;
+                });
+                // don't go through the merges and the nodes starting unitigs
+                if (!marked[next_node]
+                        || fetch_and_set_bit(visited.data(), next_node, async))
+                    next_node = DeBruijnGraph::npos;
+            }
+
+            if (!next_node)
+                break;
+
+            path.push_back(next_node);
+            sequence.push_back(next_c);
+            node = next_node;
+        }
+
+        assert(path == map_to_nodes_sequentially(graph, sequence));
+
+        if (!call_unitigs
+                  // check if long
+                  || sequence.size() >= graph.get_k() + min_tip_size - 1
+                  // check if not tip
+                  || graph.indegree(start) + graph.outdegree(node) >= 2)
+            call_path(std::move(sequence), std::move(path));
+    };
+
+    if (call_unitigs) {
+        // start at all nodes starting unitigs
+        //  .____  or  .____  or  ____.___  or  ____.____
+        //              \___      ___/               \___
+        //
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (uint64_t begin = 0; begin < visited.size(); begin += kBlockSize) {
+            call_zeros(marked,
+                begin,
+                std::min(begin + kBlockSize, visited.size()),
+                [&](auto node) {
+                    if (!fetch_bit(visited.data(), node, async))
+                        call_path_from(node);
+                }
+            );
+        }
+
+    } else {
+        // start at the source nodes (those with indegree == 0)
+        //  .____  or  .____
+        //              \___
+        //
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (uint64_t begin = 0; begin < visited.size(); begin += kBlockSize) {
+            call_zeros(visited,
+                begin,
+                std::min(begin + kBlockSize, visited.size()),
+                [&](auto node) {
+                    if (graph.has_no_incoming(node))
+                        call_path_from(node);
+                },
+                async
+            );
+        }
+
+        // then forks
+        //  ____.____
+        //       \___
+        //
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+        for (uint64_t begin = 0; begin < visited.size(); begin += kBlockSize) {
+            call_ones(marked,
+                begin,
+                std::min(begin + kBlockSize, visited.size()),
+                [&](auto node) { graph.adjacent_outgoing_nodes(node, call_path_from); }
+            );
+        }
+    }
+
+    // then the rest (loops)
+    call_zeros(visited, call_path_from);
+}
+
 void call_sequences(const DeBruijnGraph &graph,
                     const DeBruijnGraph::CallPath &callback,
                     size_t num_threads,
                     bool call_unitigs,
                     uint64_t min_tip_size,
                     bool kmers_in_single_form) {
-    // TODO: port over the implementation from BOSS
-    std::ignore = num_threads;
+    if (num_threads > 1) {
+        call_sequences_parallel(graph, callback, num_threads,
+                                call_unitigs, min_tip_size, kmers_in_single_form);
+        return;
+    }
 
     sdsl::bit_vector discovered(graph.max_index() + 1, true);
     graph.call_nodes([&](auto node) { discovered[node] = false; });
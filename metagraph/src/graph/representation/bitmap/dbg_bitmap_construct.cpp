@@ -45,6 +45,10 @@ class BitmapChunkConstructor : public IBitmapChunkConstructor {
         kmer_collector_.add_sequences(std::move(sequences));
     }
 
+    void add_kmers(size_t k, std::vector<uint8_t>&& codes, std::vector<uint64_t>&& counts) {
+        kmer_collector_.add_kmers(k, std::move(codes), std::move(counts));
+    }
+
     size_t get_k() const { return kmer_collector_.get_k(); }
 
     DeBruijnGraph::Mode get_mode() const { return mode_; }
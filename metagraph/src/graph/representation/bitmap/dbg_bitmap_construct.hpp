@@ -48,6 +48,10 @@ class DBGBitmapConstructor : public IGraphConstructor<DBGBitmap> {
         constructor_->add_sequences(std::move(sequences));
     }
 
+    void add_kmers(size_t k, std::vector<uint8_t>&& codes, std::vector<uint64_t>&& counts) {
+        constructor_->add_kmers(k, std::move(codes), std::move(counts));
+    }
+
     void build_graph(DBGBitmap *graph);
     DBGBitmap::Chunk build_chunk() { return constructor_->build_chunk(); }
 
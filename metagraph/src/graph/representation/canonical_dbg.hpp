@@ -4,10 +4,8 @@
 #include <cassert>
 #include <array>
 
-#include <cache.hpp>
-#include <lru_cache_policy.hpp>
-
 #include "common/vector.hpp"
+#include "common/threads/concurrent_cache.hpp"
 #include "graph/representation/base/dbg_wrapper.hpp"
 
 
@@ -17,6 +15,8 @@ namespace graph {
 /**
  * CanonicalDBG is a wrapper which acts like a canonical-mode DeBruijnGraph, but
  * uses a PRIMARY DeBruijnGraph (constructed from primary contigs).
+ * The wrapper is thread-safe, so a single instance (and its cache) can be
+ * shared by all threads.
  */
 class CanonicalDBG : public DBGWrapper<DeBruijnGraph> {
   public:
@@ -39,6 +39,10 @@ class CanonicalDBG : public DBGWrapper<DeBruijnGraph> {
         return node <= offset_ ? node : node - offset_;
     }
 
+    const common::ConcurrentCache<node_index, bool>& get_cache() const {
+        return is_palindrome_cache_;
+    }
+
     /**
      * Methods from DeBruijnGraph
      */
@@ -104,8 +108,7 @@ class CanonicalDBG : public DBGWrapper<DeBruijnGraph> {
     const size_t cache_size_;
 
     // cache whether a given node is a palindrome (it's equal to its reverse complement)
-    mutable caches::fixed_sized_cache<node_index, bool,
-                                      caches::LRUCachePolicy<node_index>> is_palindrome_cache_;
+    mutable common::ConcurrentCache<node_index, bool> is_palindrome_cache_;
 
     const size_t offset_;
     const bool k_odd_;
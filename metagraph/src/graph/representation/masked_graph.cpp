@@ -1,6 +1,8 @@
 #include "masked_graph.hpp"
 
 #include "common/serialization.hpp"
+#include "common/vectors/bit_vector_adaptive.hpp"
+#include "common/vectors/vector_algorithm.hpp"
 #include "graph/representation/base/sequence_graph.hpp"
 #include "graph/representation/succinct/dbg_succinct.hpp"
 
@@ -8,6 +10,10 @@
 namespace mtg {
 namespace graph {
 
+// the bit vector is processed in blocks of bits aligned to 64-bit words,
+// so no atomic operations are needed when the blocks are processed in parallel
+static const uint64_t kBlockSize = 1 << 14;
+
 // Traverse the outgoing edge
 MaskedDeBruijnGraph::node_index MaskedDeBruijnGraph
 ::traverse(node_index node, char next_char) const {
@@ -156,20 +162,26 @@ void MaskedDeBruijnGraph
     bool stop = false;
 
     if (only_valid_nodes_in_mask_) {
-        // iterate only through the nodes marked in the mask
-        // TODO: add terminate<bool(void)> to call_ones
-        kmers_in_graph_->call_ones([&](auto index) {
-            if (stop || !index)
-                return;
-
-            assert(in_subgraph(index));
-
-            if (stop_early()) {
-                stop = true;
-            } else {
-                callback(index);
-            }
-        });
+        // iterate only through the nodes marked in the mask, block by block,
+        // so that the scan can be terminated early
+        for (uint64_t begin = 0; begin < kmers_in_graph_->size() && !stop;
+                                                    begin += kBlockSize) {
+            kmers_in_graph_->call_ones_in_range(
+                begin, std::min(begin + kBlockSize, kmers_in_graph_->size()),
+                [&](auto index) {
+                    if (stop || !index)
+                        return;
+
+                    assert(in_subgraph(index));
+
+                    if (stop_early()) {
+                        stop = true;
+                    } else {
+                        callback(index);
+                    }
+                }
+            );
+        }
     } else {
         // call all nodes in the base graph and check the mask
         graph_->call_nodes(
@@ -262,5 +274,51 @@ bool MaskedDeBruijnGraph::operator==(const DeBruijnGraph &other) const {
     return DeBruijnGraph::operator==(other);
 }
 
+std::unique_ptr<bit_vector>
+materialize_mask(const DeBruijnGraph &graph,
+                 const std::function<bool(DeBruijnGraph::node_index)> &is_in_mask,
+                 size_t num_threads) {
+    sdsl::bit_vector mask(graph.max_index() + 1, false);
+    graph.call_nodes([&](auto node) { mask[node] = true; });
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic)
+    for (uint64_t begin = 0; begin < mask.size(); begin += kBlockSize) {
+        call_ones(mask, begin, std::min(begin + kBlockSize, mask.size()),
+            [&](auto node) {
+                if (!is_in_mask(node))
+                    mask[node] = false;
+            }
+        );
+    }
+
+    return std::make_unique<bit_vector_smart>(std::move(mask));
+}
+
+std::unique_ptr<bit_vector> intersect_masks(const bitmap &first, const bitmap &second) {
+    assert(first.size() == second.size());
+
+    const bool first_sparser = first.num_set_bits() <= second.num_set_bits();
+    const bitmap &sparse = first_sparser ? first : second;
+    const bitmap &dense = first_sparser ? second : first;
+
+    sdsl::bit_vector mask(first.size(), false);
+    sparse.call_ones([&](auto i) {
+        if (dense[i])
+            mask[i] = true;
+    });
+
+    return std::make_unique<bit_vector_smart>(std::move(mask));
+}
+
+std::unique_ptr<bit_vector> unite_masks(const bitmap &first, const bitmap &second) {
+    assert(first.size() == second.size());
+
+    sdsl::bit_vector mask(first.size(), false);
+    first.add_to(&mask);
+    second.add_to(&mask);
+
+    return std::make_unique<bit_vector_smart>(std::move(mask));
+}
+
 } // namespace graph
 } // namespace mtg
@@ -5,6 +5,7 @@
 #include <vector>
 
 #include "common/vectors/bitmap.hpp"
+#include "common/vectors/bit_vector.hpp"
 #include "graph/representation/base/dbg_wrapper.hpp"
 
 
@@ -108,6 +109,9 @@ class MaskedDeBruijnGraph : public DBGWrapper<DeBruijnGraph> {
         return (*kmers_in_graph_)[node];
     }
 
+    // true if the mask marks only valid nodes of the underlying graph
+    bool only_valid_nodes_in_mask() const { return only_valid_nodes_in_mask_; }
+
     virtual bool operator==(const MaskedDeBruijnGraph &other) const;
     virtual bool operator==(const DeBruijnGraph &other) const override;
 
@@ -135,6 +139,23 @@ class MaskedDeBruijnGraph : public DBGWrapper<DeBruijnGraph> {
     Mode mode_;
 };
 
+/**
+ * Evaluate |is_in_mask| for each node of |graph| once in parallel and return
+ * the result as a compressed bit vector with rank/select support.
+ * Only the nodes called by graph.call_nodes can be marked, hence the returned
+ * mask can be used with |only_valid_nodes_in_mask| = true.
+ * Unlike bitmap_lazy, the predicate is never evaluated again during traversals.
+ */
+std::unique_ptr<bit_vector>
+materialize_mask(const DeBruijnGraph &graph,
+                 const std::function<bool(DeBruijnGraph::node_index)> &is_in_mask,
+                 size_t num_threads = 1);
+
+// Compose masks of the same size (e.g., for multi-step filtering).
+// Only the set bits of the sparser mask are checked in the intersection.
+std::unique_ptr<bit_vector> intersect_masks(const bitmap &first, const bitmap &second);
+std::unique_ptr<bit_vector> unite_masks(const bitmap &first, const bitmap &second);
+
 } // namespace graph
 } // namespace mtg
 
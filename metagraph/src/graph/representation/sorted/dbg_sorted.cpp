@@ -0,0 +1,412 @@
+#include "dbg_sorted.hpp"
+
+#include <cassert>
+
+#include <ips4o.hpp>
+#include <sdsl/int_vector.hpp>
+
+#include "common/logger.hpp"
+#include "common/vectors/vector_algorithm.hpp"
+#include "kmer/kmer_extractor.hpp"
+
+
+namespace mtg {
+namespace graph {
+
+using mtg::common::logger;
+using mtg::kmer::KmerExtractor2Bit;
+
+// number of characters accumulated before extracting k-mers from them in parallel
+static const uint64_t kSequenceBatchSize = 1 << 24;
+// do not deduplicate k-mers while there are fewer of them in the buffer
+static const uint64_t kMinBufferSize = 1 << 20;
+
+
+template <typename KMER = KmerExtractor2Bit::Kmer64>
+class DBGSortedImpl : public DBGSorted::DBGSortedInterface {
+    using Kmer = KMER;
+    using KmerWord = typename KMER::WordType;
+    using TAlphabet = KmerExtractor2Bit::TAlphabet;
+    using CallSequence = DBGSorted::CallSequence;
+    using GetSkipper = DBGSorted::GetSkipper;
+
+  public:
+    DBGSortedImpl(size_t k, size_t num_threads)
+          : k_(k),
+            num_threads_(num_threads),
+            complement_code_(KmerExtractor2Bit().complement_code()) {}
+
+    void add_sequence(std::string_view, const std::function<void(node_index)> &) {
+        throw std::runtime_error("Not implemented");
+    }
+
+    void add_sequences(const std::function<void(const CallSequence &)> &generate_sequences,
+                       const GetSkipper &get_skipper);
+
+    // Traverse graph mapping sequence to the graph nodes
+    // and run callback for each node until the termination condition is satisfied
+    void map_to_nodes(std::string_view sequence,
+                      const std::function<void(node_index)> &callback,
+                      const std::function<bool()> &terminate) const {
+        map_to_nodes_sequentially(sequence, callback, terminate);
+    }
+
+    // Traverse graph mapping sequence to the graph nodes
+    // and run callback for each node until the termination condition is satisfied.
+    // Guarantees that nodes are called in the same order as the input sequence.
+    void map_to_nodes_sequentially(std::string_view sequence,
+                                   const std::function<void(node_index)> &callback,
+                                   const std::function<bool()> &terminate) const {
+        for (const auto &[kmer, is_valid] : sequence_to_kmers(sequence)) {
+            if (terminate())
+                return;
+
+            callback(is_valid ? get_node_index(kmer) : npos);
+        }
+    }
+
+    void call_sequences(const CallPath &callback,
+                        size_t num_threads,
+                        bool kmers_in_single_form) const;
+
+    void call_outgoing_kmers(node_index node,
+                             const OutgoingEdgeCallback &callback) const {
+        assert(node > 0 && node <= num_nodes());
+
+        for (TAlphabet c = 0; c < alphabet().size(); ++c) {
+            Kmer next_kmer = get_kmer(node);
+            next_kmer.to_next(k_, c);
+            if (node_index next = get_node_index(next_kmer))
+                callback(next, seq_encoder_.decode(c));
+        }
+    }
+
+    void call_incoming_kmers(node_index node,
+                             const IncomingEdgeCallback &callback) const {
+        assert(node > 0 && node <= num_nodes());
+
+        // all k-mers ending with the same k-1 characters are stored contiguously
+        Kmer first = get_kmer(node);
+        first.to_prev(k_, 0);
+        const KmerWord suffix = first.data() >> kBitsPerChar;
+
+        auto it = std::lower_bound(kmers_.begin(), kmers_.end(), first.data());
+        for ( ; it != kmers_.end() && (*it >> kBitsPerChar) == suffix; ++it) {
+            callback(it - kmers_.begin() + 1, seq_encoder_.decode(Kmer(*it)[0]));
+        }
+    }
+
+    // Traverse the outgoing edge
+    node_index traverse(node_index node, char next_char) const {
+        assert(node > 0 && node <= num_nodes());
+
+        Kmer kmer = get_kmer(node);
+        kmer.to_next(k_, seq_encoder_.encode(next_char));
+        return get_node_index(kmer);
+    }
+
+    // Traverse the incoming edge
+    node_index traverse_back(node_index node, char prev_char) const {
+        assert(node > 0 && node <= num_nodes());
+
+        Kmer kmer = get_kmer(node);
+        kmer.to_prev(k_, seq_encoder_.encode(prev_char));
+        return get_node_index(kmer);
+    }
+
+    void adjacent_outgoing_nodes(node_index node,
+                                 const std::function<void(node_index)> &callback) const {
+        call_outgoing_kmers(node, [&](node_index next, char) { callback(next); });
+    }
+
+    void adjacent_incoming_nodes(node_index node,
+                                 const std::function<void(node_index)> &callback) const {
+        call_incoming_kmers(node, [&](node_index prev, char) { callback(prev); });
+    }
+
+    size_t outdegree(node_index node) const {
+        size_t outdegree = 0;
+        call_outgoing_kmers(node, [&](auto, auto) { outdegree++; });
+        return outdegree;
+    }
+
+    size_t indegree(node_index node) const {
+        size_t indegree = 0;
+        call_incoming_kmers(node, [&](auto, auto) { indegree++; });
+        return indegree;
+    }
+
+    node_index kmer_to_node(std::string_view kmer) const {
+        assert(kmer.length() == k_);
+
+        auto kmers = sequence_to_kmers(kmer);
+        assert(kmers.size() == 1);
+        return kmers[0].second ? get_node_index(kmers[0].first) : npos;
+    }
+
+    std::string get_node_sequence(node_index node) const {
+        assert(node > 0 && node <= num_nodes());
+        return seq_encoder_.kmer_to_sequence(get_kmer(node), k_);
+    }
+
+    size_t get_k() const { return k_; }
+    Mode get_mode() const { return BASIC; }
+
+    uint64_t num_nodes() const { return kmers_.size(); }
+
+    void serialize(const std::string &) const { throw std::runtime_error("Not implemented"); }
+    bool load(const std::string &) { throw std::runtime_error("Not implemented"); }
+
+    std::string file_extension() const { return DBGSorted::kExtension; }
+
+    const std::string& alphabet() const { return seq_encoder_.alphabet; }
+
+  private:
+    Vector<std::pair<Kmer, bool>> sequence_to_kmers(std::string_view sequence) const {
+        return seq_encoder_.sequence_to_kmers<Kmer>(sequence, k_);
+    }
+
+    Kmer get_kmer(node_index node) const { return Kmer(kmers_[node - 1]); }
+
+    node_index get_node_index(const Kmer &kmer) const {
+        auto it = std::lower_bound(kmers_.begin(), kmers_.end(), kmer.data());
+        return it != kmers_.end() && *it == kmer.data()
+                ? it - kmers_.begin() + 1
+                : npos;
+    }
+
+    Kmer reverse_complement(const Kmer &kmer) const {
+        KmerWord word = 0;
+        for (size_t i = 0; i < k_; ++i) {
+            word = (word << kBitsPerChar) | KmerWord(complement_code_[kmer[i]]);
+        }
+        return Kmer(word);
+    }
+
+    // Return the only outgoing node and set its last character to |c|.
+    // Return npos if there are no or multiple outgoing nodes not marked in |skipped|.
+    node_index get_single_outgoing(node_index node,
+                                   const sdsl::bit_vector &skipped,
+                                   char *c = NULL) const;
+    // Return the only incoming node or npos if there are no or multiple
+    // incoming nodes not marked in |skipped|.
+    node_index get_single_incoming(node_index node,
+                                   const sdsl::bit_vector &skipped) const;
+
+    void sort_and_remove_duplicates() {
+        ips4o::parallel::sort(kmers_.begin(), kmers_.end(),
+                              std::less<KmerWord>(), num_threads_);
+        kmers_.erase(std::unique(kmers_.begin(), kmers_.end()), kmers_.end());
+    }
+
+    size_t k_;
+    size_t num_threads_;
+
+    std::vector<KmerWord> kmers_;
+    KmerExtractor2Bit seq_encoder_;
+    const std::vector<TAlphabet> complement_code_;
+
+    static constexpr uint8_t kBitsPerChar = KMER::kBitsPerChar;
+};
+
+template <typename KMER>
+void DBGSortedImpl<KMER>
+::add_sequences(const std::function<void(const CallSequence &)> &generate_sequences,
+                const GetSkipper &get_skipper) {
+    // the first |num_sorted| k-mers are sorted and distinct
+    uint64_t num_sorted = kmers_.size();
+
+    std::vector<std::string> batch;
+    uint64_t batch_size = 0;
+
+    auto extract_kmers = [&]() {
+        #pragma omp parallel num_threads(num_threads_)
+        {
+            std::vector<KmerWord> buffer;
+
+            #pragma omp for schedule(dynamic)
+            for (size_t i = 0; i < batch.size(); ++i) {
+                std::function<bool()> skip;
+                if (get_skipper)
+                    skip = get_skipper(batch[i]);
+
+                for (const auto &[kmer, is_valid] : sequence_to_kmers(batch[i])) {
+                    // the skipper must be called for every k-mer
+                    bool skipped = skip && skip();
+                    if (is_valid && !skipped)
+                        buffer.push_back(kmer.data());
+                }
+            }
+
+            #pragma omp critical
+            kmers_.insert(kmers_.end(), buffer.begin(), buffer.end());
+        }
+
+        batch.clear();
+        batch_size = 0;
+
+        // keep the number of duplicate k-mers under control
+        if (kmers_.size() - num_sorted > std::max(num_sorted, kMinBufferSize)) {
+            sort_and_remove_duplicates();
+            num_sorted = kmers_.size();
+        }
+    };
+
+    generate_sequences([&](std::string_view sequence) {
+        if (sequence.size() < k_)
+            return;
+
+        batch.emplace_back(sequence);
+        batch_size += sequence.size();
+
+        if (batch_size >= kSequenceBatchSize)
+            extract_kmers();
+    });
+
+    extract_kmers();
+
+    if (num_sorted != kmers_.size())
+        sort_and_remove_duplicates();
+
+    kmers_.shrink_to_fit();
+}
+
+template <typename KMER>
+typename DBGSortedImpl<KMER>::node_index
+DBGSortedImpl<KMER>::get_single_outgoing(node_index node,
+                                         const sdsl::bit_vector &skipped,
+                                         char *c) const {
+    node_index single_next = npos;
+    bool multiple = false;
+    call_outgoing_kmers(node, [&](node_index next, char next_c) {
+        if (multiple || (skipped.size() && skipped[next]))
+            return;
+
+        if (single_next) {
+            multiple = true;
+            return;
+        }
+
+        single_next = next;
+        if (c)
+            *c = next_c;
+    });
+    return multiple ? npos : single_next;
+}
+
+template <typename KMER>
+typename DBGSortedImpl<KMER>::node_index
+DBGSortedImpl<KMER>::get_single_incoming(node_index node,
+                                         const sdsl::bit_vector &skipped) const {
+    node_index single_prev = npos;
+    bool multiple = false;
+    call_incoming_kmers(node, [&](node_index prev, char) {
+        if (skipped.size() && skipped[prev])
+            return;
+
+        multiple |= single_prev != npos;
+        single_prev = prev;
+    });
+    return multiple ? npos : single_prev;
+}
+
+/**
+ * Call unitigs in two passes over the sorted k-mers.
+ *
+ * A node continues a unitig if it has a single incoming node and that node
+ * has a single outgoing node. All other nodes start unitigs, which are
+ * extracted in parallel without any synchronization. The nodes left after
+ * that form isolated cycles and are extracted in a second pass.
+ */
+template <typename KMER>
+void DBGSortedImpl<KMER>::call_sequences(const CallPath &callback,
+                                         size_t num_threads,
+                                         bool kmers_in_single_form) const {
+    const uint64_t max_index = num_nodes();
+
+    // each thread processes its own 64-bit words, hence no atomics are needed
+    auto mark_nodes = [&](sdsl::bit_vector *marked, auto predicate) {
+        #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 16)
+        for (uint64_t w = 0; w <= max_index / 64; ++w) {
+            uint64_t end = std::min((w + 1) * 64, max_index + 1);
+            for (node_index node = std::max(w * 64, (uint64_t)1); node < end; ++node) {
+                if (predicate(node))
+                    (*marked)[node] = true;
+            }
+        }
+    };
+
+    // k-mers represented by their reverse complements
+    sdsl::bit_vector skipped;
+    if (kmers_in_single_form) {
+        skipped = sdsl::bit_vector(max_index + 1, false);
+        mark_nodes(&skipped, [&](node_index node) {
+            Kmer rev_comp = reverse_complement(get_kmer(node));
+            return rev_comp < get_kmer(node) && get_node_index(rev_comp);
+        });
+    }
+
+    auto is_skipped = [&](node_index node) {
+        return skipped.size() && skipped[node];
+    };
+
+    sdsl::bit_vector continues(max_index + 1, false);
+    mark_nodes(&continues, [&](node_index node) {
+        if (is_skipped(node))
+            return false;
+
+        node_index prev = get_single_incoming(node, skipped);
+        return prev && get_single_outgoing(prev, skipped) == node;
+    });
+
+    sdsl::bit_vector visited(max_index + 1, false);
+
+    auto call_path = [&](node_index node) {
+        std::vector<node_index> path = { node };
+        std::string sequence = get_node_sequence(node);
+        set_bit(visited.data(), node, true, __ATOMIC_RELAXED);
+
+        char c;
+        node_index next;
+        while ((next = get_single_outgoing(node, skipped, &c)) && continues[next]
+                    && !fetch_and_set_bit(visited.data(), next, true, __ATOMIC_RELAXED)) {
+            path.push_back(next);
+            sequence.push_back(c);
+            node = next;
+        }
+
+        callback(sequence, path);
+    };
+
+    #pragma omp parallel for num_threads(num_threads) schedule(dynamic, 1024)
+    for (node_index node = 1; node <= max_index; ++node) {
+        if (!continues[node] && !is_skipped(node))
+            call_path(node);
+    }
+
+    // the remaining nodes form simple cycles
+    for (node_index node = 1; node <= max_index; ++node) {
+        if (!visited[node] && !is_skipped(node))
+            call_path(node);
+    }
+}
+
+std::unique_ptr<DBGSorted::DBGSortedInterface>
+DBGSorted::initialize_graph(size_t k, size_t num_threads) {
+    if (k < 1 || k > 256 / KmerExtractor2Bit::bits_per_char) {
+        logger->error("For sorted graph, k must be between 1 and {}",
+                      256 / KmerExtractor2Bit::bits_per_char);
+        exit(1);
+    }
+
+    if (k * KmerExtractor2Bit::bits_per_char <= 64) {
+        return std::make_unique<DBGSortedImpl<KmerExtractor2Bit::Kmer64>>(k, num_threads);
+    } else if (k * KmerExtractor2Bit::bits_per_char <= 128) {
+        return std::make_unique<DBGSortedImpl<KmerExtractor2Bit::Kmer128>>(k, num_threads);
+    } else {
+        return std::make_unique<DBGSortedImpl<KmerExtractor2Bit::Kmer256>>(k, num_threads);
+    }
+}
+
+} // namespace graph
+} // namespace mtg
@@ -0,0 +1,157 @@
+#ifndef __DBG_SORTED_HPP__
+#define __DBG_SORTED_HPP__
+
+#include <iostream>
+
+#include "graph/representation/base/sequence_graph.hpp"
+
+
+namespace mtg {
+namespace graph {
+
+/**
+ * Static de Bruijn graph storing a sorted array of packed k-mers.
+ *
+ * Designed for indexing query batches: k-mers are extracted in parallel, sorted
+ * with ips4o and deduplicated, and the node index of a k-mer is its rank in the
+ * array (plus one). Thus, the graph takes exactly one word per k-mer.
+ * Since k-mers are sorted in co-lex order, all incoming k-mers of a node form
+ * a contiguous range in the array and are found with a single binary search.
+ *
+ * Only the basic mode is supported. The graph is kept in memory only and
+ * cannot be serialized.
+ */
+class DBGSorted : public DeBruijnGraph {
+  public:
+    typedef std::function<void(std::string_view)> CallSequence;
+    typedef std::function<std::function<bool()>(std::string_view)> GetSkipper;
+
+    explicit DBGSorted(size_t k, size_t num_threads = 1) {
+        sorted_dbg_ = initialize_graph(k, num_threads);
+    }
+
+    // Node indexes change when new k-mers are inserted, hence single sequences
+    // can't be added to this graph. Use add_sequences instead.
+    void add_sequence(std::string_view,
+                      const std::function<void(node_index)> & = [](node_index) {}) {
+        throw std::runtime_error("Not implemented");
+    }
+
+    // Insert all k-mers from the generated sequences to the graph in parallel.
+    // If passed, |get_skipper| is called for each sequence and the returned
+    // callback is called before each of its k-mers. A k-mer is skipped if that
+    // call returns `true` (see kmer::get_missing_kmer_skipper).
+    // Note: the k-mers are re-indexed, so all old node indexes are invalidated.
+    void add_sequences(const std::function<void(const CallSequence &)> &generate_sequences,
+                       const GetSkipper &get_skipper = {}) {
+        sorted_dbg_->add_sequences(generate_sequences, get_skipper);
+    }
+
+    // Traverse graph mapping sequence to the graph nodes
+    // and run callback for each node until the termination condition is satisfied
+    void map_to_nodes(std::string_view sequence,
+                      const std::function<void(node_index)> &callback,
+                      const std::function<bool()> &terminate = [](){ return false; }) const {
+        sorted_dbg_->map_to_nodes(sequence, callback, terminate);
+    }
+
+    // Traverse graph mapping sequence to the graph nodes
+    // and run callback for each node until the termination condition is satisfied.
+    // Guarantees that nodes are called in the same order as the input sequence.
+    void map_to_nodes_sequentially(std::string_view sequence,
+                                   const std::function<void(node_index)> &callback,
+                                   const std::function<bool()> &terminate = [](){ return false; }) const {
+        sorted_dbg_->map_to_nodes_sequentially(sequence, callback, terminate);
+    }
+
+    /**
+     * Call unitigs in parallel. The unitigs are found by a single pass over
+     * the sorted k-mers, each k-mer is called exactly once.
+     * If |kmers_in_single_form| is true, a k-mer is skipped if its reverse
+     * complement is also in the graph and is smaller than the k-mer itself.
+     */
+    void call_sequences(const CallPath &callback,
+                        size_t num_threads = 1,
+                        bool kmers_in_single_form = false) const {
+        sorted_dbg_->call_sequences(callback, num_threads, kmers_in_single_form);
+    }
+
+    void call_outgoing_kmers(node_index node,
+                             const OutgoingEdgeCallback &callback) const {
+        sorted_dbg_->call_outgoing_kmers(node, callback);
+    }
+
+    void call_incoming_kmers(node_index node,
+                             const IncomingEdgeCallback &callback) const {
+        sorted_dbg_->call_incoming_kmers(node, callback);
+    }
+
+    // Traverse the outgoing edge
+    node_index traverse(node_index node, char next_char) const {
+        return sorted_dbg_->traverse(node, next_char);
+    }
+
+    // Traverse the incoming edge
+    node_index traverse_back(node_index node, char prev_char) const {
+        return sorted_dbg_->traverse_back(node, prev_char);
+    }
+
+    // Given a node index, call the target nodes of all edges outgoing from it.
+    void adjacent_outgoing_nodes(node_index node,
+                                 const std::function<void(node_index)> &callback) const {
+        sorted_dbg_->adjacent_outgoing_nodes(node, callback);
+    }
+
+    // Given a node index, call the source nodes of all edges incoming to it.
+    void adjacent_incoming_nodes(node_index node,
+                                 const std::function<void(node_index)> &callback) const {
+        sorted_dbg_->adjacent_incoming_nodes(node, callback);
+    }
+
+    size_t outdegree(node_index node) const { return sorted_dbg_->outdegree(node); }
+    size_t indegree(node_index node) const { return sorted_dbg_->indegree(node); }
+
+    node_index kmer_to_node(std::string_view kmer) const {
+        return sorted_dbg_->kmer_to_node(kmer);
+    }
+
+    std::string get_node_sequence(node_index node) const {
+        return sorted_dbg_->get_node_sequence(node);
+    }
+
+    size_t get_k() const { return sorted_dbg_->get_k(); }
+    Mode get_mode() const { return BASIC; }
+
+    uint64_t num_nodes() const { return sorted_dbg_->num_nodes(); }
+
+    void serialize(std::ostream &) const { throw std::runtime_error("Not implemented"); }
+    void serialize(const std::string &) const { throw std::runtime_error("Not implemented"); }
+
+    bool load(std::istream &) { throw std::runtime_error("Not implemented"); }
+    bool load(const std::string &) { throw std::runtime_error("Not implemented"); }
+
+    std::string file_extension() const { return kExtension; }
+
+    const std::string& alphabet() const { return sorted_dbg_->alphabet(); }
+
+    static constexpr auto kExtension = ".sorteddbg";
+
+    class DBGSortedInterface : public DeBruijnGraph {
+      public:
+        virtual ~DBGSortedInterface() {}
+        virtual void add_sequences(const std::function<void(const CallSequence &)> &generate_sequences,
+                                   const GetSkipper &get_skipper) = 0;
+        const std::string& alphabet() const = 0;
+    };
+
+  private:
+    static std::unique_ptr<DBGSortedInterface>
+    initialize_graph(size_t k, size_t num_threads);
+
+    std::unique_ptr<DBGSortedInterface> sorted_dbg_;
+};
+
+} // namespace graph
+} // namespace mtg
+
+#endif // __DBG_SORTED_HPP__
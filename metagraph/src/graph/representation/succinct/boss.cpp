@@ -18,10 +18,12 @@
 #include "common/logger.hpp"
 #include "common/algorithms.hpp"
 #include "common/utils/template_utils.hpp"
+#include "common/utils/file_utils.hpp"
 #include "common/vectors/vector_algorithm.hpp"
 #include "common/vectors/bit_vector_sdsl.hpp"
 #include "common/vectors/bit_vector_dyn.hpp"
 #include "common/vectors/bit_vector_adaptive.hpp"
+#include "common/vectors/bit_vector_cl.hpp"
 #include "boss_construct.hpp"
 
 
@@ -243,7 +245,12 @@ void BOSS::serialize(std::ofstream &outstream) const {
     W_->serialize(outstream);
 
     // write last array
-    last_->serialize(outstream);
+    if (dynamic_cast<const bit_vector_cl*>(last_)) {
+        // keep the format, the last array is stored as bit_vector_stat
+        bit_vector_stat(last_->to_vector()).serialize(outstream);
+    } else {
+        last_->serialize(outstream);
+    }
     outstream.flush();
 }
 
@@ -341,6 +348,15 @@ bool BOSS::load(std::ifstream &instream) {
             return false;
         }
 
+        // The last array is stored as bit_vector_stat. Convert it unless the
+        // file is memory mapped, in which case the loaded vector stays in the
+        // shared page cache and a converted copy would take private memory.
+        if (state == State::FAST && !utils::with_mmap()) {
+            bit_vector *last_fast = new bit_vector_cl(last_->convert_to<bit_vector_cl>());
+            delete last_;
+            last_ = last_fast;
+        }
+
         recompute_NF();
 
         return instream.good();
@@ -1113,7 +1129,7 @@ void BOSS::switch_state(State new_state) {
             break;
         }
         case State::FAST: {
-            convert<wavelet_tree_fast, bit_vector_stat>(&W_, &last_);
+            convert<wavelet_tree_fast, bit_vector_cl>(&W_, &last_);
             break;
         }
         case State::DYN: {
@@ -317,7 +317,8 @@ class BOSS {
      *
      * FAST: is the fastest but large
      *      Representation:
-     *          last -- bit_vector_stat
+     *          last -- bit_vector_cl (serialized as bit_vector_stat,
+     *                  which is kept when loaded with utils::with_mmap())
      *             W -- wavelet_tree_fast
      *
      * DYN: is a dynamic representation supporting insert and delete
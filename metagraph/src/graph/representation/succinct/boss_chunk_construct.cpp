@@ -1029,6 +1029,10 @@ class BOSSChunkConstructor : public IBOSSChunkConstructor {
         kmer_collector_.add_sequences(std::move(sequences));
     }
 
+    void add_kmers(size_t k, std::vector<uint8_t>&& codes, std::vector<uint64_t>&& counts) {
+        kmer_collector_.add_kmers(k, std::move(codes), std::move(counts));
+    }
+
     BOSS::Chunk build_chunk() {
         BOSS::Chunk result;
 
@@ -28,6 +28,10 @@ class BOSSConstructor : public IGraphConstructor<BOSS> {
         constructor_->add_sequences(std::move(sequences));
     }
 
+    void add_kmers(size_t k, std::vector<uint8_t>&& codes, std::vector<uint64_t>&& counts) {
+        constructor_->add_kmers(k, std::move(codes), std::move(counts));
+    }
+
     void build_graph(BOSS *graph) {
         auto chunk = constructor_->build_chunk();
         // initialize graph from the chunk built
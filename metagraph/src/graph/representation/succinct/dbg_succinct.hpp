@@ -145,7 +145,7 @@ class DBGSuccinct : public DeBruijnGraph {
      *
      *  FAST: is the fastest but large
      *      Representation:
-     *            BOSS::last -- bit_vector_stat
+     *            BOSS::last -- bit_vector_cl (bit_vector_stat if memory mapped)
      *               BOSS::W -- wavelet_tree_fast
      *           valid_edges -- bit_vector_stat
      *
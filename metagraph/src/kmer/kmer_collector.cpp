@@ -1,5 +1,7 @@
 #include "kmer_collector.hpp"
 
+#include <memory>
+#include <tuple>
 #include <type_traits>
 
 #include "common/utils/file_utils.hpp"
@@ -126,6 +128,95 @@ void count_kmers(std::function<void(CallStringCount)> generate_reads,
     }
 }
 
+template <typename KMER, class KmerExtractor, class Container>
+void pack_kmers(const std::vector<uint8_t> &codes,
+                const std::vector<uint64_t> &counts,
+                size_t k,
+                typename KmerCollector<KMER, KmerExtractor, Container>::Mode mode,
+                Container *kmers,
+                const std::vector<typename KmerExtractor::TAlphabet> &suffix) {
+    static_assert(KMER::kBitsPerChar == KmerExtractor::bits_per_char);
+    static_assert(std::is_same_v<typename KMER::WordType, typename Container::key_type>);
+    assert(codes.size() == counts.size() * k);
+
+    using Mode = typename KmerCollector<KMER, KmerExtractor, Container>::Mode;
+    using TAlphabet = typename KmerExtractor::TAlphabet;
+    using Value = typename Container::value_type;
+
+    KmerExtractor kmer_extractor;
+
+    // map the nucleotide codes to the k-mer alphabet
+    const TAlphabet encoded[4] = { kmer_extractor.encode('A'),
+                                   kmer_extractor.encode('C'),
+                                   kmer_extractor.encode('G'),
+                                   kmer_extractor.encode('T') };
+
+    std::vector<TAlphabet> forward(k);
+    std::vector<TAlphabet> reverse(k);
+
+    Vector<Value> buffer;
+    buffer.reserve(kBufferSize);
+
+    auto push = [&](const KMER &kmer, uint64_t count) {
+        if constexpr(std::is_same_v<typename KMER::WordType, Value>) {
+            std::ignore = count;
+            buffer.push_back(kmer.data());
+        } else {
+            buffer.emplace_back(kmer.data(), std::min(count, kmers->max_count()));
+        }
+
+        if (buffer.size() > 0.9 * kBufferSize) {
+            kmers->insert(buffer.begin(), buffer.end());
+            buffer.resize(0);
+        }
+    };
+
+    for (size_t i = 0; i < counts.size(); ++i) {
+        const uint8_t *kmer = codes.data() + i * k;
+        for (size_t j = 0; j < k; ++j) {
+            assert(kmer[j] < 4);
+            forward[j] = encoded[kmer[j]];
+            reverse[k - 1 - j] = encoded[3 - kmer[j]];
+        }
+
+        bool suffix_matched_forward = KMER::match_suffix(forward.data(), k, suffix);
+
+        if (mode == Mode::BASIC) {
+            if (suffix_matched_forward)
+                push(KMER(forward.data(), k), counts[i]);
+            continue;
+        }
+
+        bool suffix_matched_reverse = KMER::match_suffix(reverse.data(), k, suffix);
+
+        if (mode == Mode::BOTH) {
+            if (suffix_matched_forward)
+                push(KMER(forward.data(), k), counts[i]);
+            if (suffix_matched_reverse)
+                push(KMER(reverse.data(), k), counts[i]);
+            continue;
+        }
+
+        // keep only the canonical (smallest) form
+        if (!suffix_matched_forward && !suffix_matched_reverse)
+            continue;
+
+        KMER forward_kmer(forward.data(), k);
+        KMER reverse_kmer(reverse.data(), k);
+
+        if (forward_kmer <= reverse_kmer) {
+            if (suffix_matched_forward)
+                push(forward_kmer, counts[i]);
+        } else {
+            if (suffix_matched_reverse)
+                push(reverse_kmer, counts[i]);
+        }
+    }
+
+    if (buffer.size())
+        kmers->insert(buffer.begin(), buffer.end());
+}
+
 template <typename KMER, class KmerExtractor, class Container>
 KmerCollector<KMER, KmerExtractor, Container>
 ::KmerCollector(size_t k,
@@ -227,6 +318,38 @@ void KmerCollector<KMER, KmerExtractor, Container>
     });
 }
 
+template <typename KMER, class KmerExtractor, class Container>
+void KmerCollector<KMER, KmerExtractor, Container>
+::add_kmers(size_t k, std::vector<uint8_t>&& codes, std::vector<uint64_t>&& counts) {
+    assert(codes.size() == counts.size() * k);
+
+    if (k != k_ || (std::is_same_v<Extractor, KmerExtractorBOSS>
+                        && filter_suffix_encoded_.size())) {
+        // fall back to the extraction of k-mers from sequences, KmerExtractorBOSS
+        // adds dummy k-mers to each sequence when the suffix filter is set
+        std::vector<std::pair<std::string, uint64_t>> sequences(counts.size());
+        for (size_t i = 0; i < counts.size(); ++i) {
+            sequences[i].first.resize(k);
+            for (size_t j = 0; j < k; ++j) {
+                sequences[i].first[j] = "ACGT"[codes[i * k + j]];
+            }
+            sequences[i].second = counts[i];
+        }
+        add_sequences(std::move(sequences));
+        return;
+    }
+
+    // capture a pointer to avoid copying the batch (see #add_sequences)
+    auto batch = std::make_shared<std::pair<std::vector<uint8_t>, std::vector<uint64_t>>>(
+        std::move(codes), std::move(counts)
+    );
+    thread_pool_.enqueue([this, batch]() {
+        pack_kmers<KMER, Extractor, Container>(batch->first, batch->second,
+                                               k_, mode_, kmers_.get(),
+                                               filter_suffix_encoded_);
+    });
+}
+
 template <typename KMER, class KmerExtractor, class Container>
 void KmerCollector<KMER, KmerExtractor, Container>::join() {
     batcher_.process_all_buffered();
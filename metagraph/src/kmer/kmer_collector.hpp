@@ -85,6 +85,14 @@ class KmerCollector {
     void add_sequences(std::vector<std::string>&& sequences);
     void add_sequences(std::vector<std::pair<std::string, uint64_t>>&& sequences);
 
+    // Add k-mers given as nucleotide codes (A=0, C=1, G=2, T=3), |k| codes per
+    // k-mer, with their counts (see seq_io::read_kmer_batches).
+    // The k-mers are packed right from the codes, without any extraction from
+    // sequences, unless |k| differs from the k-mer length of the collector or
+    // the extractor adds dummy k-mers to sequences (as KmerExtractorBOSS does
+    // with a suffix filter).
+    void add_kmers(size_t k, std::vector<uint8_t>&& codes, std::vector<uint64_t>&& counts);
+
     // FYI: This function should be used only in special cases.
     //      In general, use `add_sequences` if possible, to make use of multiple threads.
     void add_kmer(const KMER &kmer) { kmers_->insert(&kmer.data(), &kmer.data() + 1); }
@@ -138,6 +146,15 @@ void count_kmers(std::function<void(CallStringCount)> generate_reads,
                  Container *kmers,
                  const std::vector<typename KmerExtractor::TAlphabet> &suffix);
 
+/** Visible For Testing */
+template <typename KMER, class KmerExtractor, class Container>
+void pack_kmers(const std::vector<uint8_t> &codes,
+                const std::vector<uint64_t> &counts,
+                size_t k,
+                typename KmerCollector<KMER, KmerExtractor, Container>::Mode mode,
+                Container *kmers,
+                const std::vector<typename KmerExtractor::TAlphabet> &suffix);
+
 } // namespace kmer
 } // namespace mtg
 
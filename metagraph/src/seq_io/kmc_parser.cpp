@@ -9,6 +9,24 @@ namespace mtg {
 namespace seq_io {
 
 const auto kFileSuffixes = { ".kmc_suf", ".kmc_pre" };
+// number of k-mers passed to the callback at once
+const size_t kBatchSize = 100'000;
+
+static void open_kmc_database(const std::string &kmc_filename,
+                              CKMCFile *kmc_database,
+                              uint64_t min_count,
+                              uint64_t max_count) {
+    std::string kmc_base_filename = kmc_filename;
+    for (const auto &suffix : kFileSuffixes) {
+        kmc_base_filename = utils::remove_suffix(kmc_base_filename, suffix);
+    }
+
+    if (!kmc_database->OpenForListing(kmc_base_filename))
+        throw std::runtime_error("Error: Can't open KMC database " + kmc_base_filename);
+
+    kmc_database->SetMinCount(min_count);
+    kmc_database->SetMaxCount(max_count - 1);
+}
 
 void read_kmers(const std::string &kmc_filename,
                 const std::function<void(std::string_view)> &callback,
@@ -32,17 +50,8 @@ void read_kmers(const std::string &kmc_filename,
     if (min_count >= max_count)
         return;
 
-    std::string kmc_base_filename = kmc_filename;
-    for (const auto &suffix : kFileSuffixes) {
-        kmc_base_filename = utils::remove_suffix(kmc_base_filename, suffix);
-    }
-
     CKMCFile kmc_database;
-    if (!kmc_database.OpenForListing(kmc_base_filename))
-        throw std::runtime_error("Error: Can't open KMC database " + kmc_base_filename);
-
-    kmc_database.SetMinCount(min_count);
-    kmc_database.SetMaxCount(max_count - 1);
+    open_kmc_database(kmc_filename, &kmc_database, min_count, max_count);
 
     size_t k = kmc_database.KmerLength();
     CKmerAPI kmer(k);
@@ -61,5 +70,56 @@ void read_kmers(const std::string &kmc_filename,
     kmc_database.Close();
 }
 
+void read_kmer_batches(const std::string &kmc_filename,
+                       const CallKmerBatch &callback,
+                       bool call_both_from_canonical,
+                       uint64_t min_count,
+                       uint64_t max_count) {
+    if (min_count >= max_count)
+        return;
+
+    CKMCFile kmc_database;
+    open_kmc_database(kmc_filename, &kmc_database, min_count, max_count);
+
+    const size_t k = kmc_database.KmerLength();
+    const bool call_both = call_both_from_canonical && kmc_database.GetBothStrands();
+    CKmerAPI kmer(k);
+    uint64 count;
+
+    std::vector<uint8_t> codes;
+    std::vector<uint64_t> counts;
+    codes.reserve(kBatchSize * k);
+    counts.reserve(kBatchSize);
+
+    while (kmc_database.ReadNextKmer(kmer, count)) {
+        size_t begin = codes.size();
+        for (uint32 i = 0; i < k; ++i) {
+            codes.push_back(kmer.get_num_symbol(i));
+        }
+        counts.push_back(count);
+
+        if (call_both) {
+            // the reverse complement is computed on codes, the complement of c is 3 - c
+            for (size_t i = 0; i < k; ++i) {
+                codes.push_back(3 - codes[begin + k - 1 - i]);
+            }
+            counts.push_back(count);
+        }
+
+        if (counts.size() >= kBatchSize) {
+            callback(k, std::move(codes), std::move(counts));
+            codes.clear();
+            counts.clear();
+            codes.reserve(kBatchSize * k);
+            counts.reserve(kBatchSize);
+        }
+    }
+
+    if (counts.size())
+        callback(k, std::move(codes), std::move(counts));
+
+    kmc_database.Close();
+}
+
 } // namespace seq_io
 } // namespace mtg
@@ -1,8 +1,10 @@
 #ifndef __KMC_KMERS__
 #define __KMC_KMERS__
 
+#include <cstdint>
 #include <functional>
 #include <string>
+#include <vector>
 
 
 namespace mtg {
@@ -32,6 +34,20 @@ void read_kmers(const std::string &kmc_filename,
                 uint64_t min_count = 1,
                 uint64_t max_count = -1);
 
+typedef std::function<void(size_t k,
+                           std::vector<uint8_t>&& codes,
+                           std::vector<uint64_t>&& counts)> CallKmerBatch;
+
+// Read k-mers from KMC database in batches, without decoding them into strings.
+// Each batch stores the k-mers as consecutive nucleotide codes (A=0, C=1, G=2, T=3),
+// |k| codes per k-mer, and their counts in the same order.
+// The reverse-complement k-mers are added as in `read_kmers`.
+void read_kmer_batches(const std::string &kmc_filename,
+                       const CallKmerBatch &callback,
+                       bool call_both_from_canonical,
+                       uint64_t min_count = 1,
+                       uint64_t max_count = -1);
+
 } // namespace seq_io
 } // namespace mtg
 
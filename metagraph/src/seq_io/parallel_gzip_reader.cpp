@@ -0,0 +1,337 @@
+#include "parallel_gzip_reader.hpp"
+
+#include <cstring>
+#include <iostream>
+
+
+namespace mtg {
+namespace seq_io {
+
+// gzip header with the 'BC' extra subfield storing the size of the block
+const size_t kBGZFHeaderSize = 18;
+// upper bound on the size of an inflated BGZF block
+const size_t kBGZFMaxBlockSize = 1 << 16;
+// compressed bytes inflated in a single task (~64 BGZF blocks)
+const size_t kBGZFBatchSize = 1 << 20;
+const size_t kBatchesInFlightPerThread = 2;
+
+// decompressed bytes produced by a single task for regular gzip and plain files
+const size_t kChunkSize = 1 << 20;
+const size_t kInputBufferSize = 1 << 18;
+const size_t kReadAheadDepth = 4;
+
+
+static bool is_bgzf_header(const unsigned char *header) {
+    return header[0] == 0x1f && header[1] == 0x8b && header[2] == Z_DEFLATED
+        && (header[3] & 4) // FLG.FEXTRA
+        && header[10] == 6 && header[11] == 0 // XLEN
+        && header[12] == 'B' && header[13] == 'C'
+        && header[14] == 2 && header[15] == 0; // SLEN
+}
+
+static size_t get_bgzf_block_size(const unsigned char *header) {
+    return (header[16] | (header[17] << 8)) + 1;
+}
+
+// BGZF blocks of all readers are inflated on the same workers. The pool is never
+// destroyed, so that exit() called on one of its threads doesn't try to join it.
+static ThreadPool& get_bgzf_workers(size_t *num_workers = NULL) {
+    static const size_t kNumWorkers = std::max(get_num_threads(), 1u);
+    static ThreadPool *workers = new ThreadPool(kNumWorkers);
+    if (num_workers)
+        *num_workers = kNumWorkers;
+    return *workers;
+}
+
+// the number of BGZF readers currently open
+static std::atomic<size_t> num_bgzf_readers { 0 };
+
+// ISIZE, the size of the uncompressed data stored in the gzip trailer
+static uint32_t get_gzip_member_isize(const unsigned char *member_end) {
+    return static_cast<uint32_t>(member_end[-4])
+            | static_cast<uint32_t>(member_end[-3]) << 8
+            | static_cast<uint32_t>(member_end[-2]) << 16
+            | static_cast<uint32_t>(member_end[-1]) << 24;
+}
+
+
+ParallelGzipReader::ParallelGzipReader(const std::string &filename)
+      : filename_(filename), in_(filename, std::ios::binary) {
+    if (!in_.good()) {
+        std::cerr << "ERROR: Cannot read from file " << filename_ << std::endl;
+        exit(1);
+    }
+
+    unsigned char header[kBGZFHeaderSize];
+    in_.read(reinterpret_cast<char*>(header), kBGZFHeaderSize);
+    size_t header_size = in_.gcount();
+    in_.clear();
+    in_.seekg(0);
+
+    if (header_size >= 2 && header[0] == 0x1f && header[1] == 0x8b) {
+        format_ = header_size == kBGZFHeaderSize && is_bgzf_header(header)
+                    ? BGZF
+                    : GZIP;
+    } else {
+        format_ = UNCOMPRESSED;
+    }
+
+    if (format_ == BGZF) {
+        ++num_bgzf_readers;
+    } else {
+        read_ahead_ = std::make_unique<AsyncIOQueue>(kReadAheadDepth);
+    }
+
+    if (format_ == GZIP) {
+        zstream_ = z_stream();
+        // decode gzip members only
+        if (inflateInit2(&zstream_, 15 + 16) != Z_OK) {
+            std::cerr << "ERROR: Failed to initialize zlib stream" << std::endl;
+            exit(1);
+        }
+        in_buffer_.resize(kInputBufferSize);
+    }
+
+    // start decompressing right away
+    schedule();
+}
+
+ParallelGzipReader::~ParallelGzipReader() {
+    // the tasks refer to the input stream and the inflate state
+    for (const auto &chunk : pending_) {
+        chunk.wait();
+    }
+    read_ahead_.reset();
+
+    if (format_ == BGZF)
+        --num_bgzf_readers;
+
+    if (format_ == GZIP)
+        inflateEnd(&zstream_);
+}
+
+size_t ParallelGzipReader::read(void *buf, size_t len) {
+    char *out = static_cast<char*>(buf);
+    size_t num_read = 0;
+
+    while (num_read < len) {
+        if (!chunk_ || chunk_pos_ == chunk_->size()) {
+            if (pending_.empty())
+                break;
+
+            current_ = std::move(pending_.front());
+            pending_.pop_front();
+            schedule();
+
+            chunk_ = &current_.get();
+            chunk_pos_ = 0;
+            continue;
+        }
+
+        size_t size = std::min(len - num_read, chunk_->size() - chunk_pos_);
+        std::memcpy(out + num_read, chunk_->data() + chunk_pos_, size);
+        chunk_pos_ += size;
+        num_read += size;
+    }
+
+    return num_read;
+}
+
+size_t ParallelGzipReader::max_pending() const {
+    if (format_ != BGZF)
+        return kReadAheadDepth;
+
+    // keep all workers busy, but don't let each of the readers parsed
+    // concurrently buffer as much data as a single reader would
+    size_t num_workers;
+    get_bgzf_workers(&num_workers);
+    return std::max(kBatchesInFlightPerThread,
+                    kBatchesInFlightPerThread * num_workers
+                        / std::max(num_bgzf_readers.load(), size_t(1)));
+}
+
+void ParallelGzipReader::schedule() {
+    const size_t max_pending = this->max_pending();
+    while (pending_.size() < max_pending && !end_of_input_) {
+        switch (format_) {
+            case BGZF: {
+                std::string blocks = read_bgzf_blocks();
+                if (blocks.empty()) {
+                    end_of_input_ = true;
+                    break;
+                }
+                pending_.push_back(get_bgzf_workers().enqueue(
+                    [this](const std::string &batch) {
+                        return inflate_bgzf_blocks(batch, filename_);
+                    },
+                    std::move(blocks)
+                ));
+                break;
+            }
+            case GZIP:
+                pending_.push_back(read_ahead_->submit([this]() {
+                    return inflate_next_chunk();
+                }));
+                break;
+            case UNCOMPRESSED:
+                pending_.push_back(read_ahead_->submit([this]() {
+                    return read_next_chunk();
+                }));
+                break;
+        }
+    }
+}
+
+std::string ParallelGzipReader::read_bgzf_blocks() {
+    std::string blocks;
+
+    while (blocks.size() < kBGZFBatchSize) {
+        unsigned char header[kBGZFHeaderSize];
+        in_.read(reinterpret_cast<char*>(header), kBGZFHeaderSize);
+        if (!in_.gcount())
+            break;
+
+        if (static_cast<size_t>(in_.gcount()) != kBGZFHeaderSize
+                || !is_bgzf_header(header)) {
+            std::cerr << "ERROR: Bad BGZF block in file " << filename_
+                      << ". All gzip members in a BGZF file must be BGZF blocks"
+                      << std::endl;
+            exit(1);
+        }
+
+        size_t block_size = get_bgzf_block_size(header);
+        if (block_size < kBGZFHeaderSize + 8) {
+            std::cerr << "ERROR: Bad BGZF block in file " << filename_ << std::endl;
+            exit(1);
+        }
+
+        size_t offset = blocks.size();
+        blocks.resize(offset + block_size);
+        std::memcpy(blocks.data() + offset, header, kBGZFHeaderSize);
+        in_.read(blocks.data() + offset + kBGZFHeaderSize,
+                 block_size - kBGZFHeaderSize);
+
+        if (static_cast<size_t>(in_.gcount()) != block_size - kBGZFHeaderSize) {
+            std::cerr << "ERROR: Truncated BGZF block in file " << filename_ << std::endl;
+            exit(1);
+        }
+    }
+
+    return blocks;
+}
+
+std::string ParallelGzipReader::inflate_bgzf_blocks(const std::string &blocks,
+                                                    const std::string &filename) {
+    const auto *begin = reinterpret_cast<const unsigned char*>(blocks.data());
+    const auto *end = begin + blocks.size();
+
+    size_t total_size = 0;
+    for (const auto *block = begin; block < end; block += get_bgzf_block_size(block)) {
+        size_t isize = get_gzip_member_isize(block + get_bgzf_block_size(block));
+        if (isize > kBGZFMaxBlockSize) {
+            std::cerr << "ERROR: Bad BGZF block in file " << filename << std::endl;
+            exit(1);
+        }
+        total_size += isize;
+    }
+
+    std::string result(total_size, '\0');
+
+    z_stream strm = z_stream();
+    if (inflateInit2(&strm, 15 + 16) != Z_OK) {
+        std::cerr << "ERROR: Failed to initialize zlib stream" << std::endl;
+        exit(1);
+    }
+
+    size_t offset = 0;
+    for (const auto *block = begin; block < end; block += get_bgzf_block_size(block)) {
+        size_t block_size = get_bgzf_block_size(block);
+        size_t isize = get_gzip_member_isize(block + block_size);
+
+        inflateReset(&strm);
+        strm.next_in = const_cast<Bytef*>(block);
+        strm.avail_in = block_size;
+        strm.next_out = reinterpret_cast<Bytef*>(result.data() + offset);
+        strm.avail_out = isize;
+
+        if (inflate(&strm, Z_FINISH) != Z_STREAM_END
+                || strm.avail_out) {
+            std::cerr << "ERROR: Failed to inflate BGZF block in file "
+                      << filename << std::endl;
+            exit(1);
+        }
+        offset += isize;
+    }
+
+    inflateEnd(&strm);
+
+    return result;
+}
+
+std::string ParallelGzipReader::inflate_next_chunk() {
+    if (end_of_input_)
+        return "";
+
+    std::string chunk(kChunkSize, '\0');
+    zstream_.next_out = reinterpret_cast<Bytef*>(chunk.data());
+    zstream_.avail_out = chunk.size();
+
+    while (zstream_.avail_out) {
+        if (!zstream_.avail_in) {
+            in_.read(in_buffer_.data(), in_buffer_.size());
+            zstream_.next_in = reinterpret_cast<Bytef*>(in_buffer_.data());
+            zstream_.avail_in = in_.gcount();
+
+            if (!zstream_.avail_in) {
+                if (!member_ended_) {
+                    std::cerr << "ERROR: Unexpected end of gzip stream in file "
+                              << filename_ << std::endl;
+                    exit(1);
+                }
+                end_of_input_ = true;
+                break;
+            }
+        }
+
+        if (member_ended_) {
+            // Another gzip member follows. As in gzread, ignore trailing
+            // garbage if it doesn't start with a gzip header.
+            if (zstream_.next_in[0] != 0x1f) {
+                end_of_input_ = true;
+                break;
+            }
+            inflateReset(&zstream_);
+            member_ended_ = false;
+        }
+
+        int ret = inflate(&zstream_, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            member_ended_ = true;
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            std::cerr << "ERROR: Failed to inflate gzip stream in file "
+                      << filename_ << ": " << (zstream_.msg ? zstream_.msg : "")
+                      << std::endl;
+            exit(1);
+        }
+    }
+
+    chunk.resize(chunk.size() - zstream_.avail_out);
+    return chunk;
+}
+
+std::string ParallelGzipReader::read_next_chunk() {
+    if (end_of_input_)
+        return "";
+
+    std::string chunk(kChunkSize, '\0');
+    in_.read(chunk.data(), chunk.size());
+    chunk.resize(in_.gcount());
+
+    if (in_.eof())
+        end_of_input_ = true;
+
+    return chunk;
+}
+
+} // namespace seq_io
+} // namespace mtg
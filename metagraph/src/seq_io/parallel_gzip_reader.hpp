@@ -0,0 +1,89 @@
+#ifndef __PARALLEL_GZIP_READER_HPP__
+#define __PARALLEL_GZIP_READER_HPP__
+
+#include <atomic>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "common/threads/threading.hpp"
+
+
+namespace mtg {
+namespace seq_io {
+
+/**
+ * A reader of plain or gzip-compressed files, which decompresses the data
+ * on worker threads ahead of the consumer.
+ *
+ * BGZF files (concatenations of independent gzip members of at most 64 KiB,
+ * written by bgzip or htslib) are split into batches of blocks, and these are
+ * inflated in parallel on a pool of get_num_threads() workers. The pool is
+ * shared by all readers, so parsing many files concurrently does not multiply
+ * the number of threads, and the batches in flight are split among the BGZF
+ * readers open at the same time. Regular gzip streams cannot
+ * be split without decompressing them, so they are inflated on a dedicated
+ * thread, concurrently with the consumer. Uncompressed files are prefetched
+ * in the same way. The data is always returned in the original order.
+ */
+class ParallelGzipReader {
+  public:
+    explicit ParallelGzipReader(const std::string &filename);
+
+    ParallelGzipReader(const ParallelGzipReader &) = delete;
+    ParallelGzipReader& operator=(const ParallelGzipReader &) = delete;
+
+    ~ParallelGzipReader();
+
+    // Copy up to |len| bytes of decompressed data to |buf|.
+    // Return the number of bytes copied, 0 if the end of the file is reached.
+    size_t read(void *buf, size_t len);
+
+    bool is_bgzf() const { return format_ == BGZF; }
+
+    const std::string& get_filename() const { return filename_; }
+
+  private:
+    enum Format { UNCOMPRESSED, GZIP, BGZF };
+
+    // submit new decompression tasks until the queue is full
+    void schedule();
+    size_t max_pending() const;
+
+    std::string read_bgzf_blocks();
+    static std::string inflate_bgzf_blocks(const std::string &blocks,
+                                           const std::string &filename);
+    std::string inflate_next_chunk();
+    std::string read_next_chunk();
+
+    std::string filename_;
+    std::ifstream in_;
+    Format format_;
+
+    // inflated (or read) on a dedicated thread in the order of submission
+    std::unique_ptr<AsyncIOQueue> read_ahead_;
+
+    // chunks of decompressed data, in the original order
+    std::deque<std::shared_future<std::string>> pending_;
+    std::atomic<bool> end_of_input_ { false };
+
+    // the chunk currently read from
+    std::shared_future<std::string> current_;
+    const std::string *chunk_ = NULL;
+    size_t chunk_pos_ = 0;
+
+    // state of the streaming inflate for regular gzip files
+    z_stream zstream_;
+    std::vector<char> in_buffer_;
+    bool member_ended_ = false;
+};
+
+} // namespace seq_io
+} // namespace mtg
+
+#endif // __PARALLEL_GZIP_READER_HPP__
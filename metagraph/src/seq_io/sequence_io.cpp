@@ -7,6 +7,7 @@
 #include "common/seq_tools/reverse_complement.hpp"
 #include "common/utils/string_utils.hpp"
 #include "vcf_parser.hpp"
+#include "parallel_gzip_reader.hpp"
 
 
 namespace mtg {
@@ -21,6 +22,68 @@ __KS_INLINED(gzread)
 __KSEQ_BASIC(/**/, gzFile)
 __KSEQ_READ(/**/)
 
+namespace parallel_kseq {
+
+// kseq parser reading data decompressed by ParallelGzipReader
+static int read_decompressed(ParallelGzipReader *reader, void *buf, unsigned int len) {
+    return reader->read(buf, len);
+}
+
+__KS_TYPE(ParallelGzipReader*)
+__KS_BASIC(static, ParallelGzipReader*, 65536)
+__KS_GETUNTIL(static, read_decompressed)
+__KS_INLINED(read_decompressed)
+
+__KSEQ_TYPE(ParallelGzipReader*)
+__KSEQ_BASIC(static, ParallelGzipReader*)
+__KSEQ_READ(static)
+
+} // namespace parallel_kseq
+
+
+class SequenceStream {
+  public:
+    explicit SequenceStream(const std::string &filename)
+          : reader_(filename),
+            stream_(parallel_kseq::kseq_init(&reader_)),
+            record_(static_cast<kseq_t*>(calloc(1, sizeof(kseq_t)))) {
+        if (!stream_ || !record_) {
+            std::cerr << "ERROR: failed to initialize kseq file descriptor" << std::endl;
+            exit(1);
+        }
+    }
+
+    ~SequenceStream() {
+        parallel_kseq::kseq_destroy(stream_);
+        free(record_->name.s);
+        free(record_->comment.s);
+        free(record_->seq.s);
+        free(record_->qual.s);
+        free(record_);
+    }
+
+    // Parse the next record into |record()|. Return false if there are none left.
+    bool read() {
+        if (parallel_kseq::kseq_read(stream_) < 0)
+            return false;
+
+        // pass the parsed strings to the public record without copying them
+        std::swap(record_->name, stream_->name);
+        std::swap(record_->comment, stream_->comment);
+        std::swap(record_->seq, stream_->seq);
+        std::swap(record_->qual, stream_->qual);
+        return true;
+    }
+
+    kseq_t* record() { return record_; }
+
+  private:
+    ParallelGzipReader reader_;
+    parallel_kseq::kseq_t *stream_;
+    kseq_t *record_;
+};
+
+
 const char kDefaultFastQualityChar = 'I';
 
 // Optimal values found from a grid search with the BM_WriteRandomSequences benchmark
@@ -250,33 +313,31 @@ FastaParser::iterator& FastaParser::iterator::operator=(const iterator &other) {
         deinit_stream();
         filename_.clear();
         with_reverse_complement_ = false;
-        read_stream_ = NULL;
         is_reverse_complement_ = false;
         return *this;
     }
 
-    if (!read_stream_) {
-        *this = iterator(other.filename_, other.with_reverse_complement_);
-
-    } else if (filename_ != other.filename_) {
-        // The current iterator doesn't point to the target fasta file.
-        // Thus, we need to open a new descriptor and seek to the target position.
-
+    if (!stream_ || filename_ != other.filename_
+            || record_index_ > other.record_index_) {
+        // The current iterator can't be advanced to the target record.
+        // Thus, we need to open a new stream and read the file from the start.
+        deinit_stream();
         filename_ = other.filename_;
+        init_stream();
+    }
 
-        // close the old file descriptor
-        gzclose(read_stream_->f->f);
+    with_reverse_complement_ = other.with_reverse_complement_;
 
-        // open a new file descriptor
-        read_stream_->f->f = gzopen(filename_.c_str(), "r");
-        if (read_stream_->f->f == Z_NULL) {
-            std::cerr << "ERROR: Cannot read from file " << filename_ << std::endl;
+    // skip the records preceding the target one
+    while (record_index_ < other.record_index_) {
+        if (!stream_->read()) {
+            std::cerr << "ERROR: Cannot seek to record " << other.record_index_
+                      << " in file " << filename_ << std::endl;
             exit(1);
         }
+        record_index_++;
     }
 
-    gzseek(read_stream_->f->f, gztell(other.read_stream_->f->f), SEEK_SET);
-
 #define KSTRING_COPY(kstr, other_kstr) \
             kstr.l = other_kstr.l; \
             if (kstr.m != other_kstr.m) { \
@@ -289,32 +350,12 @@ FastaParser::iterator& FastaParser::iterator::operator=(const iterator &other) {
             } \
             memcpy(kstr.s, other_kstr.s, other_kstr.m); \
 
-    // copy last cached record
+    // copy last cached record (the sequence may be reverse complemented)
     KSTRING_COPY(read_stream_->name, other.read_stream_->name);
     KSTRING_COPY(read_stream_->comment, other.read_stream_->comment);
     KSTRING_COPY(read_stream_->seq, other.read_stream_->seq);
     KSTRING_COPY(read_stream_->qual, other.read_stream_->qual);
 
-    read_stream_->last_char = other.read_stream_->last_char;
-
-    // copy stream state
-    kstream_t *f = read_stream_->f;
-    kstream_t *other_f = other.read_stream_->f;
-
-    f->begin = other_f->begin;
-    f->end = other_f->end;
-    f->is_eof = other_f->is_eof;
-    f->seek_pos = other_f->seek_pos;
-    if (f->bufsize != other_f->bufsize) {
-        f->bufsize = other_f->bufsize;
-        f->buf = (unsigned char*)realloc(f->buf, f->bufsize);
-        if (!f->buf) {
-            std::cerr << "ERROR: realloc failed" << std::endl;
-            exit(1);
-        }
-    }
-    memcpy(f->buf, other_f->buf, other_f->bufsize);
-
     is_reverse_complement_ = other.is_reverse_complement_;
 
     return *this;
@@ -323,7 +364,9 @@ FastaParser::iterator& FastaParser::iterator::operator=(const iterator &other) {
 FastaParser::iterator& FastaParser::iterator::operator=(iterator&& other) {
     std::swap(filename_, other.filename_);
     with_reverse_complement_ = other.with_reverse_complement_;
+    std::swap(stream_, other.stream_);
     std::swap(read_stream_, other.read_stream_);
+    std::swap(record_index_, other.record_index_);
     is_reverse_complement_ = other.is_reverse_complement_;
     // the destructor in |other| will be responsible for freeing the memory now
     return *this;
@@ -333,30 +376,30 @@ FastaParser::iterator::iterator(const std::string &filename,
                                 bool with_reverse_complement)
       : filename_(filename),
         with_reverse_complement_(with_reverse_complement) {
-    gzFile input_p = gzopen(filename_.c_str(), "r");
-    if (input_p == Z_NULL) {
-        std::cerr << "ERROR: Cannot read from file " << filename_ << std::endl;
-        exit(1);
-    }
+    init_stream();
+    read_next();
+}
 
-    read_stream_ = kseq_init(input_p);
-    if (read_stream_ == NULL) {
-        std::cerr << "ERROR: failed to initialize kseq file descriptor" << std::endl;
-        exit(1);
-    }
+void FastaParser::iterator::init_stream() {
+    assert(!stream_);
+    stream_ = new SequenceStream(filename_);
+    read_stream_ = stream_->record();
+    record_index_ = 0;
+}
 
-    if (kseq_read(read_stream_) < 0) {
+void FastaParser::iterator::read_next() {
+    if (stream_->read()) {
+        record_index_++;
+    } else {
         deinit_stream();
     }
 }
 
 void FastaParser::iterator::deinit_stream() {
-    if (read_stream_) {
-        gzFile input_p = read_stream_->f->f;
-        kseq_destroy(read_stream_);
-        gzclose(input_p);
-    }
+    delete stream_;
+    stream_ = NULL;
     read_stream_ = NULL;
+    record_index_ = 0;
 }
 
 
@@ -389,15 +432,16 @@ void read_fasta_file_critical(gzFile input_p,
 void read_fasta_file_critical(const std::string &filename,
                               std::function<void(kseq_t*)> callback,
                               bool with_reverse) {
-    gzFile input_p = gzopen(filename.c_str(), "r");
-    if (input_p == Z_NULL) {
-        std::cerr << "ERROR: Cannot read file " << filename << std::endl;
-        exit(1);
-    }
+    SequenceStream stream(filename);
 
-    read_fasta_file_critical(input_p, callback, with_reverse);
-
-    gzclose(input_p);
+    while (stream.read()) {
+        kseq_t *read_stream = stream.record();
+        callback(read_stream);
+        if (with_reverse) {
+            reverse_complement(read_stream->seq);
+            callback(read_stream);
+        }
+    }
 }
 
 template <typename T>
@@ -105,6 +105,11 @@ bool write_fasta(gzFile gz_out, const std::string &header,
 
 bool write_fastq(gzFile gz_out, const kseq_t &kseq);
 
+/**
+ * Read sequences from a fasta/fastq file, plain or compressed with gzip.
+ * The input is decompressed on worker threads (in parallel for BGZF files)
+ * concurrently with parsing the records and calling |callback|.
+ */
 void read_fasta_file_critical(const std::string &filename,
                               std::function<void(kseq_t*)> callback,
                               bool with_reverse = false);
@@ -137,6 +142,9 @@ void read_fasta_from_string(const std::string &fasta_flat,
                             bool with_reverse = false);
 
 
+// Parser of records from a fasta/fastq file decompressed with ParallelGzipReader
+class SequenceStream;
+
 class FastaParser {
   public:
     class iterator;
@@ -189,9 +197,7 @@ class FastaParser::iterator {
             return *this;
         }
 
-        if (kseq_read(read_stream_) < 0) {
-            deinit_stream();
-        }
+        read_next();
         is_reverse_complement_ = false;
         return *this;
     }
@@ -199,7 +205,7 @@ class FastaParser::iterator {
     bool operator==(const iterator &other) const {
         return (read_stream_ && other.read_stream_
                     && is_reverse_complement_ == other.is_reverse_complement_
-                    && read_stream_->f->seek_pos == other.read_stream_->f->seek_pos
+                    && record_index_ == other.record_index_
                     && with_reverse_complement_ == other.with_reverse_complement_
                     && filename_ == other.filename_)
             || (!read_stream_ && !other.read_stream_);
@@ -211,11 +217,17 @@ class FastaParser::iterator {
 
   private:
     iterator(const std::string &filename, bool with_reverse_complement);
+    void init_stream();
+    void read_next();
     void deinit_stream();
 
     std::string filename_;
     bool with_reverse_complement_;
+    SequenceStream *stream_ = NULL;
+    // the current record, owned by |stream_|
     kseq_t *read_stream_ = NULL;
+    // the number of records read from |stream_|
+    uint64_t record_index_ = 0;
     bool is_reverse_complement_ = false;
 };
 
@@ -120,6 +120,97 @@ TEST(RowDiff, GetRows) {
     ASSERT_THAT(rows[11], ElementsAre(0));
 }
 
+TEST(RowDiff, GetRowsManyColumns) {
+    // build graph
+    graph::DBGSuccinct graph(4);
+    graph.add_sequence("ACTAGCTAGCTAGCTAGCTAGC");
+    graph.add_sequence("ACTCTAG");
+
+    // build annotation
+    sdsl::bit_vector bterminal = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0 };
+    anchor_bv_type terminal(bterminal);
+    utils::TempFile fterm_temp;
+    std::ofstream fterm(fterm_temp.name(), ios::binary);
+    terminal.serialize(fterm);
+    fterm.flush();
+
+    // with this many columns, the rows are reconstructed by merging
+    // sorted diffs rather than by accumulating them in a bitmap
+    const size_t num_columns = 10'000;
+    std::vector<std::unique_ptr<bit_vector>> cols(num_columns);
+    for (size_t j = 0; j < num_columns; ++j) {
+        cols[j] = std::make_unique<bit_vector_sd>(12, false);
+    }
+    cols[0] = std::make_unique<bit_vector_sd>(
+            std::initializer_list<bool>({ 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0  }));
+    cols[num_columns - 1] = std::make_unique<bit_vector_sd>(
+            std::initializer_list<bool>({ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1 }));
+
+    ColumnMajor mat(std::move(cols));
+
+    RowDiff<ColumnMajor> annot(&graph, std::move(mat));
+    annot.load_anchor(fterm_temp.name());
+
+    auto rows = annot.get_rows({ 3, 3, 3, 3, 5, 5, 6, 7, 8, 9, 10, 11 });
+    ASSERT_THAT(rows[3], ElementsAre(0, num_columns - 1));
+    ASSERT_THAT(rows[5], ElementsAre(num_columns - 1));
+    ASSERT_THAT(rows[6], ElementsAre(0));
+    ASSERT_THAT(rows[7], ElementsAre(num_columns - 1));
+    ASSERT_THAT(rows[8], ElementsAre(num_columns - 1));
+    ASSERT_THAT(rows[9], ElementsAre(0));
+    ASSERT_THAT(rows[10], ElementsAre(num_columns - 1));
+    ASSERT_THAT(rows[11], ElementsAre(0));
+
+    for (size_t i : { 3, 5, 6, 7, 8, 9, 10, 11 }) {
+        EXPECT_EQ(rows[i], annot.get_rows({ i })[0]);
+    }
+}
+
+TEST(RowDiff, GetColumn) {
+    // build graph
+    graph::DBGSuccinct graph(4);
+    graph.add_sequence("ACTAGCTAGCTAGCTAGCTAGC");
+    graph.add_sequence("ACTCTAG");
+
+    // build annotation
+    sdsl::bit_vector bterminal = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0 };
+    anchor_bv_type terminal(bterminal);
+    utils::TempFile fterm_temp;
+    std::ofstream fterm(fterm_temp.name(), ios::binary);
+    terminal.serialize(fterm);
+    fterm.flush();
+
+    std::vector<std::unique_ptr<bit_vector>> cols(2);
+    cols[0] = std::make_unique<bit_vector_sd>(
+            std::initializer_list<bool>({ 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0  }));
+    cols[1] = std::make_unique<bit_vector_sd>(
+            std::initializer_list<bool>({ 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 1 }));
+
+    ColumnMajor mat(std::move(cols));
+
+    RowDiff<ColumnMajor> annot(&graph, std::move(mat));
+    annot.load_anchor(fterm_temp.name());
+
+    EXPECT_THAT(annot.get_column(0), ElementsAre(3, 6, 9, 11));
+    EXPECT_THAT(annot.get_column(1), ElementsAre(3, 5, 7, 8, 10));
+
+    // check against the reconstructed rows
+    for (uint64_t j = 0; j < annot.num_columns(); ++j) {
+        std::vector<uint64_t> expected;
+        for (uint64_t i = 0; i < annot.num_rows(); ++i) {
+            auto edge = graph.kmer_to_boss_index(
+                graph::AnnotatedSequenceGraph::anno_to_graph_index(i));
+            if (!graph.get_boss().get_W(edge))
+                continue;
+
+            auto row = annot.get_rows({ i })[0];
+            if (std::find(row.begin(), row.end(), j) != row.end())
+                expected.push_back(i);
+        }
+        EXPECT_EQ(expected, annot.get_column(j));
+    }
+}
+
 /**
  * Tests annotations on the graph in
  * https://docs.google.com/document/d/1e0MFgZRJfmDUSvmDPuC_lvnnWA0VKm5hPdzM8mdrHMM/edit#bookmark=id.ciri4266pkc4
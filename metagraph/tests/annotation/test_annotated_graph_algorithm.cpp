@@ -82,6 +82,55 @@ TYPED_TEST(MaskedDeBruijnGraphAlgorithm, MaskIndicesByLabel) {
     }
 }
 
+TYPED_TEST(MaskedDeBruijnGraphAlgorithm, MaskIndicesByLabelRound2) {
+    typedef typename TypeParam::first_type Graph;
+    typedef typename TypeParam::second_type Annotation;
+    for (size_t num_threads : { 1, 4 }) {
+        const tsl::hopscotch_set<std::string> ingroup { "B" };
+        const tsl::hopscotch_set<std::string> outgroup { "A" };
+        const tsl::hopscotch_set<std::string> ingroup_round2 { "C" };
+        const tsl::hopscotch_set<std::string> outgroup_round2 { "D" };
+
+        size_t max_k = std::min(max_test_k<Graph>(), (size_t)15);
+        for (size_t k = 3; k < max_k; ++k) {
+            const std::vector<std::string> sequences {
+                std::string("T") + std::string(k - 1, 'A') + std::string(100, 'T'),
+                std::string("T") + std::string(k - 1, 'A') + "C",
+                std::string("T") + std::string(k - 1, 'A') + "C",
+                std::string("T") + std::string(k - 1, 'A') + "A",
+                std::string("T") + std::string(k - 1, 'A') + "G"
+            };
+            const std::vector<std::string> labels { "A", "B", "C", "D", "E" };
+
+            auto anno_graph = build_anno_graph<Graph, Annotation>(k, sequences, labels);
+
+            std::unordered_set<std::string> obs_kmers;
+            const std::unordered_set<std::string> ref_kmers {
+                std::string(k - 1, 'A') + "C"
+            };
+
+            DifferentialAssemblyConfig config {
+                .label_mask_in_unitig_fraction = 0.0,
+                .label_mask_in_kmer_fraction = 1.0,
+                .label_mask_out_unitig_fraction = 1.0,
+                .label_mask_out_kmer_fraction = 0.0,
+                .label_mask_other_unitig_fraction = 1.0
+            };
+
+            auto masked_dbg = mask_nodes_by_label(*anno_graph,
+                                                  ingroup, outgroup,
+                                                  ingroup_round2, outgroup_round2,
+                                                  config, num_threads);
+
+            masked_dbg->call_kmers([&](auto, const std::string &kmer) {
+                obs_kmers.insert(kmer);
+            });
+
+            EXPECT_EQ(ref_kmers, obs_kmers) << k;
+        }
+    }
+}
+
 TYPED_TEST(MaskedDeBruijnGraphAlgorithm, MaskIndicesByLabelOverlap) {
     typedef typename TypeParam::first_type Graph;
     typedef typename TypeParam::second_type Annotation;
@@ -374,6 +423,62 @@ TYPED_TEST(MaskedDeBruijnGraphAlgorithm, MaskUnitigsByLabelCanonical) {
         }
     }
 }
+
+TYPED_TEST(MaskedDeBruijnGraphAlgorithm, MaskIndicesByLabelRound2Canonical) {
+    typedef typename TypeParam::first_type Graph;
+    typedef typename TypeParam::second_type Annotation;
+    for (DeBruijnGraph::Mode mode : { DeBruijnGraph::CANONICAL,
+                                      DeBruijnGraph::PRIMARY }) {
+        std::string mode_str = mode == DeBruijnGraph::CANONICAL ? "CANONICAL" : "PRIMARY";
+        for (size_t num_threads : { 1, 4 }) {
+            const tsl::hopscotch_set<std::string> ingroup { "B" };
+            const tsl::hopscotch_set<std::string> outgroup { "A" };
+            const tsl::hopscotch_set<std::string> ingroup_round2 { "C" };
+            const tsl::hopscotch_set<std::string> outgroup_round2 { "D" };
+
+            size_t max_k = std::min(max_test_k<Graph>(), (size_t)15);
+            for (size_t k = 3; k < max_k; ++k) {
+                const std::vector<std::string> sequences {
+                    std::string("T") + std::string(k - 1, 'A') + std::string(100, 'T'),
+                    std::string("T") + std::string(k - 1, 'A') + "C",
+                    std::string("T") + std::string(k - 1, 'A') + "C",
+                    std::string("T") + std::string(k - 1, 'A') + "A",
+                    std::string("T") + std::string(k - 1, 'A') + "G"
+                };
+                const std::vector<std::string> labels { "A", "B", "C", "D", "E" };
+
+                auto anno_graph = build_anno_graph<Graph, Annotation>(k, sequences, labels, mode);
+
+                std::unordered_set<std::string> obs_kmers;
+                // the reverse complement is kept as well
+                const std::unordered_set<std::string> ref_kmers {
+                    std::string(k - 1, 'A') + "C",
+                    std::string("G") + std::string(k - 1, 'T')
+                };
+
+                DifferentialAssemblyConfig config {
+                    .label_mask_in_unitig_fraction = 0.0,
+                    .label_mask_in_kmer_fraction = 1.0,
+                    .label_mask_out_unitig_fraction = 1.0,
+                    .label_mask_out_kmer_fraction = 0.0,
+                    .label_mask_other_unitig_fraction = 1.0,
+                    .add_complement = true
+                };
+
+                auto masked_dbg = mask_nodes_by_label(*anno_graph,
+                                                      ingroup, outgroup,
+                                                      ingroup_round2, outgroup_round2,
+                                                      config, num_threads);
+
+                masked_dbg->call_kmers([&](auto, const std::string &kmer) {
+                    obs_kmers.insert(kmer);
+                });
+
+                EXPECT_EQ(ref_kmers, obs_kmers) << k << " " << mode_str;
+            }
+        }
+    }
+}
 #endif
 
 } // namespace
@@ -77,6 +77,39 @@ TYPED_TEST(AnnotatorPresetTest, CountLabels) {
             }), 2
         ))
     );
+
+    EXPECT_EQ(
+        std::vector<std::pair<uint64_t, size_t>>(),
+        this->annotation->get_matrix().sum_rows(
+            std::vector<std::pair<uint64_t, size_t>>({
+                {0, 1}, {1, 1}, {2, 1}, {3, 1}, {4, 1}
+            }), 5
+        )
+    );
+
+    EXPECT_EQ(
+        std::vector<std::pair<uint64_t, size_t>>({ {1, 4} }),
+        this->annotation->get_matrix().sum_rows(
+            std::vector<std::pair<uint64_t, size_t>>({
+                {0, 1}, {1, 1}, {2, 1}, {3, 1}, {4, 1}
+            }), 4
+        )
+    );
+
+    // counts from the previous queries must not leak into the next ones
+    auto row_counts = this->annotation->get_matrix().sum_rows(
+        std::vector<std::pair<uint64_t, size_t>>({ {0, 1} })
+    );
+    EXPECT_EQ(3u, row_counts.size());
+    for (auto &[j, count] : row_counts) {
+        count *= 2;
+    }
+    EXPECT_EQ(
+        convert_to_set(row_counts),
+        convert_to_set(this->annotation->get_matrix().sum_rows(
+            std::vector<std::pair<uint64_t, size_t>>({ {0, 2}, {4, 0} })
+        ))
+    );
 }
 
 TYPED_TEST(AnnotatorTest, GetLabelsOneRow) {
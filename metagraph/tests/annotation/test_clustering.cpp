@@ -0,0 +1,109 @@
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "annotation/binary_matrix/multi_brwt/clustering.hpp"
+
+
+namespace {
+
+using namespace mtg;
+using namespace mtg::annot::matrix;
+
+// check that each cluster is merged exactly once and all merge into the root
+void check_linkage(const LinkageMatrix &linkage, size_t num_columns) {
+    ASSERT_EQ(num_columns - 1, static_cast<size_t>(linkage.rows()));
+
+    std::vector<bool> merged(2 * num_columns - 1, false);
+    for (size_t i = 0; i < num_columns - 1; ++i) {
+        ASSERT_LT(linkage(i, 0), linkage(i, 3));
+        ASSERT_LT(linkage(i, 1), linkage(i, 3));
+        EXPECT_FALSE(merged[linkage(i, 0)]);
+        EXPECT_FALSE(merged[linkage(i, 1)]);
+        merged[linkage(i, 0)] = true;
+        merged[linkage(i, 1)] = true;
+        EXPECT_EQ(num_columns + i, linkage(i, 3));
+    }
+    EXPECT_FALSE(merged.back());
+}
+
+std::vector<SparseColumn> generate_pairs_of_columns(size_t num_pairs,
+                                                    uint64_t size) {
+    std::mt19937 gen(42);
+    std::bernoulli_distribution dist(0.1);
+
+    std::vector<SparseColumn> columns(2 * num_pairs);
+    for (size_t i = 0; i < num_pairs; ++i) {
+        SparseColumn column { size, {} };
+        for (uint64_t j = 0; j < size; ++j) {
+            if (dist(gen))
+                column.set_bits.push_back(j);
+        }
+        columns[2 * i] = column;
+        columns[2 * i + 1] = column;
+    }
+    return columns;
+}
+
+TEST(Clustering, GreedyLinkageEmpty) {
+    EXPECT_EQ(0, agglomerative_greedy_linkage(std::vector<SparseColumn>()).rows());
+    EXPECT_EQ(0, agglomerative_lsh_linkage(std::vector<SparseColumn>()).rows());
+}
+
+TEST(Clustering, GreedyLinkageOneColumn) {
+    std::vector<SparseColumn> columns = { { 10, { 1, 2, 3 } } };
+    EXPECT_EQ(0, agglomerative_greedy_linkage(std::move(columns)).rows());
+}
+
+TEST(Clustering, LSHLinkageOneColumn) {
+    std::vector<SparseColumn> columns = { { 10, { 1, 2, 3 } } };
+    EXPECT_EQ(0, agglomerative_lsh_linkage(std::move(columns)).rows());
+}
+
+TEST(Clustering, GreedyLinkageIdenticalPairs) {
+    for (size_t num_threads : { 1, 4 }) {
+        auto columns = generate_pairs_of_columns(20, 1000);
+        auto linkage = agglomerative_greedy_linkage(std::move(columns), num_threads);
+        check_linkage(linkage, 40);
+        // identical columns are merged at the first level
+        for (size_t i = 0; i < 20; ++i) {
+            EXPECT_EQ(linkage(i, 0) / 2, linkage(i, 1) / 2);
+        }
+    }
+}
+
+TEST(Clustering, LSHLinkageIdenticalPairs) {
+    for (size_t num_threads : { 1, 4 }) {
+        auto columns = generate_pairs_of_columns(20, 1000);
+        auto linkage = agglomerative_lsh_linkage(std::move(columns), num_threads);
+        check_linkage(linkage, 40);
+        // identical columns always collide and are merged at the first level
+        for (size_t i = 0; i < 20; ++i) {
+            EXPECT_EQ(linkage(i, 0) / 2, linkage(i, 1) / 2);
+        }
+    }
+}
+
+TEST(Clustering, LSHLinkageDenseColumns) {
+    for (size_t num_columns : { 2, 3, 7, 50 }) {
+        std::mt19937 gen(num_columns);
+        std::bernoulli_distribution dist(0.2);
+        std::vector<sdsl::bit_vector> columns(num_columns);
+        for (auto &column : columns) {
+            column = sdsl::bit_vector(500, false);
+            for (size_t j = 0; j < column.size(); ++j) {
+                column[j] = dist(gen);
+            }
+        }
+        check_linkage(agglomerative_lsh_linkage(std::move(columns), 2, 4, 2),
+                      num_columns);
+    }
+}
+
+TEST(Clustering, LSHLinkageEmptyColumns) {
+    // all sketches are empty and collide in every band
+    std::vector<SparseColumn> columns(100, SparseColumn { 10, {} });
+    check_linkage(agglomerative_lsh_linkage(std::move(columns), 3), 100);
+}
+
+} // namespace
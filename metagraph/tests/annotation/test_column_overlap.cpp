@@ -0,0 +1,100 @@
+#include <random>
+
+#include "gtest/gtest.h"
+
+#include "annotation/binary_matrix/column_sparse/column_overlap.hpp"
+#include "common/vectors/bit_vector_adaptive.hpp"
+#include "common/vectors/bit_vector_sd.hpp"
+#include "common/vectors/bit_vector_sdsl.hpp"
+
+
+namespace {
+
+using namespace mtg;
+using namespace mtg::annot::matrix;
+
+// columns of different densities and representations
+std::vector<std::unique_ptr<bit_vector>> generate_columns(size_t num_columns,
+                                                          uint64_t size,
+                                                          int seed) {
+    std::mt19937 gen(seed);
+    std::vector<std::unique_ptr<bit_vector>> columns;
+    for (size_t i = 0; i < num_columns; ++i) {
+        std::bernoulli_distribution dist(std::vector<double>{ 0.0, 0.001, 0.05, 0.5 }[i % 4]);
+        sdsl::bit_vector bits(size, false);
+        for (uint64_t j = 0; j < size; ++j) {
+            bits[j] = dist(gen);
+        }
+        switch (i % 3) {
+            case 0: columns.emplace_back(new bit_vector_stat(std::move(bits))); break;
+            case 1: columns.emplace_back(new bit_vector_sd(bits)); break;
+            case 2: columns.emplace_back(new bit_vector_smart(std::move(bits))); break;
+        }
+    }
+    return columns;
+}
+
+std::vector<const bitmap *> get_ptrs(const std::vector<std::unique_ptr<bit_vector>> &columns) {
+    std::vector<const bitmap *> ptrs;
+    for (const auto &column : columns) {
+        ptrs.push_back(column.get());
+    }
+    return ptrs;
+}
+
+uint64_t naive_overlap(const bit_vector &first, const bit_vector &second) {
+    uint64_t count = 0;
+    first.call_ones([&](uint64_t i) { count += second[i]; });
+    return count;
+}
+
+TEST(ColumnOverlap, Empty) {
+    auto columns = generate_columns(3, 100, 1);
+    EXPECT_EQ(0, compute_column_overlaps({}, {}).size());
+    auto overlaps = compute_column_overlaps(get_ptrs(columns), {});
+    EXPECT_EQ(3, overlaps.rows());
+    EXPECT_EQ(0, overlaps.cols());
+}
+
+TEST(ColumnOverlap, DifferentSizes) {
+    auto first = generate_columns(2, 100, 1);
+    auto second = generate_columns(2, 101, 2);
+    EXPECT_THROW(compute_column_overlaps(get_ptrs(first), get_ptrs(second)),
+                 std::runtime_error);
+}
+
+TEST(ColumnOverlap, AllPairs) {
+    auto first = generate_columns(50, 10'000, 1);
+    auto second = generate_columns(70, 10'000, 2);
+    for (size_t num_threads : { 1, 4 }) {
+        auto overlaps = compute_column_overlaps(get_ptrs(first), get_ptrs(second),
+                                                num_threads);
+        ASSERT_EQ(first.size(), static_cast<size_t>(overlaps.rows()));
+        ASSERT_EQ(second.size(), static_cast<size_t>(overlaps.cols()));
+        for (size_t i = 0; i < first.size(); ++i) {
+            for (size_t j = 0; j < second.size(); ++j) {
+                ASSERT_EQ(naive_overlap(*first[i], *second[j]), overlaps(i, j))
+                    << i << " " << j;
+            }
+        }
+    }
+}
+
+TEST(ColumnOverlap, Symmetric) {
+    auto columns = generate_columns(70, 10'000, 1);
+    auto ptrs = get_ptrs(columns);
+    for (size_t num_threads : { 1, 4 }) {
+        auto overlaps = compute_column_overlaps(ptrs, ptrs, num_threads);
+        ASSERT_EQ(columns.size(), static_cast<size_t>(overlaps.rows()));
+        ASSERT_EQ(columns.size(), static_cast<size_t>(overlaps.cols()));
+        for (size_t i = 0; i < columns.size(); ++i) {
+            EXPECT_EQ(columns[i]->num_set_bits(), overlaps(i, i));
+            for (size_t j = 0; j < columns.size(); ++j) {
+                ASSERT_EQ(naive_overlap(*columns[i], *columns[j]), overlaps(i, j))
+                    << i << " " << j;
+            }
+        }
+    }
+}
+
+} // namespace
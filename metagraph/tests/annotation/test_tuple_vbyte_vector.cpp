@@ -0,0 +1,108 @@
+#include <numeric>
+#include <random>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+#include "annotation/annotation_converters.hpp"
+#include "annotation/binary_matrix/column_sparse/column_major.hpp"
+#include "annotation/int_matrix/rank_extended/tuple_csc_matrix.hpp"
+#include "common/vectors/bit_vector_adaptive.hpp"
+#include "common/vectors/bit_vector_sdsl.hpp"
+
+
+namespace {
+
+using namespace mtg;
+using namespace mtg::annot;
+using namespace mtg::annot::matrix;
+
+typedef TupleCSCMatrix<ColumnMajor> TupleCSC;
+typedef TupleCSCMatrix<ColumnMajor, TupleVByteVector> TupleCSCVByte;
+
+// random coordinate matrix with empty tuples, long tuples, and large values
+TupleCSC generate_matrix(uint64_t num_rows, size_t num_columns, int seed) {
+    std::mt19937_64 gen(seed);
+    std::vector<std::unique_ptr<bit_vector>> columns;
+    std::vector<bit_vector_smart> delimiters;
+    std::vector<sdsl::int_vector<>> column_values;
+
+    for (size_t j = 0; j < num_columns; ++j) {
+        std::bernoulli_distribution dist(std::vector<double>{ 0.0, 0.01, 0.3, 1.0 }[j % 4]);
+        sdsl::bit_vector bits(num_rows, false);
+        std::vector<bool> delims = { true };
+        std::vector<uint64_t> values;
+        for (uint64_t i = 0; i < num_rows; ++i) {
+            if (!dist(gen))
+                continue;
+
+            bits[i] = true;
+            size_t tuple_size = gen() % (i % 10 ? 5 : 100);
+            uint64_t value = gen() >> (gen() % 64);
+            for (size_t t = 0; t < tuple_size; ++t) {
+                values.push_back(value);
+                delims.push_back(false);
+                value += (gen() >> (gen() % 64)) / tuple_size;
+            }
+            delims.push_back(true);
+        }
+
+        sdsl::bit_vector delims_bits(delims.size(), false);
+        for (size_t t = 0; t < delims.size(); ++t) {
+            delims_bits[t] = delims[t];
+        }
+        sdsl::int_vector<> values_vector(values.size(), 0, 64);
+        std::copy(values.begin(), values.end(), values_vector.begin());
+        sdsl::util::bit_compress(values_vector);
+
+        columns.emplace_back(new bit_vector_stat(std::move(bits)));
+        delimiters.emplace_back(std::move(delims_bits));
+        column_values.push_back(std::move(values_vector));
+    }
+
+    return TupleCSC(ColumnMajor(std::move(columns)),
+                    std::move(delimiters), std::move(column_values));
+}
+
+void check_equal(const TupleCSC &expected, const TupleCSCVByte &packed) {
+    ASSERT_EQ(expected.num_rows(), packed.num_rows());
+    ASSERT_EQ(expected.num_columns(), packed.num_columns());
+    ASSERT_EQ(expected.num_relations(), packed.num_relations());
+    ASSERT_EQ(expected.num_attributes(), packed.num_attributes());
+
+    std::vector<BinaryMatrix::Row> rows(expected.num_rows());
+    std::iota(rows.begin(), rows.end(), 0);
+    ASSERT_EQ(expected.get_row_values(rows), packed.get_row_values(rows));
+
+    auto expected_tuples = expected.get_row_tuples(rows);
+    auto packed_tuples = packed.get_row_tuples(rows);
+    ASSERT_EQ(expected_tuples.size(), packed_tuples.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        ASSERT_EQ(expected_tuples[i], packed_tuples[i]) << i;
+    }
+}
+
+TEST(TupleVByteVector, Empty) {
+    TupleVByteVector vector(bit_vector_smart(sdsl::bit_vector(1, true)), sdsl::int_vector<>());
+    EXPECT_EQ(0u, vector.size());
+}
+
+TEST(TupleVByteVector, PackCoords) {
+    for (size_t num_threads : { 1, 4 }) {
+        auto packed = pack_coords(generate_matrix(1'000, 10, 1), num_threads);
+        check_equal(generate_matrix(1'000, 10, 1), packed);
+    }
+}
+
+TEST(TupleVByteVector, Serialization) {
+    auto packed = pack_coords(generate_matrix(1'000, 10, 2));
+
+    std::stringstream out;
+    packed.serialize(out);
+
+    TupleCSCVByte loaded;
+    ASSERT_TRUE(loaded.load(out));
+    check_equal(generate_matrix(1'000, 10, 2), loaded);
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+#include "common/threads/concurrent_cache.hpp"
+
+#include "gtest/gtest.h"
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace {
+
+using namespace mtg;
+
+using mtg::common::ConcurrentCache;
+
+TEST(ConcurrentCache, Empty) {
+    ConcurrentCache<uint64_t, bool> cache(10);
+    EXPECT_EQ(16u, cache.capacity());
+    EXPECT_FALSE(cache.TryGet(0));
+    EXPECT_FALSE(cache.TryGet(5));
+    EXPECT_EQ(0u, cache.num_hits());
+    EXPECT_EQ(2u, cache.num_misses());
+}
+
+TEST(ConcurrentCache, PutGet) {
+    ConcurrentCache<uint64_t, bool> cache(1);
+    cache.Put(3, true);
+    ASSERT_TRUE(cache.TryGet(3));
+    EXPECT_TRUE(*cache.TryGet(3));
+
+    cache.Put(3, false);
+    ASSERT_TRUE(cache.TryGet(3));
+    EXPECT_FALSE(*cache.TryGet(3));
+
+    // a single slot, the old key is evicted
+    cache.Put(4, true);
+    EXPECT_FALSE(cache.TryGet(3));
+    ASSERT_TRUE(cache.TryGet(4));
+    EXPECT_TRUE(*cache.TryGet(4));
+
+    EXPECT_EQ(6u, cache.num_hits());
+    EXPECT_EQ(1u, cache.num_misses());
+}
+
+TEST(ConcurrentCache, PairValues) {
+    ConcurrentCache<uint64_t, std::pair<uint64_t, uint64_t>> cache(1000);
+    for (uint64_t i = 0; i < 1000; ++i) {
+        cache.Put(i, std::make_pair(i * 2, i * 3));
+    }
+    size_t num_found = 0;
+    for (uint64_t i = 0; i < 1000; ++i) {
+        if (auto fetch = cache.TryGet(i)) {
+            EXPECT_EQ(std::make_pair(i * 2, i * 3), *fetch);
+            num_found++;
+        }
+    }
+    EXPECT_LT(0u, num_found);
+    EXPECT_EQ(num_found, cache.num_hits());
+    EXPECT_EQ(1000 - num_found, cache.num_misses());
+}
+
+TEST(ConcurrentCache, MultipleThreads) {
+    ConcurrentCache<uint64_t, std::pair<uint64_t, uint64_t>> cache(128);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 8; ++t) {
+        threads.emplace_back([&]() {
+            for (uint64_t i = 0; i < 100'000; ++i) {
+                uint64_t key = i % 1000;
+                if (auto fetch = cache.TryGet(key)) {
+                    // never get a torn value
+                    ASSERT_EQ(std::make_pair(key * 2, key * 3), *fetch);
+                } else {
+                    cache.Put(key, std::make_pair(key * 2, key * 3));
+                }
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(8 * 100'000u, cache.num_hits() + cache.num_misses());
+}
+
+} // namespace
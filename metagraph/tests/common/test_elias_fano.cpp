@@ -267,6 +267,34 @@ TYPED_TEST(EliasFanoTest, ReadWriteRandomLargerThanBuffer) {
     }
 }
 
+/** Covers every supported number of lower bits, including the vectorized ones */
+TYPED_TEST(EliasFanoTest, ReadWriteAllLowerBitWidths) {
+    const uint32_t size = 3000;
+    std::mt19937_64 rng(123457);
+    // leave 12 bits for the upper part of the values (size < 2^12)
+    for (uint32_t num_bits = 0; num_bits <= 8 * sizeof(TypeParam) - 12; ++num_bits) {
+        const TypeParam mask = (TypeParam(1) << num_bits) - 1UL;
+        std::vector<TypeParam> values(size);
+        for (uint32_t i = 0; i < size; ++i) {
+            TypeParam random = 0;
+            for (uint32_t j = 0; j < num_bits; j += 64) {
+                random |= TypeParam(rng()) << j;
+            }
+            values[i] = (TypeParam(i) << num_bits) | (random & mask);
+        }
+        utils::TempFile file;
+        encode(values, file.name());
+
+        EliasFanoDecoder<TypeParam> decoder(file.name());
+        for (uint32_t i = 0; i < size; ++i) {
+            std::optional<TypeParam> decoded = decoder.next();
+            ASSERT_TRUE(decoded.has_value());
+            ASSERT_EQ(values[i], decoded.value()) << num_bits << " " << i;
+        }
+        EXPECT_FALSE(decoder.next().has_value());
+    }
+}
+
 template <typename T>
 class EliasFanoBufferedTest : public ::testing::Test {};
 TYPED_TEST_SUITE(EliasFanoBufferedTest, ValueTypes);
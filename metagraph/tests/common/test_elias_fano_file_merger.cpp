@@ -35,6 +35,15 @@ void do_encode(const std::vector<T> &values, const std::string &file_name) {
     encoder.finish();
 }
 
+// encode in blocks of |block_size| elements
+template <typename T>
+void do_encode(const std::vector<T> &values, const std::string &file_name,
+               size_t block_size) {
+    elias_fano::EliasFanoEncoderBuffered<T> encoder(file_name, block_size);
+    std::for_each(values.begin(), values.end(), [&encoder](const T &v) { encoder.add(v); });
+    encoder.finish();
+}
+
 template <typename T>
 std::vector<T>
 get_random_values(uint32_t count,
@@ -146,4 +155,131 @@ TYPED_TEST(EliasFanoFileMergerTest, MergeRandom) {
     elias_fano::merge_files(file_names, on_new_item);
 }
 
+template <typename T>
+std::vector<T> get_merged(std::vector<T> expected) {
+    std::sort(expected.begin(), expected.end(), [](const T &a, const T &b) {
+        return utils::get_first(a) < utils::get_first(b);
+    });
+    if constexpr (utils::is_pair_v<T>) {
+        remove_duplicates(&expected);
+    } else {
+        expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    }
+    return expected;
+}
+
+TEST(EliasFanoLoserTree, MergeSorted) {
+    for (size_t num_sources : { 1, 2, 3, 7, 16 }) {
+        std::mt19937 rng(num_sources);
+        std::uniform_int_distribution<uint32_t> dist(0, 20);
+        std::vector<std::vector<uint32_t>> sources(num_sources);
+        std::vector<uint32_t> expected;
+        for (auto &source : sources) {
+            source.resize(dist(rng));
+            std::generate(source.begin(), source.end(), [&]() { return dist(rng); });
+            std::sort(source.begin(), source.end());
+            expected.insert(expected.end(), source.begin(), source.end());
+        }
+        std::sort(expected.begin(), expected.end());
+
+        std::vector<size_t> pos(num_sources, 0);
+        auto next = [&](uint32_t i) {
+            return pos[i] < sources[i].size()
+                    ? std::make_optional(sources[i][pos[i]++])
+                    : std::nullopt;
+        };
+        std::vector<std::optional<uint32_t>> heads;
+        for (uint32_t i = 0; i < num_sources; ++i) {
+            heads.push_back(next(i));
+        }
+        elias_fano::LoserTree<uint32_t> tree(std::move(heads));
+
+        std::vector<uint32_t> merged;
+        while (!tree.empty()) {
+            merged.push_back(tree.top());
+            tree.replace_top(next(tree.top_source()));
+        }
+        EXPECT_EQ(expected, merged) << num_sources;
+    }
+}
+
+TYPED_TEST(EliasFanoFileMergerTest, MergeRandomLoserTree) {
+    std::mt19937 rng(123457);
+    std::uniform_int_distribution<std::mt19937::result_type> dist10(4, 10);
+    std::uniform_int_distribution<std::mt19937::result_type> dist100(0, 100);
+
+    const uint32_t file_count = 10 * dist10(rng);
+    std::vector<utils::TempFile> files(file_count);
+    std::vector<std::string> file_names;
+    std::vector<TypeParam> expected;
+    for (uint32_t i = 0; i < file_count; ++i) {
+        file_names.push_back(files[i].name());
+        std::vector<TypeParam> values
+                = get_random_values<TypeParam>(dist100(rng), rng, dist10);
+        do_encode(values, files[i].name());
+        expected.insert(expected.end(), values.begin(), values.end());
+    }
+    expected = get_merged(expected);
+
+    elias_fano::LoserTreeDecoder<TypeParam> decoder(file_names, true);
+    std::vector<TypeParam> merged;
+    elias_fano::merge_unique(decoder, [&](const TypeParam &v) { merged.push_back(v); });
+    EXPECT_EQ(expected, merged);
+}
+
+TYPED_TEST(EliasFanoFileMergerTest, MergeParallel) {
+    std::mt19937 rng(123457);
+    std::uniform_int_distribution<std::mt19937::result_type> dist10(4, 10);
+    std::uniform_int_distribution<std::mt19937::result_type> dist1000(0, 1000);
+    std::uniform_int_distribution<std::mt19937::result_type> dist_block(1, 50);
+
+    const uint32_t file_count = dist10(rng);
+    std::vector<utils::TempFile> files(file_count);
+    std::vector<std::string> file_names;
+    std::vector<TypeParam> expected;
+    for (uint32_t i = 0; i < file_count; ++i) {
+        file_names.push_back(files[i].name());
+        // encode in many small blocks to exercise seeking to the split points
+        std::vector<TypeParam> values
+                = get_random_values<TypeParam>(dist1000(rng), rng, dist10);
+        do_encode(values, files[i].name(), dist_block(rng));
+        expected.insert(expected.end(), values.begin(), values.end());
+    }
+    expected = get_merged(expected);
+
+    for (size_t num_threads : { 1, 2, 3, 8, 100 }) {
+        utils::TempFile out;
+        std::vector<std::string> segments = elias_fano::merge_files_parallel<TypeParam>(
+                file_names, out.name(), num_threads, false, 10);
+        EXPECT_GE(num_threads, segments.size());
+        if (num_threads > 1)
+            EXPECT_LT(1u, segments.size());
+        elias_fano::concat(segments, out.name());
+
+        std::vector<TypeParam> merged;
+        elias_fano::EliasFanoDecoder<TypeParam> decoder(out.name(), true);
+        while (std::optional<TypeParam> v = decoder.next()) {
+            merged.push_back(v.value());
+        }
+        EXPECT_EQ(expected, merged) << num_threads;
+    }
+}
+
+TYPED_TEST(EliasFanoFileMergerTest, MergeParallelEmpty) {
+    constexpr uint32_t FILE_COUNT = 4;
+    std::vector<utils::TempFile> files(FILE_COUNT);
+    std::vector<std::string> file_names;
+    for (uint32_t i = 0; i < FILE_COUNT; ++i) {
+        file_names.push_back(files[i].name());
+        do_encode(std::vector<TypeParam>(), file_names.back());
+    }
+    utils::TempFile out;
+    std::vector<std::string> segments
+            = elias_fano::merge_files_parallel<TypeParam>(file_names, out.name(), 4, false);
+    ASSERT_EQ(1u, segments.size());
+    elias_fano::concat(segments, out.name());
+    elias_fano::EliasFanoDecoder<TypeParam> decoder(out.name(), true);
+    EXPECT_FALSE(decoder.next().has_value());
+}
+
 } // namespace
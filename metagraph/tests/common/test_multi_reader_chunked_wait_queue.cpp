@@ -0,0 +1,142 @@
+#include "common/threads/multi_reader_chunked_wait_queue.hpp"
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+
+namespace {
+
+using namespace mtg;
+
+typedef common::MultiReaderChunkedWaitQueue<int32_t> Queue;
+
+std::vector<int32_t> get_range(int32_t size) {
+    std::vector<int32_t> result(size);
+    std::iota(result.begin(), result.end(), 0);
+    return result;
+}
+
+TEST(MultiReaderChunkedWaitQueue, ShutdownEmpty) {
+    for (auto mode : { Queue::BROADCAST, Queue::PARTITION }) {
+        Queue under_test(2, 20, mode);
+        under_test.shutdown();
+        Queue::Reader reader1 = under_test.reader();
+        Queue::Reader reader2 = under_test.reader();
+        EXPECT_EQ(nullptr, reader1.next_chunk());
+        EXPECT_EQ(nullptr, reader2.next_chunk());
+    }
+}
+
+TEST(MultiReaderChunkedWaitQueue, BroadcastSingleThread) {
+    Queue under_test(2, 1);
+    ASSERT_EQ(1u, under_test.chunk_size());
+    Queue::Reader reader1 = under_test.reader();
+    Queue::Reader reader2 = under_test.reader();
+
+    under_test.push(1);
+    under_test.push(2);
+    under_test.shutdown();
+
+    for (Queue::Reader *reader : { &reader1, &reader2 }) {
+        const Queue::Chunk *chunk = reader->next_chunk();
+        ASSERT_NE(nullptr, chunk);
+        EXPECT_EQ(std::vector<int32_t>({ 1 }), *chunk);
+        EXPECT_EQ(0u, reader->chunk_index());
+        chunk = reader->next_chunk();
+        ASSERT_NE(nullptr, chunk);
+        EXPECT_EQ(std::vector<int32_t>({ 2 }), *chunk);
+        EXPECT_EQ(1u, reader->chunk_index());
+        EXPECT_EQ(nullptr, reader->next_chunk());
+    }
+}
+
+TEST(MultiReaderChunkedWaitQueue, Broadcast) {
+    const std::vector<int32_t> expected = get_range(10'000);
+    for (size_t num_readers : { 1, 2, 5 }) {
+        for (size_t buffer_size : { 1, 10, 1000 }) {
+            Queue under_test(num_readers, buffer_size, Queue::BROADCAST);
+            std::vector<std::vector<int32_t>> results(num_readers);
+            std::vector<std::thread> readers;
+            for (size_t i = 0; i < num_readers; ++i) {
+                readers.emplace_back([&, reader = under_test.reader(), i]() mutable {
+                    reader.call_elements([&](int32_t v) { results[i].push_back(v); });
+                });
+            }
+            for (int32_t v : expected) {
+                under_test.push(v);
+            }
+            under_test.shutdown();
+            for (auto &thread : readers) {
+                thread.join();
+            }
+            for (const auto &result : results) {
+                EXPECT_EQ(expected, result) << num_readers << " " << buffer_size;
+            }
+        }
+    }
+}
+
+TEST(MultiReaderChunkedWaitQueue, Partition) {
+    const std::vector<int32_t> expected = get_range(10'000);
+    for (size_t num_readers : { 1, 2, 5 }) {
+        for (size_t buffer_size : { 1, 10, 1000 }) {
+            Queue under_test(num_readers, buffer_size, Queue::PARTITION);
+            std::vector<std::map<uint64_t, std::vector<int32_t>>> results(num_readers);
+            std::vector<std::thread> readers;
+            for (size_t i = 0; i < num_readers; ++i) {
+                readers.emplace_back([&, reader = under_test.reader(), i]() mutable {
+                    while (const Queue::Chunk *chunk = reader.next_chunk()) {
+                        results[i][reader.chunk_index()] = *chunk;
+                    }
+                });
+            }
+            for (int32_t v : expected) {
+                under_test.push(v);
+            }
+            under_test.shutdown();
+            for (auto &thread : readers) {
+                thread.join();
+            }
+
+            // every chunk must have been read by exactly one reader
+            std::map<uint64_t, std::vector<int32_t>> chunks;
+            for (const auto &result : results) {
+                for (const auto &[index, chunk] : result) {
+                    EXPECT_TRUE(chunks.emplace(index, chunk).second);
+                }
+            }
+            std::vector<int32_t> merged;
+            for (const auto &[index, chunk] : chunks) {
+                merged.insert(merged.end(), chunk.begin(), chunk.end());
+            }
+            EXPECT_EQ(expected, merged) << num_readers << " " << buffer_size;
+        }
+    }
+}
+
+TEST(MultiReaderChunkedWaitQueue, BroadcastReaderLeavesEarly) {
+    const std::vector<int32_t> expected = get_range(10'000);
+    Queue under_test(2, 10, Queue::BROADCAST);
+    std::vector<int32_t> result;
+    std::thread full_reader([&, reader = under_test.reader()]() mutable {
+        reader.call_elements([&](int32_t v) { result.push_back(v); });
+    });
+    std::thread short_reader([reader = under_test.reader()]() mutable {
+        // read one chunk only, the writer must not block on the rest
+        reader.next_chunk();
+    });
+    for (int32_t v : expected) {
+        under_test.push(v);
+    }
+    under_test.shutdown();
+    full_reader.join();
+    short_reader.join();
+    EXPECT_EQ(expected, result);
+}
+
+} // namespace
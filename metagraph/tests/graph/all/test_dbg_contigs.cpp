@@ -909,4 +909,44 @@ TYPED_TEST(DeBruijnGraphTest, CallUnitigsCross) {
     }
 }
 
+TYPED_TEST(DeBruijnGraphTest, CallUnitigsParallelSameAsSerial) {
+    const std::vector<std::string> sequences {
+        "ATGCAGTACTCAGCAATCAGGCATGCAGTACTCAGC",
+        "ATGCAGTACTCAGCTTTTTTTTTTTTTTTTTTTTTT",
+        "GCTGAGTACTGCATGCCTGATTGCTGAGTACTGCAT",
+        "ACGTACGTACGTACGTACGTACGTACGTACGTACGT",
+        "AAAAAAAAAAAAAAAAAAA",
+    };
+    for (size_t k = 2; k <= 10; ++k) {
+        auto graph = build_graph_batch<TypeParam>(k, sequences);
+
+        for (size_t min_tip_size : { 1, 3 }) {
+            std::multiset<std::string> unitigs[2];
+            std::mutex seq_mutex;
+            for (size_t num_threads : { 1, 4 }) {
+                graph->call_unitigs([&](const auto &sequence, const auto &path) {
+                    ASSERT_EQ(path, map_to_nodes_sequentially(*graph, sequence));
+                    std::unique_lock<std::mutex> lock(seq_mutex);
+                    unitigs[num_threads > 1].insert(sequence);
+                }, num_threads, min_tip_size);
+            }
+            EXPECT_EQ(unitigs[0], unitigs[1]) << k << " " << min_tip_size;
+        }
+
+        // each k-mer is called exactly once in contigs
+        std::multiset<std::string> kmers;
+        std::mutex seq_mutex;
+        graph->call_sequences([&](const auto &sequence, const auto &path) {
+            ASSERT_EQ(path, map_to_nodes_sequentially(*graph, sequence));
+            std::unique_lock<std::mutex> lock(seq_mutex);
+            for (size_t i = 0; i + k <= sequence.size(); ++i) {
+                kmers.insert(sequence.substr(i, k));
+            }
+        }, 4);
+        std::multiset<std::string> expected;
+        graph->call_kmers([&](auto, const std::string &kmer) { expected.insert(kmer); });
+        EXPECT_EQ(expected, kmers);
+    }
+}
+
 } // namespace
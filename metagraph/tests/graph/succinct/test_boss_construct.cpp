@@ -249,6 +249,58 @@ TEST(BOSSConstruct, ConstructionEQAppendingCanonical) {
 }
 #endif
 
+#if ! _PROTEIN_GRAPH
+TEST(BOSSConstruct, ConstructionFromPackedKmers) {
+    std::vector<std::string> input_data = {
+        "ACAGCTAGCTAGCTAGCTAGCTG",
+        "ATATTATAAAAAATTTTAAAAAA",
+        "ATATATTCTCTCTCTCTCATA",
+        "GTGTGTGTGGGGGGCCCTTTTTTCATA",
+    };
+    for (size_t k = 1; k < std::min(kMaxK, (size_t)20); ++k) {
+        // all (k+1)-mers as strings and as nucleotide codes
+        std::vector<std::pair<std::string, uint64_t>> kmers;
+        std::vector<uint8_t> codes;
+        std::vector<uint64_t> counts;
+        for (const auto &sequence : input_data) {
+            for (size_t i = 0; i + k + 1 <= sequence.size(); ++i) {
+                kmers.emplace_back(sequence.substr(i, k + 1), i + 1);
+                for (char c : kmers.back().first) {
+                    codes.push_back(std::string("ACGT").find(c));
+                }
+                counts.push_back(i + 1);
+            }
+        }
+        for (auto container : { kmer::ContainerType::VECTOR, kmer::ContainerType::VECTOR_DISK }) {
+            for (bool canonical : { false, true }) {
+                for (bool weighted : { false, true }) {
+                    BOSSConstructor expected_constructor(k, canonical, weighted ? 8 : 0, "", 1,
+                                                         20'000, container);
+                    expected_constructor.add_sequences(decltype(kmers)(kmers));
+                    BOSS expected;
+                    sdsl::int_vector_buffer<> expected_weights;
+                    expected_constructor.build_graph(&expected, weighted ? &expected_weights : NULL);
+
+                    BOSSConstructor constructor(k, canonical, weighted ? 8 : 0, "", 2,
+                                                20'000, container);
+                    constructor.add_kmers(k + 1, decltype(codes)(codes),
+                                          decltype(counts)(counts));
+                    BOSS constructed;
+                    sdsl::int_vector_buffer<> weights;
+                    constructor.build_graph(&constructed, weighted ? &weights : NULL);
+
+                    EXPECT_EQ(expected, constructed);
+                    ASSERT_EQ(expected_weights.size(), weights.size());
+                    for (size_t i = 0; i < weights.size(); ++i) {
+                        EXPECT_EQ(expected_weights[i], weights[i]);
+                    }
+                }
+            }
+        }
+    }
+}
+#endif
+
 TEST(BOSSConstruct, ConstructionLong) {
     for (size_t k = 1; k < kMaxK; ++k) {
         BOSS appended(k);
@@ -559,4 +611,46 @@ TYPED_TEST(CountKmers, CountKmersAppendParallel) {
 #endif
 }
 
+#if ! _PROTEIN_GRAPH
+TYPED_TEST(CountKmers, CountPackedKmers) {
+    using Container = common::SortedMultiset<typename TypeParam::WordType, uint32_t>;
+    using KmerCollector = Collector<TypeParam, Container>;
+    using Suffix = std::vector<KmerExtractorBOSS::TAlphabet>;
+
+    const size_t k = 12;
+    std::vector<std::string> input_data = {
+        "ACAGCTAGCTAGCTAGCTAGCTG",
+        "ATATTATAAAAAATTTTAAAAAA",
+        "GTGTGTGTGGGGGGCCCTTTTTTCATA",
+    };
+    // all k-mers as strings and as nucleotide codes
+    std::vector<std::pair<std::string, uint64_t>> kmers;
+    std::vector<uint8_t> codes;
+    std::vector<uint64_t> counts;
+    for (const auto &sequence : input_data) {
+        for (size_t i = 0; i + k <= sequence.size(); ++i) {
+            kmers.emplace_back(sequence.substr(i, k), i + 1);
+            for (char c : kmers.back().first) {
+                codes.push_back(std::string("ACGT").find(c));
+            }
+            counts.push_back(i + 1);
+        }
+    }
+
+    for (auto mode : { KmerCollector::BASIC, KmerCollector::CANONICAL_ONLY, KmerCollector::BOTH }) {
+        // the k-mers are packed right from the codes without a suffix filter,
+        // and extracted from sequences with it
+        for (const Suffix &suffix : { Suffix {}, Suffix { 2 } }) {
+            KmerCollector expected(k, mode, Suffix(suffix), 1);
+            expected.add_sequences(decltype(kmers)(kmers));
+
+            KmerCollector collector(k, mode, Suffix(suffix), 2);
+            collector.add_kmers(k, decltype(codes)(codes), decltype(counts)(counts));
+
+            EXPECT_EQ(expected.data(), collector.data());
+        }
+    }
+}
+#endif
+
 }  // namespace
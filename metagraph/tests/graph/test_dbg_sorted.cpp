@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+
+#include <mutex>
+#include <set>
+
+#include "../test_helpers.hpp"
+#include "all/test_dbg_helpers.hpp"
+
+#include "common/seq_tools/reverse_complement.hpp"
+#include "graph/representation/sorted/dbg_sorted.hpp"
+
+
+namespace {
+
+using namespace mtg;
+using namespace mtg::test;
+
+std::shared_ptr<DBGSorted> build_sorted_graph(size_t k,
+                                              const std::vector<std::string> &sequences,
+                                              size_t num_threads = 1) {
+    auto graph = std::make_shared<DBGSorted>(k, num_threads);
+    graph->add_sequences([&](const auto &callback) {
+        for (const auto &sequence : sequences) {
+            callback(sequence);
+        }
+    });
+    return graph;
+}
+
+std::multiset<std::string> call_kmers(const DeBruijnGraph &graph,
+                                      size_t num_threads,
+                                      bool kmers_in_single_form = false) {
+    std::multiset<std::string> kmers;
+    std::mutex mu;
+    graph.call_sequences([&](const std::string &sequence, const auto &path) {
+        ASSERT_EQ(path, map_to_nodes_sequentially(graph, sequence));
+        std::lock_guard<std::mutex> lock(mu);
+        for (size_t i = 0; i + graph.get_k() <= sequence.size(); ++i) {
+            kmers.insert(sequence.substr(i, graph.get_k()));
+        }
+    }, num_threads, kmers_in_single_form);
+    return kmers;
+}
+
+const std::vector<std::string> kSequences = {
+    "ATGCAGTACTCAGCAATCAGGCATGCAGTACTCAGC",
+    "ATGCAGTACTCAGCTTTTTTTTTTTTTTTTTTTTTT",
+    "GCTGAGTACTGCATGCCTGATTGCTGAGTACTGCAT",
+    "ACGTACGTACGTACGTACGTACGTACGTACGTACGT",
+    "AAAAAAAAAAAAAAAAAAA",
+    "AC",
+};
+
+
+TEST(DBGSorted, EmptyGraph) {
+    auto graph = build_sorted_graph(5, {});
+    EXPECT_EQ(0u, graph->num_nodes());
+    EXPECT_EQ(DeBruijnGraph::npos, graph->kmer_to_node("AAAAA"));
+    EXPECT_TRUE(call_kmers(*graph, 4).empty());
+}
+
+TEST(DBGSorted, SameAsHashGraph) {
+    for (size_t k = 2; k <= 20; ++k) {
+        auto graph = build_sorted_graph(k, kSequences, 3);
+        auto hash = build_graph<DBGHashFast>(k, kSequences);
+
+        ASSERT_EQ(hash->num_nodes(), graph->num_nodes());
+
+        graph->call_kmers([&](auto node, const std::string &kmer) {
+            ASSERT_EQ(node, graph->kmer_to_node(kmer));
+            auto hash_node = hash->kmer_to_node(kmer);
+            ASSERT_NE(DeBruijnGraph::npos, hash_node);
+            EXPECT_EQ(hash->outdegree(hash_node), graph->outdegree(node)) << kmer;
+            EXPECT_EQ(hash->indegree(hash_node), graph->indegree(node)) << kmer;
+        });
+
+        for (const auto &sequence : kSequences) {
+            EXPECT_EQ(sequence.size() >= k, graph->find(sequence));
+        }
+    }
+}
+
+TEST(DBGSorted, AddSequencesWithSkipper) {
+    auto graph = std::make_shared<DBGSorted>(3);
+    // skip every second k-mer
+    graph->add_sequences(
+        [&](const auto &callback) { callback("AAACCCGGG"); },
+        [&](std::string_view) {
+            return [i = 0]() mutable { return i++ % 2; };
+        }
+    );
+    EXPECT_EQ(4u, graph->num_nodes());
+    EXPECT_NE(DeBruijnGraph::npos, graph->kmer_to_node("AAA"));
+    EXPECT_EQ(DeBruijnGraph::npos, graph->kmer_to_node("AAC"));
+    EXPECT_NE(DeBruijnGraph::npos, graph->kmer_to_node("ACC"));
+
+    // adding more sequences re-indexes the k-mers
+    graph->add_sequences([&](const auto &callback) { callback("AACC"); });
+    EXPECT_EQ(5u, graph->num_nodes());
+    EXPECT_NE(DeBruijnGraph::npos, graph->kmer_to_node("AAC"));
+}
+
+TEST(DBGSorted, CallSequences) {
+    for (size_t num_threads : { 1, 4 }) {
+        for (size_t k = 2; k <= 20; ++k) {
+            auto graph = build_sorted_graph(k, kSequences, num_threads);
+
+            std::multiset<std::string> expected;
+            graph->call_kmers([&](auto, const std::string &kmer) { expected.insert(kmer); });
+
+            EXPECT_EQ(expected, call_kmers(*graph, num_threads));
+        }
+    }
+}
+
+TEST(DBGSorted, CallSequencesCycles) {
+    for (size_t num_threads : { 1, 4 }) {
+        // a simple cycle, a self-loop, and a path
+        auto graph = build_sorted_graph(4, { "ACGTTACGT", "CCCCC", "GGATC" }, num_threads);
+
+        std::multiset<std::string> expected;
+        graph->call_kmers([&](auto, const std::string &kmer) { expected.insert(kmer); });
+
+        EXPECT_EQ(expected, call_kmers(*graph, num_threads));
+    }
+}
+
+#if ! _PROTEIN_GRAPH
+TEST(DBGSorted, CallSequencesSingleForm) {
+    for (size_t num_threads : { 1, 4 }) {
+        for (size_t k = 2; k <= 20; ++k) {
+            std::vector<std::string> sequences = kSequences;
+            for (const auto &sequence : kSequences) {
+                sequences.push_back(sequence);
+                reverse_complement(sequences.back().begin(), sequences.back().end());
+            }
+            auto graph = build_sorted_graph(k, sequences, num_threads);
+
+            std::set<std::string> expected;
+            graph->call_kmers([&](auto, std::string kmer) {
+                std::string rev_comp = kmer;
+                reverse_complement(rev_comp.begin(), rev_comp.end());
+                expected.insert(std::min(kmer, rev_comp));
+            });
+
+            std::set<std::string> called;
+            for (std::string kmer : call_kmers(*graph, num_threads, true)) {
+                std::string rev_comp = kmer;
+                reverse_complement(rev_comp.begin(), rev_comp.end());
+                // each k-mer is called in only one of its forms
+                ASSERT_TRUE(called.insert(std::min(kmer, rev_comp)).second);
+            }
+            EXPECT_EQ(expected, called);
+        }
+    }
+}
+#endif
+
+} // namespace
@@ -856,4 +856,67 @@ TYPED_TEST(MaskedDeBruijnGraphTest, CheckIncomingNodes) {
     }
 }
 
+TYPED_TEST(MaskedDeBruijnGraphTest, MaterializedMask) {
+    for (size_t num_threads : { 1, 4 }) {
+        for (size_t k = 3; k <= 10; ++k) {
+            std::vector<std::string> sequences { "ATGCAGTACTCAG",
+                                                 "ATGCAGTACTGAG",
+                                                 "GGGGGGGGGGGGG" };
+            auto full_graph = build_graph_batch<TypeParam>(k, sequences);
+
+            auto is_in_mask = [&](auto node) { return node % 3 != 0; };
+
+            MaskedDeBruijnGraph lazy_graph(full_graph,
+                [&](auto node) { return is_in_mask(node); });
+            MaskedDeBruijnGraph graph(full_graph,
+                materialize_mask(*full_graph, is_in_mask, num_threads), true);
+
+            EXPECT_TRUE(check_graph_nodes(graph));
+
+            std::multiset<MaskedDeBruijnGraph::node_index> ref_nodes;
+            lazy_graph.call_nodes([&](auto node) { ref_nodes.insert(node); });
+
+            std::multiset<MaskedDeBruijnGraph::node_index> nodes;
+            graph.call_nodes([&](auto node) { nodes.insert(node); });
+
+            EXPECT_EQ(ref_nodes, nodes);
+            EXPECT_EQ(ref_nodes.size(), graph.num_nodes());
+
+            graph.call_nodes([&](auto node) {
+                EXPECT_EQ(lazy_graph.outdegree(node), graph.outdegree(node));
+                EXPECT_EQ(lazy_graph.indegree(node), graph.indegree(node));
+            });
+
+            // stop after the first node
+            size_t num_called = 0;
+            graph.call_nodes([&](auto) { num_called++; },
+                             [&]() { return num_called > 0; });
+            EXPECT_EQ(std::min(size_t(1), ref_nodes.size()), num_called);
+        }
+    }
+}
+
+TYPED_TEST(MaskedDeBruijnGraphTest, ComposeMasks) {
+    for (size_t k = 3; k <= 10; ++k) {
+        std::vector<std::string> sequences { "ATGCAGTACTCAG",
+                                             "ATGCAGTACTGAG",
+                                             "GGGGGGGGGGGGG" };
+        auto full_graph = build_graph_batch<TypeParam>(k, sequences);
+
+        auto first = materialize_mask(*full_graph, [](auto node) { return node % 2; });
+        auto second = materialize_mask(*full_graph, [](auto node) { return node % 3; });
+
+        MaskedDeBruijnGraph graph_and(full_graph, intersect_masks(*first, *second), true);
+        MaskedDeBruijnGraph graph_or(full_graph, unite_masks(*first, *second), true);
+
+        full_graph->call_nodes([&](auto node) {
+            EXPECT_EQ(node % 2 && node % 3, graph_and.in_subgraph(node));
+            EXPECT_EQ(node % 2 || node % 3, graph_or.in_subgraph(node));
+        });
+
+        EXPECT_TRUE(check_graph_nodes(graph_and));
+        EXPECT_TRUE(check_graph_nodes(graph_or));
+    }
+}
+
 } // namespace
@@ -32,6 +32,7 @@ typedef ::testing::Types<bit_vector_stat,
                          bit_vector_rrr<>,
                          bit_vector_il<>,
                          bit_vector_il<4096>,
+                         bit_vector_cl,
                          bit_vector_hyb<>,
                          bit_vector_small,
                          bit_vector_smallrank,
@@ -245,6 +246,49 @@ TYPED_TEST(BitVectorTest, select1) {
     }
 }
 
+TYPED_TEST(BitVectorTest, batch_queries) {
+    DataGenerator gen;
+    gen.set_seed(42);
+
+    for (double density : { 0.0, 0.01, 0.3, 0.9, 1.0 }) {
+        sdsl::bit_vector bv = gen.generate_random_column(10'000, density);
+        const TypeParam vector(bv);
+
+        // sorted indexes, with many of them falling into the same words
+        std::vector<uint64_t> ids;
+        for (uint64_t i = 0; i < vector.size(); i += 1 + (i * 7) % 13) {
+            ids.push_back(i);
+        }
+        // unsorted indexes
+        for (uint64_t i = 0; i < 1'000; ++i) {
+            ids.push_back((i * 87'178'291'199) % vector.size());
+        }
+
+        std::unique_ptr<bool[]> bits(new bool[ids.size()]);
+        std::vector<uint64_t> ranks(ids.size());
+        std::vector<uint64_t> cond_ranks(ids.size());
+        vector.get_many(ids.data(), ids.size(), bits.get());
+        vector.rank1_many(ids.data(), ids.size(), ranks.data());
+        vector.conditional_rank1_many(ids.data(), ids.size(), cond_ranks.data());
+
+        for (size_t i = 0; i < ids.size(); ++i) {
+            ASSERT_EQ(bv[ids[i]], bits[i]) << i;
+            ASSERT_EQ(vector.rank1(ids[i]), ranks[i]) << i;
+            ASSERT_EQ(vector.conditional_rank1(ids[i]), cond_ranks[i]) << i;
+        }
+
+        std::vector<uint64_t> select_ids;
+        for (uint64_t r = 1; r <= vector.num_set_bits(); r += 1 + r % 3) {
+            select_ids.push_back(r);
+        }
+        std::vector<uint64_t> positions(select_ids.size());
+        vector.select1_many(select_ids.data(), select_ids.size(), positions.data());
+        for (size_t i = 0; i < select_ids.size(); ++i) {
+            ASSERT_EQ(vector.select1(select_ids[i]), positions[i]) << i;
+        }
+    }
+}
+
 TYPED_TEST(BitVectorTest, select0) {
     // Mainly test select0.
     auto vector = std::make_unique<TypeParam>(10, 1);
@@ -848,6 +892,7 @@ TYPED_TEST(BitVectorTest, copy_to) {
     test_copy_convert_to< TypeParam, bit_vector_rrr<> >();
     test_copy_convert_to< TypeParam, bit_vector_il<> >();
     test_copy_convert_to< TypeParam, bit_vector_hyb<> >();
+    test_copy_convert_to< TypeParam, bit_vector_cl >();
     test_copy_convert_to< TypeParam, bit_vector_small >();
     test_copy_convert_to< TypeParam, bit_vector_smart >();
 }
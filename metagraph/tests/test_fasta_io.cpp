@@ -2,7 +2,12 @@
 
 #include <string>
 #include <filesystem>
+#include <fstream>
+#include <random>
 
+#include <htslib/bgzf.h>
+
+#include "common/threads/threading.hpp"
 #include "seq_io/sequence_io.hpp"
 
 
@@ -386,6 +391,146 @@ TEST(FastaFile, iterator_read_1M_multiple_copies) {
 }
 
 
+struct FastqRecord {
+    std::string name;
+    std::string seq;
+    std::string qual;
+};
+
+std::vector<FastqRecord> generate_fastq_records(size_t num_records) {
+    std::mt19937 rng(123457);
+    std::uniform_int_distribution<size_t> length(0, 1'000);
+    const std::string alphabet = "ACGT";
+
+    std::vector<FastqRecord> records(num_records);
+    for (size_t i = 0; i < num_records; ++i) {
+        records[i].name = "read" + std::to_string(i);
+        records[i].seq.resize(length(rng));
+        for (char &c : records[i].seq) {
+            c = alphabet[rng() % 4];
+        }
+        records[i].qual.resize(records[i].seq.size());
+        for (char &c : records[i].qual) {
+            c = '!' + rng() % 42;
+        }
+    }
+    return records;
+}
+
+std::string to_fastq(const std::vector<FastqRecord> &records) {
+    std::string fastq;
+    for (const auto &[name, seq, qual] : records) {
+        fastq += "@" + name + "\n" + seq + "\n+\n" + qual + "\n";
+    }
+    return fastq;
+}
+
+void write_bgzf(const std::string &filename, const std::string &data) {
+    BGZF *out = bgzf_open(filename.c_str(), "w");
+    ASSERT_TRUE(out);
+    ASSERT_EQ(static_cast<ssize_t>(data.size()),
+              bgzf_write(out, data.data(), data.size()));
+    ASSERT_EQ(0, bgzf_close(out));
+}
+
+void check_fastq_records(const std::string &filename,
+                         const std::vector<FastqRecord> &records) {
+    size_t i = 0;
+    for (const auto &record : FastaParser(filename)) {
+        ASSERT_GT(records.size(), i);
+        EXPECT_EQ(records[i].name, record.name.s);
+        EXPECT_EQ(records[i].seq, record.seq.s);
+        EXPECT_EQ(records[i].qual, std::string(record.qual.s, record.qual.l));
+        i++;
+    }
+    EXPECT_EQ(records.size(), i);
+
+    for (size_t num_threads : { 1, 4 }) {
+        set_num_threads(num_threads);
+        i = 0;
+        read_fasta_file_critical(filename, [&](kseq_t *read_stream) {
+            ASSERT_GT(records.size(), i);
+            EXPECT_EQ(records[i].name, read_stream->name.s);
+            EXPECT_EQ(records[i].seq, read_stream->seq.s);
+            EXPECT_EQ(records[i].qual, std::string(read_stream->qual.s,
+                                                   read_stream->qual.l));
+            i++;
+        });
+        EXPECT_EQ(records.size(), i);
+    }
+    set_num_threads(1);
+}
+
+TEST(FastaFile, read_fastq_bgzf) {
+    const std::string filename = test_data_dir + "/dump.fq.gz";
+    auto records = generate_fastq_records(20'000);
+    write_bgzf(filename, to_fastq(records));
+
+    check_fastq_records(filename, records);
+
+    std::filesystem::remove(filename);
+}
+
+TEST(FastaFile, read_fastq_gzip_multiple_members) {
+    const std::string filename = test_data_dir + "/dump.fq.gz";
+    auto records = generate_fastq_records(20'000);
+    std::string fastq = to_fastq(records);
+    size_t half = fastq.size() / 2;
+
+    // gzip files concatenated
+    for (const char *mode : { "w", "a" }) {
+        gzFile out = gzopen(filename.c_str(), mode);
+        ASSERT_TRUE(out);
+        const char *data = fastq.data() + (mode[0] == 'w' ? 0 : half);
+        int size = mode[0] == 'w' ? half : fastq.size() - half;
+        ASSERT_EQ(size, gzwrite(out, data, size));
+        gzclose(out);
+    }
+
+    check_fastq_records(filename, records);
+
+    std::filesystem::remove(filename);
+}
+
+TEST(FastaFile, read_fastq_uncompressed) {
+    const std::string filename = test_data_dir + "/dump.fq";
+    auto records = generate_fastq_records(20'000);
+    {
+        std::ofstream out(filename);
+        out << to_fastq(records);
+    }
+
+    check_fastq_records(filename, records);
+
+    std::filesystem::remove(filename);
+}
+
+TEST(FastaFile, iterator_copy_bgzf) {
+    const std::string filename = test_data_dir + "/dump.fq.gz";
+    auto records = generate_fastq_records(2'000);
+    write_bgzf(filename, to_fastq(records));
+
+    FastaParser parser(filename);
+    FastaParser::iterator copy;
+
+    size_t i = 0;
+    for (auto it = parser.begin(); it != parser.end(); ++it, ++i) {
+        copy = it;
+        EXPECT_TRUE(copy == it);
+        EXPECT_EQ(records[i].seq, copy->seq.s);
+    }
+    EXPECT_EQ(records.size(), i);
+
+    // start over from the first record
+    auto begin = parser.begin();
+    ++begin;
+    copy = begin;
+    EXPECT_EQ(records[1].seq, copy->seq.s);
+
+    std::filesystem::remove(filename);
+}
+
+
 TEST(FastaFileWithCanonical, iterator_read) {
     size_t num_records = 0;
     size_t total_size = 0;
@@ -499,6 +499,52 @@ TEST(ThreadPool, DummyFuture) {
     }
 }
 
+TEST(AsyncIOQueue, OrderOfTasks) {
+    for (size_t depth : { 0, 1, 2, 5 }) {
+        AsyncIOQueue queue(depth);
+        EXPECT_EQ(std::max(depth, size_t(1)), queue.depth());
+
+        std::vector<size_t> result;
+        for (size_t t = 0; t < 1000; ++t) {
+            std::vector<size_t> block(10, t);
+            // the block is moved to the task
+            queue.submit([&,block=std::move(block)]() {
+                result.insert(result.end(), block.begin(), block.end());
+            });
+        }
+        queue.wait();
+
+        ASSERT_EQ(10'000u, result.size());
+        for (size_t i = 0; i < result.size(); ++i) {
+            ASSERT_EQ(i / 10, result[i]);
+        }
+    }
+}
+
+TEST(AsyncIOQueue, ReadAhead) {
+    AsyncIOQueue queue(3);
+    std::vector<std::vector<size_t>> buffers(queue.depth() + 1);
+    std::vector<std::shared_future<void>> ready(buffers.size());
+
+    size_t num_submitted = 0;
+    auto read_ahead = [&]() {
+        size_t slot = num_submitted % buffers.size();
+        ready[slot] = queue.submit([&buffers,slot](size_t t) {
+            buffers[slot].assign(100, t);
+        }, num_submitted++);
+    };
+
+    for (size_t b = 0; b < queue.depth(); ++b) {
+        read_ahead();
+    }
+    for (size_t t = 0; t < 100; ++t) {
+        ready[t % buffers.size()].get();
+        read_ahead();
+        EXPECT_EQ(std::vector<size_t>(100, t), buffers[t % buffers.size()]);
+    }
+    queue.wait();
+}
+
 
 TEST(AsyncActivity, RunUniqueOnly) {
     AsyncActivity async;